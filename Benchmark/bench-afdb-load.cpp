@@ -0,0 +1,253 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Dataset/afdb-utils.h"
+#include "Support/chrono.h"
+#include "Support/glograii.h"
+#include "Support/split.h"
+#include "Support/versionutils.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace po = boost::program_options;
+namespace us = uiiit::support;
+namespace ud = uiiit::dataset;
+
+//! Write a synthetic dataset with the same format as the original one.
+void generate(const std::string& aFilename, const std::size_t aNumRows) {
+  std::ofstream myFile(aFilename);
+  if (not myFile) {
+    throw std::runtime_error("Could not open file for writing: " + aFilename);
+  }
+  for (std::size_t i = 0; i < aNumRows; i++) {
+    const auto myWrite = i % 3 == 0;
+    myFile << (1577836800000.0 + i * 0.5) << ",region" << (i % 7)
+           << ",d2b5c9f7a3e84e1c9b5f" << (i % 101) << ",8e4f1c2b7a9d3e6f"
+           << (i % 997) << ",f" << (i % 10007) << ",blob" << (i % 100003)
+           << ",application/octet-stream,v" << (i % 5) << ','
+           << (i * 37 % 65536) << (myWrite ? ",False,True" : ",True,False")
+           << '\n';
+  }
+}
+
+//! Same fields as ud::Row, parsed as before the introduction of RowView.
+struct LegacyRow {
+  explicit LegacyRow(const std::string& aRow) {
+    auto myTokens = us::split<std::vector<std::string>>(aRow, ",");
+    if (myTokens.size() != 11) {
+      throw std::runtime_error("Wrong number of elements in row: " + aRow);
+    }
+    theTimestamp = std::stod(myTokens[0]);
+    theRegion.swap(myTokens[1]);
+    theUser.swap(myTokens[2]);
+    theApp.swap(myTokens[3]);
+    theFunction.swap(myTokens[4]);
+    theBlob.swap(myTokens[5]);
+    theBlobType.swap(myTokens[6]);
+    theBlobVersion.swap(myTokens[7]);
+    theBlobSize = std::stoull(myTokens[8]);
+    theWrite    = myTokens[9] == "False";
+  }
+
+  double      theTimestamp;
+  std::string theRegion;
+  std::string theUser;
+  std::string theApp;
+  std::string theFunction;
+  std::string theBlob;
+  std::string theBlobType;
+  std::string theBlobVersion;
+  std::size_t theBlobSize;
+  bool        theWrite;
+};
+
+std::deque<LegacyRow> legacyLoad(std::istream& aStream) {
+  std::deque<LegacyRow> ret;
+  std::string           myLine;
+  while (std::getline(aStream, myLine) and not myLine.empty()) {
+    ret.emplace_back(myLine);
+  }
+  return ret;
+}
+
+//! Print the throughput of a run.
+void report(const std::string& aName,
+            const double       aElapsed,
+            const std::size_t  aNumRows) {
+  std::cout << aName << ',' << aElapsed << ',' << aNumRows << ','
+            << (aNumRows / aElapsed) << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  us::GlogRaii myGlogRaii(argv[0]);
+
+  std::string myInput;
+  std::size_t myNumRows;
+  std::size_t myNumThreads;
+
+  po::options_description myDesc("Allowed options");
+  // clang-format off
+  myDesc.add_options()
+    ("help,h", "produce help message")
+    ("version,v", "print version and quit")
+    ("input",
+     po::value<std::string>(&myInput)->default_value(""),
+     "Dataset file, without header. If empty generate a synthetic one.")
+    ("num-rows",
+     po::value<std::size_t>(&myNumRows)->default_value(1000000),
+     "Number of rows of the synthetic dataset.")
+    ("num-threads",
+     po::value<std::size_t>(&myNumThreads)->default_value(
+       std::thread::hardware_concurrency()),
+     "Maximum number of threads used by the parallel loaders.")
+    ;
+  // clang-format on
+
+  try {
+    po::variables_map myVarMap;
+    po::store(po::parse_command_line(argc, argv, myDesc), myVarMap);
+    po::notify(myVarMap);
+
+    if (myVarMap.count("help")) {
+      std::cout << myDesc << std::endl;
+      return EXIT_SUCCESS;
+    }
+
+    if (myVarMap.count("version")) {
+      std::cout << us::version() << std::endl;
+      return EXIT_SUCCESS;
+    }
+
+    if (myNumThreads == 0) {
+      throw std::runtime_error("Invalid zero number of threads");
+    }
+
+    const auto myGenerated = myInput.empty();
+    if (myGenerated) {
+      myInput = (boost::filesystem::temp_directory_path() /
+                 boost::filesystem::unique_path("afdb-%%%%-%%%%.csv"))
+                    .string();
+      generate(myInput, myNumRows);
+    }
+
+    std::cout << "# name,elapsed (s),rows,rows/s" << std::endl;
+
+    {
+      us::Chrono    myChrono(true);
+      std::ifstream myStream(myInput);
+      const auto    myDataset = legacyLoad(myStream);
+      report("legacy", myChrono.stop(), myDataset.size());
+    }
+    {
+      us::Chrono     myChrono(true);
+      std::ifstream  myStream(myInput);
+      ud::Dictionary myDictionary;
+      const auto myDataset = ud::loadDataset(myStream, false, myDictionary);
+      report("loadDataset(istream)", myChrono.stop(), myDataset.size());
+    }
+    for (std::size_t n = 1; n <= myNumThreads; n *= 2) {
+      {
+        us::Chrono        myChrono(true);
+        ud::MappedDataset myDataset(myInput, false, n);
+        report("MappedDataset with " + std::to_string(n) + " threads",
+               myChrono.stop(),
+               myDataset.rows().size());
+      }
+      {
+        us::Chrono     myChrono(true);
+        ud::Dictionary myDictionary;
+        const auto     myDataset =
+            ud::loadDataset(myInput, false, myDictionary, n);
+        report("loadDataset(filename) with " + std::to_string(n) + " threads",
+               myChrono.stop(),
+               myDataset.size());
+      }
+      {
+        us::Chrono     myChrono(true);
+        ud::Dictionary myDictionary;
+        const auto     myDataset =
+            ud::loadColumns(myInput, false, myDictionary, n);
+        report("loadColumns with " + std::to_string(n) + " threads",
+               myChrono.stop(),
+               myDataset.size());
+      }
+    }
+
+    // a pass over the dataset reading two fields only, by row vs. by column
+    {
+      ud::Dictionary myDictionary;
+      const auto     myRows = ud::loadDataset(myInput, false, myDictionary);
+      const ud::DatasetColumns myColumns(myRows);
+
+      us::Chrono    myChrono(true);
+      std::uint64_t myWritten = 0;
+      for (const auto& myRow : myRows) {
+        myWritten += myRow.theWrite ? myRow.theBlobSize : 0;
+      }
+      report("scan rows", myChrono.stop(), myRows.size());
+
+      myChrono.start();
+      std::uint64_t myWrittenColumns = 0;
+      const auto&   mySizes          = myColumns.sizes();
+      for (std::size_t i = 0; i < myColumns.size(); i++) {
+        myWrittenColumns += myColumns.write(i) ? mySizes[i] : 0;
+      }
+      report("scan columns", myChrono.stop(), myColumns.size());
+
+      if (myWritten != myWrittenColumns) {
+        throw std::runtime_error("Inconsistent scan results");
+      }
+    }
+
+    if (myGenerated) {
+      boost::filesystem::remove(myInput);
+    }
+
+    return EXIT_SUCCESS;
+
+  } catch (const std::exception& aErr) {
+    std::cerr << "Exception caught: " << aErr.what() << std::endl;
+
+  } catch (...) {
+    std::cerr << "Unknown exception caught" << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}
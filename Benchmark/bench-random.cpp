@@ -0,0 +1,226 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/batchrandom.h"
+#include "Support/chrono.h"
+#include "Support/counterrandom.h"
+#include "Support/glograii.h"
+#include "Support/random.h"
+#include "Support/versionutils.h"
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace po = boost::program_options;
+namespace us = uiiit::support;
+
+//! Print the throughput of a run and the mean to prevent dead-code removal.
+void report(const std::string&         aName,
+            const double               aElapsed,
+            const std::vector<double>& aValues) {
+  std::cout << aName << ',' << aElapsed << ',' << (aValues.size() / aElapsed)
+            << ','
+            << (std::accumulate(aValues.begin(), aValues.end(), 0.0) /
+                aValues.size())
+            << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  us::GlogRaii myGlogRaii(argv[0]);
+
+  std::size_t myNumSamples;
+  std::size_t myBatchSize;
+  double      myLambda;
+  std::size_t myNumThreads;
+
+  po::options_description myDesc("Allowed options");
+  // clang-format off
+  myDesc.add_options()
+    ("help,h", "produce help message")
+    ("version,v", "print version and quit")
+    ("num-samples",
+     po::value<std::size_t>(&myNumSamples)->default_value(10000000),
+     "Number of samples drawn in each run.")
+    ("batch-size",
+     po::value<std::size_t>(&myBatchSize)->default_value(1024),
+     "Number of samples drawn with each call to fill().")
+    ("lambda",
+     po::value<double>(&myLambda)->default_value(1),
+     "Rate of the exponential distribution.")
+    ("num-threads",
+     po::value<std::size_t>(&myNumThreads)->default_value(
+       std::thread::hardware_concurrency()),
+     "Number of threads calling random() concurrently.")
+    ;
+  // clang-format on
+
+  try {
+    po::variables_map myVarMap;
+    po::store(po::parse_command_line(argc, argv, myDesc), myVarMap);
+    po::notify(myVarMap);
+
+    if (myVarMap.count("help")) {
+      std::cout << myDesc << std::endl;
+      return EXIT_SUCCESS;
+    }
+
+    if (myVarMap.count("version")) {
+      std::cout << us::version() << std::endl;
+      return EXIT_SUCCESS;
+    }
+
+    if (myBatchSize == 0) {
+      throw std::runtime_error("Invalid zero batch size");
+    }
+    if (myNumThreads == 0) {
+      throw std::runtime_error("Invalid zero number of threads");
+    }
+
+    std::vector<double> myValues(myNumSamples);
+    std::cout << "# name,elapsed (s),samples/s,mean" << std::endl;
+
+    const auto mySingle = [&](us::RealRvInterface& aRv) {
+      us::Chrono myChrono(true);
+      for (auto& myValue : myValues) {
+        myValue = aRv();
+      }
+      return myChrono.stop();
+    };
+
+    const auto myBatch = [&](us::RealRvInterface& aRv) {
+      us::Chrono myChrono(true);
+      for (std::size_t i = 0; i < myNumSamples; i += myBatchSize) {
+        aRv.fill(myValues.data() + i, std::min(myBatchSize, myNumSamples - i));
+      }
+      return myChrono.stop();
+    };
+
+    {
+      std::unique_ptr<us::RealRvInterface> myRv(
+          new us::ExponentialRv(myLambda, 0, 0, 0));
+      report("ExponentialRv::operator()", mySingle(*myRv), myValues);
+    }
+    {
+      std::unique_ptr<us::RealRvInterface> myRv(
+          new us::ExponentialRv(myLambda, 0, 0, 0));
+      report("ExponentialRv::fill", myBatch(*myRv), myValues);
+    }
+    {
+      std::unique_ptr<us::RealRvInterface> myRv(
+          new us::BatchExponentialRv(myLambda, 0, 0, 0));
+      report("BatchExponentialRv::operator()", mySingle(*myRv), myValues);
+    }
+    {
+      std::unique_ptr<us::RealRvInterface> myRv(
+          new us::BatchExponentialRv(myLambda, 0, 0, 0));
+      report("BatchExponentialRv::fill", myBatch(*myRv), myValues);
+    }
+    {
+      std::unique_ptr<us::RealRvInterface> myRv(
+          new us::UniformRv(0, 1, 0, 0, 0));
+      report("UniformRv::fill", myBatch(*myRv), myValues);
+    }
+    {
+      std::unique_ptr<us::RealRvInterface> myRv(
+          new us::BatchUniformRv(0, 1, 0, 0, 0));
+      report("BatchUniformRv::fill", myBatch(*myRv), myValues);
+    }
+    {
+      std::unique_ptr<us::RealRvInterface> myRv(
+          new us::CounterExponentialRv(myLambda, 0, 0, 0));
+      report("CounterExponentialRv::operator()", mySingle(*myRv), myValues);
+    }
+    {
+      std::unique_ptr<us::RealRvInterface> myRv(
+          new us::CounterExponentialRv(myLambda, 0, 0, 0));
+      report("CounterExponentialRv::fill", myBatch(*myRv), myValues);
+    }
+
+    // creation of one r.v. per flow, with one value drawn from each
+    std::vector<double> myFlowValues(
+        std::min<std::size_t>(myNumSamples, 100000));
+    const auto myCreate = [&](const auto& aFactory) {
+      us::Chrono myChrono(true);
+      for (std::size_t i = 0; i < myFlowValues.size(); i++) {
+        myFlowValues[i] = (*aFactory(i))();
+      }
+      return myChrono.stop();
+    };
+    report("ExponentialRv creation",
+           myCreate([myLambda](const std::size_t i) {
+             return std::make_unique<us::ExponentialRv>(myLambda, i, 0, 0);
+           }),
+           myFlowValues);
+    report("CounterExponentialRv creation",
+           myCreate([myLambda](const std::size_t i) {
+             return std::make_unique<us::CounterExponentialRv>(
+                 myLambda, i, 0, 0);
+           }),
+           myFlowValues);
+
+    for (std::size_t n = 1; n <= myNumThreads; n *= 2) {
+      // each thread writes to its own slice of the output vector
+      us::Chrono               myChrono(true);
+      std::vector<std::thread> myThreads;
+      for (std::size_t t = 0; t < n; t++) {
+        myThreads.emplace_back([&myValues, myNumSamples, n, t]() {
+          for (auto i = t * myNumSamples / n; i < (t + 1) * myNumSamples / n;
+               i++) {
+            myValues[i] = us::random();
+          }
+        });
+      }
+      for (auto& myThread : myThreads) {
+        myThread.join();
+      }
+      report("random() with " + std::to_string(n) + " threads",
+             myChrono.stop(),
+             myValues);
+    }
+
+    return EXIT_SUCCESS;
+
+  } catch (const std::exception& aErr) {
+    std::cerr << "Exception caught: " << aErr.what() << std::endl;
+
+  } catch (...) {
+    std::cerr << "Unknown exception caught" << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,169 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/chrono.h"
+#include "Support/glograii.h"
+#include "Support/stat.h"
+#include "Support/timeweightedstat.h"
+#include "Support/versionutils.h"
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace po = boost::program_options;
+namespace us = uiiit::support;
+
+//! Print the throughput of a run and the mean to prevent dead-code removal.
+void report(const std::string& aName,
+            const std::size_t  aNumSamples,
+            const double       aElapsed,
+            const double       aMean) {
+  std::cout << aName << ',' << aElapsed << ',' << (aNumSamples / aElapsed)
+            << ',' << aMean << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  us::GlogRaii myGlogRaii(argv[0]);
+
+  std::size_t myNumSamples;
+  double      myWarmUp;
+  std::size_t mySeed;
+
+  po::options_description myDesc("Allowed options");
+  // clang-format off
+  myDesc.add_options()
+    ("help,h", "produce help message")
+    ("version,v", "print version and quit")
+    ("num-samples",
+     po::value<std::size_t>(&myNumSamples)->default_value(10000000),
+     "Number of samples added in each run.")
+    ("warm-up",
+     po::value<double>(&myWarmUp)->default_value(1000),
+     "Warm-up period, in time units.")
+    ("seed",
+     po::value<std::size_t>(&mySeed)->default_value(0),
+     "Seed used to generate the input samples.")
+    ;
+  // clang-format on
+
+  try {
+    po::variables_map myVarMap;
+    po::store(po::parse_command_line(argc, argv, myDesc), myVarMap);
+    po::notify(myVarMap);
+
+    if (myVarMap.count("help")) {
+      std::cout << myDesc << std::endl;
+      return EXIT_SUCCESS;
+    }
+
+    if (myVarMap.count("version")) {
+      std::cout << us::version() << std::endl;
+      return EXIT_SUCCESS;
+    }
+
+    // generate the input as a birth-death process of a queue
+    std::mt19937                          myGenerator(mySeed);
+    std::exponential_distribution<double> myInterArrival(1.0);
+    std::bernoulli_distribution           myBirth(0.5);
+    std::vector<double>                   myTimes(myNumSamples);
+    std::vector<double>                   myValues(myNumSamples);
+    double                                myTime  = 0;
+    double                                myValue = 0;
+    for (std::size_t i = 0; i < myNumSamples; i++) {
+      myTime += myInterArrival(myGenerator);
+      myValue     = myBirth(myGenerator) ? (myValue + 1) :
+                                           std::max(0.0, myValue - 1);
+      myTimes[i]  = myTime;
+      myValues[i] = myValue;
+    }
+
+    std::cout << "# name,elapsed (s),samples/s,mean" << std::endl;
+
+    us::Chrono myChrono(false);
+    {
+      double                  myClock = 0;
+      us::SummaryWeightedStat myStat(myClock, myWarmUp);
+      myChrono.start();
+      for (std::size_t i = 0; i < myNumSamples; i++) {
+        myClock = myTimes[i];
+        myStat(myValues[i]);
+      }
+      report("SummaryWeightedStat",
+             myNumSamples,
+             myChrono.stop(),
+             myStat.mean());
+    }
+
+    {
+      us::TimeWeightedStat<> myStat(myWarmUp);
+      myChrono.start();
+      for (std::size_t i = 0; i < myNumSamples; i++) {
+        myStat(myTimes[i], myValues[i]);
+      }
+      report("TimeWeightedStat", myNumSamples, myChrono.stop(), myStat.mean());
+    }
+
+    {
+      us::TimeWeightedStat<> myStat(myWarmUp);
+      myChrono.start();
+      myStat.observe(myTimes.data(), myValues.data(), myNumSamples);
+      report("TimeWeightedStat::observe",
+             myNumSamples,
+             myChrono.stop(),
+             myStat.mean());
+    }
+
+    {
+      us::TimeWeightedStat<100> myStat(myWarmUp, 0, 1);
+      myChrono.start();
+      myStat.observe(myTimes.data(), myValues.data(), myNumSamples);
+      report("TimeWeightedStat<100>::observe",
+             myNumSamples,
+             myChrono.stop(),
+             myStat.percentile(0.99));
+    }
+
+    return EXIT_SUCCESS;
+
+  } catch (const std::exception& aErr) {
+    std::cerr << "Exception caught: " << aErr.what() << std::endl;
+
+  } catch (...) {
+    std::cerr << "Unknown exception caught" << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}
@@ -29,14 +29,20 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "Dataset/afdb-generator.h"
 #include "Dataset/afdb-utils.h"
 #include "Support/glograii.h"
+#include "Support/split.h"
 #include "Support/versionutils.h"
 
 #include <boost/program_options.hpp>
 
+#include <glog/logging.h>
+
 #include <cstdlib>
 #include <fstream>
+#include <functional>
+#include <set>
 #include <string>
 
 namespace po = boost::program_options;
@@ -46,9 +52,20 @@ namespace ud = uiiit::dataset;
 int main(int argc, char* argv[]) {
   us::GlogRaii myGlogRaii(argv[0]);
 
-  std::string myInputRaw;
-  std::string myOutputTimestamp;
-  std::string myDumpTimestamp;
+  std::string   myInputRaw;
+  std::string   myInputTimestamp;
+  std::string   myOutputTimestamp;
+  std::string   myDumpTimestamp;
+  std::string   mySynthesizeTimestamp;
+  std::size_t   myNumThreads;
+  std::size_t   myTimestampVersion;
+  std::size_t   myNumCopies;
+  double        myDuration;
+  std::size_t   mySeed;
+  std::size_t   myNumQuantiles;
+  std::string   myRegions;
+  std::string   myApps;
+  ud::RowFilter myFilter;
 
   po::options_description myDesc("Allowed options");
   // clang-format off
@@ -64,6 +81,44 @@ int main(int argc, char* argv[]) {
     ("dump-timestamp",
      po::value<std::string>(&myDumpTimestamp)->default_value(""),
      "Dump the timestamp dataset in this file.")
+    ("input-timestamp",
+     po::value<std::string>(&myInputTimestamp)->default_value(""),
+     "Load a timestamp dataset from this file, whose statistics are used to synthesize a trace.")
+    ("synthesize-timestamp",
+     po::value<std::string>(&mySynthesizeTimestamp)->default_value(""),
+     "Save to this file a synthetic timestamp dataset with the statistics of the one loaded with --input-timestamp, in version 2 or 3 of the format.")
+    ("copies",
+     po::value<std::size_t>(&myNumCopies)->default_value(1),
+     "Number of copies of every key in the synthetic trace.")
+    ("duration",
+     po::value<double>(&myDuration)->default_value(0),
+     "Duration of the synthetic trace, in ms, 0 means the same as the input.")
+    ("seed",
+     po::value<std::size_t>(&mySeed)->default_value(0),
+     "Seed of the synthetic trace.")
+    ("quantiles",
+     po::value<std::size_t>(&myNumQuantiles)->default_value(32),
+     "Number of quantiles of the distribution of the inter-arrival times fitted for every key of the synthetic trace.")
+    ("timestamp-version",
+     po::value<std::size_t>(&myTimestampVersion)->default_value(2),
+     "Version of the format of the timestamp dataset saved, one of: {1, 2, 3}, where 3 is compressed.")
+    ("num-threads",
+     po::value<std::size_t>(&myNumThreads)->default_value(0),
+     "Number of threads used to load the dataset, 0 means all the hardware threads.")
+    ("regions",
+     po::value<std::string>(&myRegions)->default_value(""),
+     "Comma-separated list of the regions whose events are loaded, all if empty; regions cannot be selected when dumping a timestamp dataset.")
+    ("apps",
+     po::value<std::string>(&myApps)->default_value(""),
+     "Comma-separated list of the apps whose events are loaded, all if empty.")
+    ("begin-time",
+     po::value<double>(&myFilter.theBegin),
+     "Only load the events with a timestamp not smaller than this value, in ms.")
+    ("end-time",
+     po::value<double>(&myFilter.theEnd),
+     "Only load the events with a timestamp smaller than this value, in ms.")
+    ("streaming",
+     "Read the raw dataset one row at a time in a single thread, instead of loading it in memory, so that only the timestamps are kept.")
     ;
   // clang-format on
 
@@ -82,8 +137,14 @@ int main(int argc, char* argv[]) {
       return EXIT_SUCCESS;
     }
 
-    const auto myCommands =
-        (not myOutputTimestamp.empty()) + (not myDumpTimestamp.empty());
+    myFilter.theRegions =
+        us::split<std::set<std::string, std::less<>>>(myRegions, ",");
+    myFilter.theApps =
+        us::split<std::set<std::string, std::less<>>>(myApps, ",");
+
+    const auto myCommands = (not myOutputTimestamp.empty()) +
+                            (not myDumpTimestamp.empty()) +
+                            (not mySynthesizeTimestamp.empty());
 
     if (myCommands != 1) {
       std::cout << "Invalid command" << std::endl << myDesc << std::endl;
@@ -91,22 +152,57 @@ int main(int argc, char* argv[]) {
     }
 
     if (not myOutputTimestamp.empty()) {
-      std::ifstream myRawStream(myInputRaw);
-      if (not myRawStream) {
-        throw std::runtime_error(
-            "could not open raw dataset file for reading: " + myInputRaw);
+      ud::Dictionary myDictionary;
+      if (myVarMap.count("streaming") > 0) {
+        ud::RowReader myReader(myInputRaw, false, myFilter);
+        ud::saveTimestampDataset(ud::toTimestampDataset(myReader, myDictionary),
+                                 myOutputTimestamp,
+                                 myTimestampVersion);
+      } else {
+        const auto myDataset = ud::loadColumns(
+            myInputRaw, false, myDictionary, myNumThreads, myFilter);
+        ud::saveTimestampDataset(
+            ud::toTimestampDataset(myDataset, myDictionary),
+            myOutputTimestamp,
+            myTimestampVersion);
       }
-      ud::saveTimestampDataset(
-          ud::toTimestampDataset(ud::loadDataset(myRawStream, false)),
-          myOutputTimestamp);
+
+    } else if (not mySynthesizeTimestamp.empty()) {
+      const ud::TraceGenerator myGenerator(
+          ud::loadTimestampDataset(myInputTimestamp, myFilter),
+          myNumQuantiles);
+      const auto myNumEvents = myGenerator.save(mySynthesizeTimestamp,
+                                                myTimestampVersion,
+                                                myNumCopies,
+                                                myDuration,
+                                                mySeed,
+                                                myNumThreads);
+      VLOG(1) << "synthesized " << myNumEvents << " events of "
+              << myGenerator.models().size() * myNumCopies << " keys";
 
     } else if (not myDumpTimestamp.empty()) {
-      const auto myDataset = ud::loadTimestampDataset(myDumpTimestamp);
-      for (const auto& myApp : myDataset) {
-        std::cout << myApp.first << '\n';
-        for (const auto& elem : myApp.second) {
-          std::cout << '\t' << std::get<0>(elem) << '\t'
-                    << (std::get<1>(elem) ? '1' : '0') << '\n';
+      if (ud::timestampDatasetVersion(myDumpTimestamp) == 2 and
+          myFilter.all()) {
+        // read directly from the file, without loading it in memory
+        const ud::MappedTimestampDataset myDataset(myDumpTimestamp);
+        for (std::size_t k = 0; k < myDataset.size(); k++) {
+          std::cout << myDataset.key(k) << '\n';
+          const auto& myEvents = myDataset.events(k);
+          for (std::size_t i = 0; i < myEvents.size(); i++) {
+            std::cout << '\t' << myEvents.timestamp(i) << '\t'
+                      << (myEvents.write(i) ? '1' : '0') << '\n';
+          }
+        }
+
+      } else {
+        const auto myDataset =
+            ud::loadTimestampDataset(myDumpTimestamp, myFilter);
+        for (const auto& myApp : myDataset) {
+          std::cout << myApp.first << '\n';
+          for (const auto& elem : myApp.second) {
+            std::cout << '\t' << std::get<0>(elem) << '\t'
+                      << (std::get<1>(elem) ? '1' : '0') << '\n';
+          }
         }
       }
     }
@@ -49,8 +49,11 @@ SOFTWARE.
 #include <deque>
 #include <exception>
 #include <fstream>
+#include <functional>
 #include <stdexcept>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace po = boost::program_options;
 namespace us = uiiit::support;
@@ -63,6 +66,13 @@ int main(int argc, char* argv[]) {
   std::string   myOutputDir;
   std::string   myAnalysis;
   ud::CostModel myCostModel;
+  std::string   myCostModelsFilename;
+  std::size_t   myBestNextLookAhead;
+  std::string   myPolicies;
+  std::size_t   myNumThreads;
+  std::string   myRegions;
+  std::string   myApps;
+  ud::RowFilter myFilter;
 
   po::options_description myDesc("Allowed options");
   // clang-format off
@@ -81,6 +91,23 @@ int main(int argc, char* argv[]) {
     ("analysis",
      po::value<std::string>(&myAnalysis)->default_value("invocation-only"),
      "Type of analysis, one of: {invocation-only, dump-periods}.")
+    ("num-threads",
+     po::value<std::size_t>(&myNumThreads)->default_value(0),
+     "Number of threads used to load the dataset and to compute the costs, 0 means all the hardware threads.")
+    ("streaming",
+     "Read the dataset one row at a time in a single thread, instead of loading it in memory, so that only the timestamps are kept.")
+    ("regions",
+     po::value<std::string>(&myRegions)->default_value(""),
+     "Comma-separated list of the regions whose events are loaded, all if empty.")
+    ("apps",
+     po::value<std::string>(&myApps)->default_value(""),
+     "Comma-separated list of the apps whose events are loaded, all if empty.")
+    ("begin-time",
+     po::value<double>(&myFilter.theBegin),
+     "Only load the events with a timestamp not smaller than this value, in ms.")
+    ("end-time",
+     po::value<double>(&myFilter.theEnd),
+     "Only load the events with a timestamp smaller than this value, in ms.")
     ("cost-exec-mu",
      po::value<double>(&myCostModel.theCostExecMu)->default_value(1),
      "Cost of executing a single invocation as microservice.")
@@ -105,6 +132,15 @@ int main(int argc, char* argv[]) {
     ("cost-migrate-lambda",
      po::value<double>(&myCostModel.theCostMigrateLambda)->default_value(50),
      "Cost of migrating from microservice to stateless")
+    ("best-next-look-ahead",
+     po::value<std::size_t>(&myBestNextLookAhead)->default_value(500),
+     "Maximum number of future invocations considered by best-next to migrate from stateless to microservice, 0 means unlimited.")
+    ("policies",
+     po::value<std::string>(&myPolicies)->default_value(""),
+     "Comma-separated list of online policies, whose costs are added as the last columns of the output, in the same order. Supported: ski-rental, randomized-ski-rental[(seed)], ewma[(alpha)].")
+    ("cost-models",
+     po::value<std::string>(&myCostModelsFilename)->default_value(""),
+     "File with the cost models to be evaluated all together in a single pass, which overrides the individual costs above. One model per line, with comma-separated costs in the order of the --cost-* options, where each cost can be a colon-separated list of values to evaluate all their combinations. With dump-periods and more than one model, the periods of the i-th model are saved in the subdirectory i of the output directory.")
     ;
   // clang-format on
 
@@ -132,23 +168,51 @@ int main(int argc, char* argv[]) {
       for (const auto& myLabel : ud::CostOutput::explain()) {
         std::cout << '#' << myIndex++ << '\t' << myLabel << '\n';
       }
+      for (const auto& myPolicy :
+           us::split<std::vector<std::string>>(myPolicies, ",")) {
+        std::cout << '#' << myIndex++ << '\t' << myPolicy << '\n';
+      }
       return EXIT_SUCCESS;
     }
 
+    myFilter.theRegions =
+        us::split<std::set<std::string, std::less<>>>(myRegions, ",");
+    myFilter.theApps =
+        us::split<std::set<std::string, std::less<>>>(myApps, ",");
+
     if (myDatasetFilename.empty()) {
       throw std::runtime_error("Empty input filename");
       return EXIT_FAILURE;
     }
 
     VLOG(1) << "reading from: " << myDatasetFilename;
-    std::ifstream myDatasetStream(myDatasetFilename);
-    if (not myDatasetStream) {
-      throw std::runtime_error("could not open dataset file for reading: " +
-                               myDatasetFilename);
+    ud::Dictionary       myDictionary;
+    ud::TimestampDataset myDataset;
+    if (myVarMap.count("streaming") > 0) {
+      ud::RowReader myReader(myDatasetFilename, false, myFilter);
+      myDataset = ud::toTimestampDataset(myReader, myDictionary);
+    } else {
+      myDataset = ud::toTimestampDataset(
+          ud::loadColumns(myDatasetFilename,
+                          false,
+                          myDictionary,
+                          myNumThreads,
+                          myFilter),
+          myDictionary);
+    }
+
+    std::vector<ud::CostModel> myCostModels;
+    if (myCostModelsFilename.empty()) {
+      myCostModels.emplace_back(myCostModel);
+    } else {
+      myCostModels = ud::loadCostModels(myCostModelsFilename);
+      if (myCostModels.empty()) {
+        throw std::runtime_error("No cost models in " + myCostModelsFilename);
+      }
     }
-    auto myDataset = ud::loadDataset(myDatasetStream, false);
 
-    VLOG(1) << "analyzing dataset";
+    VLOG(1) << "analyzing dataset with " << myCostModels.size()
+            << " cost model(s)";
     if (myAnalysis == "invocation-only") {
       std::ofstream mySummaryStream(
           (boost::filesystem::path(myOutputDir) /
@@ -158,24 +222,43 @@ int main(int argc, char* argv[]) {
           myVarMap.count("append") ? std::ios::app : std::ios::trunc);
 
       const auto myCosts =
-          ud::cost(ud::toTimestampDataset(myDataset), myCostModel, false);
-      for (const auto& myCost : myCosts) {
-        mySummaryStream << myCost.first << ',' << myCostModel.toString() << ','
-                        << myCost.second.toString() << '\n';
+          ud::cost(myDataset,
+                   myCostModels,
+                   false,
+                   myNumThreads,
+                   myBestNextLookAhead,
+                   us::split<std::vector<std::string>>(myPolicies, ","));
+      for (std::size_t m = 0; m < myCostModels.size(); ++m) {
+        const auto myCostModelString = myCostModels[m].toString();
+        for (const auto& myCost : myCosts) {
+          mySummaryStream << myCost.first << ',' << myCostModelString << ','
+                          << myCost.second[m].toString() << '\n';
+        }
       }
 
     } else if (myAnalysis == "dump-periods") {
       const auto myCosts =
-          ud::cost(ud::toTimestampDataset(myDataset), myCostModel, true);
-      for (const auto& myCost : myCosts) {
-        if (myCost.second.theBestNextPeriods.empty()) {
-          continue;
+          ud::cost(myDataset,
+                   myCostModels,
+                   true,
+                   myNumThreads,
+                   myBestNextLookAhead,
+                   us::split<std::vector<std::string>>(myPolicies, ","));
+      for (std::size_t m = 0; m < myCostModels.size(); ++m) {
+        auto myDir = boost::filesystem::path(myOutputDir);
+        if (myCostModels.size() > 1) {
+          myDir /= std::to_string(m);
+          boost::filesystem::create_directories(myDir);
         }
-        std::ofstream myPeriodStream(
-            (boost::filesystem::path(myOutputDir) / (myCost.first + ".dat"))
-                .string());
-        for (const auto& myPeriod : myCost.second.theBestNextPeriods) {
-          myPeriodStream << myPeriod << '\n';
+        for (const auto& myCost : myCosts) {
+          if (myCost.second[m].theBestNextPeriods.empty()) {
+            continue;
+          }
+          std::ofstream myPeriodStream(
+              (myDir / (myCost.first + ".dat")).string());
+          for (const auto& myPeriod : myCost.second[m].theBestNextPeriods) {
+            myPeriodStream << myPeriod << '\n';
+          }
         }
       }
 
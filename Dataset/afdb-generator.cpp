@@ -0,0 +1,264 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ support library
+ |_______|__||__|__|__|    https://github.com/ccicconetti/support
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2022 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Dataset/afdb-generator.h"
+
+#include "Support/batchrandom.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace uiiit {
+namespace dataset {
+
+namespace {
+
+//! Number of keys generated by a thread before writing them.
+constexpr std::size_t theBatchSize = 64;
+
+//! Inverse of the resolution of the timestamps generated, in ms.
+constexpr double theTicksPerMs = 1000;
+
+} // namespace
+
+TraceGenerator::TraceGenerator(const TimestampDataset& aDataset,
+                               const std::size_t       aNumQuantiles)
+    : theBegin(std::numeric_limits<double>::infinity())
+    , theDuration(0)
+    , theModels()
+    , theInterArrivalRvs() {
+  if (aNumQuantiles == 0) {
+    throw std::runtime_error("Invalid zero number of quantiles");
+  }
+
+  auto myEnd = -std::numeric_limits<double>::infinity();
+  for (const auto& myApp : aDataset) {
+    if (not myApp.second.empty()) {
+      theBegin = std::min(theBegin, std::get<0>(myApp.second.front()));
+      myEnd    = std::max(myEnd, std::get<0>(myApp.second.back()));
+    }
+  }
+  if (not(myEnd > theBegin)) {
+    throw std::runtime_error(
+        "Cannot fit a dataset without events at different times");
+  }
+  theDuration = myEnd - theBegin;
+
+  // sort the keys so that the index of a model does not depend on the hash
+  // table, since it is used to seed the r.v.s
+  std::vector<const TimestampDataset::value_type*> myApps;
+  myApps.reserve(aDataset.size());
+  for (const auto& myApp : aDataset) {
+    if (not myApp.second.empty()) {
+      myApps.emplace_back(&myApp);
+    }
+  }
+  std::sort(myApps.begin(), myApps.end(), [](auto aLhs, auto aRhs) {
+    return aLhs->first < aRhs->first;
+  });
+
+  theModels.reserve(myApps.size());
+  theInterArrivalRvs.reserve(myApps.size());
+  for (const auto& myApp : myApps) {
+    theModels.emplace_back(fit(myApp->first, myApp->second, aNumQuantiles));
+    // the seed does not matter since the values are only drawn with value()
+    theInterArrivalRvs.emplace_back(std::make_unique<support::EmpiricalRv>(
+        theModels.back().theInterArrivals, 0, 0, 0));
+  }
+}
+
+std::string TraceGenerator::key(const std::size_t aModel,
+                                const std::size_t aCopy) const {
+  const auto& myKey = theModels[aModel].theKey;
+  if (aCopy == 0) {
+    return myKey;
+  }
+  const auto myComma = std::min(myKey.find(','), myKey.size());
+  return myKey.substr(0, myComma) + '~' + std::to_string(aCopy) +
+         myKey.substr(myComma);
+}
+
+TimestampDataset::mapped_type
+TraceGenerator::generate(const std::size_t aModel,
+                         const std::size_t aCopy,
+                         const double      aDuration,
+                         const std::size_t aSeed) const {
+  assert(aModel < theModels.size());
+  const auto& myModel = theModels[aModel];
+  const auto  myEnd   = theBegin + (aDuration > 0 ? aDuration : theDuration);
+
+  // the distribution is shared by all the copies, each with its own stream
+  const auto&           myGapRv = *theInterArrivalRvs[aModel];
+  support::Xoshiro256pp myGenerator(aSeed, aModel, aCopy);
+  const auto            myUnit = [&myGenerator]() {
+    return support::detail::toUnitDouble(myGenerator());
+  };
+
+  // the first event is a uniform fraction of an inter-arrival time after the
+  // beginning, so that the copies are not aligned
+  const auto myPhase = myUnit();
+  auto       myTime  = theBegin + myPhase * myGapRv.value(myUnit());
+  auto       myWrite = false;
+
+  TimestampDataset::mapped_type ret;
+  while (myTime < myEnd) {
+    const auto myProb = ret.empty() ? myModel.theWriteFirst :
+                        myWrite     ? myModel.theWriteAfterWrite :
+                                      myModel.theWriteAfterRead;
+    myWrite           = myUnit() < myProb;
+    ret.emplace_back(std::nearbyint(myTime * theTicksPerMs) / theTicksPerMs,
+                     myWrite);
+    myTime += myGapRv.value(myUnit());
+  }
+  return ret;
+}
+
+std::size_t TraceGenerator::save(const std::string& aFilename,
+                                 const std::size_t  aVersion,
+                                 const std::size_t  aNumCopies,
+                                 const double       aDuration,
+                                 const std::size_t  aSeed,
+                                 const std::size_t  aNumThreads) const {
+  if (aNumCopies == 0) {
+    throw std::runtime_error("Invalid zero number of copies");
+  }
+  if (aDuration < 0) {
+    throw std::runtime_error("Invalid negative duration: " +
+                             std::to_string(aDuration));
+  }
+
+  TimestampDatasetWriter myWriter(aFilename, aVersion);
+  const auto             myNumKeys = theModels.size() * aNumCopies;
+  const auto myNumBatches = (myNumKeys + theBatchSize - 1) / theBatchSize;
+
+  // the batches are taken in order, then each thread waits for its turn to
+  // write, which comes after all the previous batches have been written
+  std::atomic<std::size_t> myNext(0);
+  std::mutex               myMutex;
+  std::condition_variable  myTurnCv;
+  std::size_t              myTurn   = 0;
+  bool                     myFailed = false;
+  std::size_t              ret      = 0;
+  detail::parallelFor(
+      std::min(detail::numThreads(aNumThreads), myNumBatches),
+      [&](const std::size_t) {
+        try {
+          std::vector<TimestampDataset::mapped_type> myEvents;
+          for (auto b = myNext++; b < myNumBatches; b = myNext++) {
+            const auto myFirst = b * theBatchSize;
+            const auto myLast  = std::min(myFirst + theBatchSize, myNumKeys);
+            myEvents.resize(myLast - myFirst);
+            for (auto k = myFirst; k < myLast; k++) {
+              myEvents[k - myFirst] =
+                  generate(k / aNumCopies, k % aNumCopies, aDuration, aSeed);
+            }
+
+            std::unique_lock<std::mutex> myLock(myMutex);
+            myTurnCv.wait(myLock, [&]() { return myFailed or myTurn == b; });
+            if (myFailed) {
+              return;
+            }
+            for (auto k = myFirst; k < myLast; k++) {
+              const auto& myKeyEvents = myEvents[k - myFirst];
+              myWriter.add(key(k / aNumCopies, k % aNumCopies), myKeyEvents);
+              ret += myKeyEvents.size();
+            }
+            myTurn++;
+            myTurnCv.notify_all();
+          }
+        } catch (...) {
+          // do not leave the other threads waiting for this one's turn
+          const std::lock_guard<std::mutex> myLock(myMutex);
+          myFailed = true;
+          myTurnCv.notify_all();
+          throw;
+        }
+      });
+  myWriter.close();
+  return ret;
+}
+
+TraceGenerator::Model
+TraceGenerator::fit(const std::string&                   aKey,
+                    const TimestampDataset::mapped_type& aEvents,
+                    const std::size_t                    aNumQuantiles) const {
+  assert(not aEvents.empty());
+  Model ret{aKey, {}, 0, 0, 0};
+
+  std::vector<double> myGaps;
+  myGaps.reserve(aEvents.size() - 1);
+  std::array<std::array<std::size_t, 2>, 2> myTransitions{};
+  std::size_t                               myNumWrites = 0;
+  for (std::size_t i = 0; i < aEvents.size(); i++) {
+    myNumWrites += std::get<1>(aEvents[i]);
+    if (i > 0) {
+      myGaps.emplace_back(std::get<0>(aEvents[i]) -
+                          std::get<0>(aEvents[i - 1]));
+      myTransitions[std::get<1>(aEvents[i - 1])][std::get<1>(aEvents[i])]++;
+    }
+  }
+
+  // inter-arrival times
+  std::sort(myGaps.begin(), myGaps.end());
+  if (myGaps.empty() or not(myGaps.back() > 0)) {
+    ret.theInterArrivals.emplace_back(theDuration / aEvents.size(), 1.0);
+  } else {
+    const auto myNumQuantiles = std::min(aNumQuantiles, myGaps.size());
+    for (std::size_t q = 0; q <= myNumQuantiles; q++) {
+      const auto myPos = static_cast<std::size_t>(std::llround(
+          static_cast<double>(q) * (myGaps.size() - 1) / myNumQuantiles));
+      ret.theInterArrivals.emplace_back(
+          myGaps[myPos], static_cast<double>(q) / myNumQuantiles);
+    }
+  }
+
+  // read/write sequence, using the fraction of writes without transitions
+  ret.theWriteFirst = static_cast<double>(myNumWrites) / aEvents.size();
+  const auto myWriteAfter = [&](const bool aWrite) {
+    const auto& myCounts = myTransitions[aWrite];
+    return myCounts[0] + myCounts[1] == 0 ?
+               ret.theWriteFirst :
+               static_cast<double>(myCounts[1]) / (myCounts[0] + myCounts[1]);
+  };
+  ret.theWriteAfterRead  = myWriteAfter(false);
+  ret.theWriteAfterWrite = myWriteAfter(true);
+
+  return ret;
+}
+
+} // namespace dataset
+} // namespace uiiit
@@ -0,0 +1,185 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ support library
+ |_______|__||__|__|__|    https://github.com/ccicconetti/support
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2022 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Dataset/afdb-utils.h"
+#include "Support/distributions.h"
+#include "Support/macros.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace uiiit {
+namespace dataset {
+
+/**
+ * @brief Generator of synthetic traces with the statistics of a timestamp
+ * dataset, scaled to an arbitrary number of keys and duration.
+ *
+ * For every key of the dataset a model is fitted with:
+ * - the distribution of the inter-arrival times, as the empirical CDF
+ *   through a given number of quantiles, from which the synthetic
+ *   inter-arrival times are drawn with support::EmpiricalRv;
+ * - the sequence of read and write accesses, as a two-state Markov chain
+ *   with the probability of a write after a read and after a write.
+ *
+ * Each model is instantiated into any number of copies of the key, each
+ * drawing from its own support::Xoshiro256pp generator seeded by the seed of
+ * the trace, the index of the key, and the index of the copy, which is cheap
+ * to create even for keys with few events. Hence a synthetic key is the same
+ * regardless of the number of copies, the number of threads, or which
+ * other keys are generated. The first event of every copy is drawn at a
+ * uniform fraction of an inter-arrival time after the beginning of the
+ * trace, so that the copies are not aligned, and the timestamps are rounded
+ * to 1 us, which is stored compactly in version 3 of the format.
+ */
+class TraceGenerator final
+{
+  NONCOPYABLE_NONMOVABLE(TraceGenerator);
+
+ public:
+  //! The statistics of a key fitted from the dataset.
+  struct Model {
+    std::string theKey;
+    //! The points of the CDF of the inter-arrival times, in ms.
+    std::vector<std::pair<double, double>> theInterArrivals;
+    //! Probability that the first event is a write.
+    double theWriteFirst;
+    //! Probability of a write after a read.
+    double theWriteAfterRead;
+    //! Probability of a write after a write.
+    double theWriteAfterWrite;
+  };
+
+  /**
+   * @brief Fit the models of all the keys of a dataset.
+   *
+   * The keys with a single event, or whose events all have the same
+   * timestamp, have a constant inter-arrival time equal to the duration of
+   * the dataset divided by their number of events.
+   *
+   * @param aDataset The dataset, with the events of every key sorted in
+   * chronological order.
+   * @param aNumQuantiles The number of intervals of the empirical CDF of the
+   * inter-arrival times of every key, fewer for the keys with fewer
+   * inter-arrival times.
+   *
+   * @throw std::runtime_error if the dataset has no events, they all have
+   * the same timestamp, or the number of quantiles is zero.
+   */
+  explicit TraceGenerator(const TimestampDataset& aDataset,
+                          const std::size_t       aNumQuantiles = 32);
+
+  //! @return the models, sorted by key.
+  const std::vector<Model>& models() const noexcept {
+    return theModels;
+  }
+
+  //! @return the timestamp of the first event in the dataset, in ms.
+  double begin() const noexcept {
+    return theBegin;
+  }
+
+  //! @return the time between the first and last event in the dataset, in ms.
+  double duration() const noexcept {
+    return theDuration;
+  }
+
+  /**
+   * @brief Return the name of a copy of a key: the first copy has the same
+   * name as the original key, the others have the user followed by ~ and the
+   * index of the copy, so that the app is unchanged.
+   */
+  std::string key(const std::size_t aModel, const std::size_t aCopy) const;
+
+  /**
+   * @brief Generate the events of a copy of a key.
+   *
+   * @param aModel The index of the model, see models().
+   * @param aCopy The index of the copy.
+   * @param aDuration The events are generated from begin() for this time, in
+   * ms, 0 means the same duration as the dataset.
+   * @param aSeed The seed of the trace.
+   * @return the events in chronological order.
+   */
+  TimestampDataset::mapped_type generate(const std::size_t aModel,
+                                         const std::size_t aCopy,
+                                         const double      aDuration,
+                                         const std::size_t aSeed) const;
+
+  /**
+   * @brief Generate a synthetic trace straight to file.
+   *
+   * The keys are generated in parallel in batches, which are written in the
+   * order of the keys as soon as they are complete, hence the file does not
+   * depend on the number of threads and only the batches being generated are
+   * in memory.
+   *
+   * @param aFilename The name of the file.
+   * @param aVersion The version of the format, either 2 or 3.
+   * @param aNumCopies The number of copies of every key.
+   * @param aDuration Same as in generate().
+   * @param aSeed The seed of the trace.
+   * @param aNumThreads The number of threads, 0 means hardware concurrency.
+   * @return the number of events generated.
+   *
+   * @throw std::runtime_error if the file cannot be written, the version is
+   * not valid, the number of copies is zero, or the duration is negative. A
+   * file left incomplete is not valid, see TimestampDatasetWriter.
+   */
+  std::size_t save(const std::string& aFilename,
+                   const std::size_t  aVersion,
+                   const std::size_t  aNumCopies,
+                   const double       aDuration,
+                   const std::size_t  aSeed,
+                   const std::size_t  aNumThreads) const;
+
+ private:
+  //! Fit the model of a key.
+  Model fit(const std::string&                   aKey,
+            const TimestampDataset::mapped_type& aEvents,
+            const std::size_t                    aNumQuantiles) const;
+
+ private:
+  double             theBegin;
+  double             theDuration;
+  std::vector<Model> theModels;
+
+  // the distributions of the inter-arrival times, in the same order
+  std::vector<std::unique_ptr<support::EmpiricalRv>> theInterArrivalRvs;
+};
+
+} // namespace dataset
+} // namespace uiiit
@@ -0,0 +1,255 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ support library
+ |_______|__||__|__|__|    https://github.com/ccicconetti/support
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2022 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Dataset/afdb-policies.h"
+
+#include "Dataset/afdb-utils.h"
+#include "Support/batchrandom.h"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+namespace uiiit {
+namespace dataset {
+
+namespace {
+
+/**
+ * @brief Parse a number that must take the whole string.
+ *
+ * @throw std::runtime_error if the string is not a valid number.
+ */
+template <typename T>
+T parseArgument(const std::string_view aValue,
+                const std::string&     aDescription) {
+  T          ret;
+  const auto myEnd    = aValue.data() + aValue.size();
+  const auto myResult = std::from_chars(aValue.data(), myEnd, ret);
+  if (aValue.empty() or myResult.ec != std::errc() or myResult.ptr != myEnd) {
+    throw std::runtime_error("Invalid policy: " + aDescription);
+  }
+  return ret;
+}
+
+} // namespace
+
+Policy::Factory Policy::factory(const std::string& aDescription) {
+  // the description is a name optionally followed by an argument between
+  // parentheses, e.g., ewma(0.3)
+  std::string_view                myName(aDescription);
+  std::optional<std::string_view> myArgument;
+  const auto                      myOpen = myName.find('(');
+  if (myOpen != std::string_view::npos) {
+    if (myName.back() != ')') {
+      throw std::runtime_error("Invalid policy: " + aDescription);
+    }
+    myArgument = myName.substr(myOpen + 1, myName.size() - myOpen - 2);
+    myName     = myName.substr(0, myOpen);
+  }
+
+  if (myName == "ski-rental" and not myArgument.has_value()) {
+    return [](const CostModel& aCostModel, const std::size_t) {
+      return std::make_unique<SkiRentalPolicy>(aCostModel);
+    };
+  } else if (myName == "randomized-ski-rental") {
+    const auto mySeed =
+        myArgument.has_value() ?
+            parseArgument<std::size_t>(*myArgument, aDescription) :
+            0;
+    return [mySeed](const CostModel& aCostModel, const std::size_t aApp) {
+      return std::make_unique<RandomizedSkiRentalPolicy>(
+          aCostModel, mySeed, aApp);
+    };
+  } else if (myName == "ewma") {
+    const auto myAlpha =
+        myArgument.has_value() ?
+            parseArgument<double>(*myArgument, aDescription) :
+            0.5;
+    // check the weight now rather than with the first app
+    EwmaPolicy(CostModel(), myAlpha);
+    return [myAlpha](const CostModel& aCostModel, const std::size_t) {
+      return std::make_unique<EwmaPolicy>(aCostModel, myAlpha);
+    };
+  }
+
+  throw std::runtime_error("Invalid policy: " + aDescription);
+}
+
+std::unique_ptr<Policy> Policy::fromString(const std::string& aDescription,
+                                           const CostModel&   aCostModel,
+                                           const std::size_t  aApp) {
+  return factory(aDescription)(aCostModel, aApp);
+}
+
+SkiRentalPolicy::SkiRentalPolicy(const CostModel& aCostModel)
+    : Policy()
+    , theCostModel(aCostModel)
+    , theThreshold(1)
+    , theRegret(0)
+    , theMicroservice(false)
+    , theTimeout(0) {
+  // noop
+}
+
+Policy::Decision SkiRentalPolicy::decide(const bool aMicroservice,
+                                         const bool aWrite) {
+  // a migration pays off only if it is not undone right away, which costs
+  // the migration in the opposite direction, too
+  const auto myRoundTrip =
+      theCostModel.theCostMigrateMu + theCostModel.theCostMigrateLambda;
+  const auto myExecDiff = theCostModel.theCostExecMu -
+                          theCostModel.theCostExecLambda - rw(aWrite);
+
+  if (not aMicroservice) {
+    const auto myRegret = std::max(0.0, theRegret - myExecDiff);
+    if (myRegret <= 0 or myRegret < theThreshold * myRoundTrip) {
+      theRegret       = myRegret;
+      theMicroservice = false;
+      return Decision{false, 0};
+    }
+    reset();
+  }
+
+  // the regret grows while the microservice is kept warm, starting from the
+  // difference of the execution costs
+  theMicroservice = true;
+  theRegret       = std::max(0.0, theRegret + myExecDiff);
+  const auto myRate =
+      theCostModel.theCostWarmMu - theCostModel.theCostWarmLambda;
+  const auto myMaxRegret = theThreshold * myRoundTrip;
+  if (theRegret > 0 and theRegret >= myMaxRegret) {
+    theTimeout = 0;
+  } else if (myRate <= 0) {
+    theTimeout = std::numeric_limits<double>::infinity();
+  } else {
+    theTimeout = (myMaxRegret - theRegret) / myRate;
+  }
+  return Decision{true, theTimeout};
+}
+
+void SkiRentalPolicy::observe(const double aTimeToNext) {
+  const auto myRate =
+      theCostModel.theCostWarmMu - theCostModel.theCostWarmLambda;
+  if (theMicroservice and aTimeToNext > theTimeout) {
+    // the microservice has migrated to stateless function at the timeout
+    reset();
+    theMicroservice = false;
+    theRegret       = -myRate * (aTimeToNext - theTimeout);
+
+  } else if (theMicroservice) {
+    theRegret += myRate * aTimeToNext;
+
+  } else {
+    theRegret -= myRate * aTimeToNext;
+  }
+
+  // a state that has been cheaper so far does not bank credit
+  theRegret = std::max(0.0, theRegret);
+}
+
+double SkiRentalPolicy::threshold() {
+  return 1;
+}
+
+void SkiRentalPolicy::reset() {
+  theRegret    = 0;
+  theThreshold = threshold();
+}
+
+double SkiRentalPolicy::rw(const bool aWrite) const {
+  return aWrite ? theCostModel.theCostWriteLambda :
+                  theCostModel.theCostReadLambda;
+}
+
+RandomizedSkiRentalPolicy::RandomizedSkiRentalPolicy(
+    const CostModel&  aCostModel,
+    const std::size_t aSeed,
+    const std::size_t aApp)
+    : SkiRentalPolicy(aCostModel)
+    , theGenerator(aSeed, aApp, 0) {
+  // the base class cannot draw the first threshold during its construction
+  reset();
+}
+
+double RandomizedSkiRentalPolicy::threshold() {
+  // inverse of the CDF (exp(x) - 1) / (e - 1) in [0, 1]
+  return std::log1p(support::detail::toUnitDouble(theGenerator()) *
+                    (std::exp(1.0) - 1));
+}
+
+EwmaPolicy::EwmaPolicy(const CostModel& aCostModel, const double aAlpha)
+    : Policy()
+    , theCostModel(aCostModel)
+    , theAlpha(aAlpha)
+    , theValid(false)
+    , thePrediction(0) {
+  if (not(aAlpha > 0 and aAlpha <= 1)) {
+    throw std::runtime_error("Invalid EWMA weight: " + std::to_string(aAlpha));
+  }
+}
+
+Policy::Decision EwmaPolicy::decide(const bool, const bool aWrite) {
+  if (not theValid) {
+    return Decision{false, 0};
+  }
+
+  const auto myCostMu = theCostModel.theCostExecMu +
+                        theCostModel.theCostWarmMu * thePrediction;
+  const auto myCostLambda =
+      theCostModel.theCostExecLambda +
+      (aWrite ? theCostModel.theCostWriteLambda :
+                theCostModel.theCostReadLambda) +
+      theCostModel.theCostWarmLambda * thePrediction;
+  if (myCostMu >= myCostLambda) {
+    return Decision{false, 0};
+  }
+
+  const auto myRate =
+      theCostModel.theCostWarmMu - theCostModel.theCostWarmLambda;
+  return Decision{true,
+                  myRate <= 0 ? std::numeric_limits<double>::infinity() :
+                                theCostModel.theCostMigrateLambda / myRate};
+}
+
+void EwmaPolicy::observe(const double aTimeToNext) {
+  thePrediction = theValid ? theAlpha * aTimeToNext +
+                                 (1 - theAlpha) * thePrediction :
+                             aTimeToNext;
+  theValid      = true;
+}
+
+} // namespace dataset
+} // namespace uiiit
@@ -0,0 +1,215 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ support library
+ |_______|__||__|__|__|    https://github.com/ccicconetti/support
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2022 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Dataset/afdb-utils.h"
+#include "Support/counterrandom.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace uiiit {
+namespace dataset {
+
+/**
+ * @brief Online policy deciding how to run an app without knowing when its
+ * next invocation will arrive.
+ *
+ * At every invocation the policy decides whether to serve it as a
+ * microservice, which requires a migration if the app is currently a
+ * stateless function, and for how long to keep the microservice warm
+ * afterwards. If the next invocation does not arrive before the timeout, then
+ * the app migrates to stateless function. Then the policy learns the actual
+ * time until the next invocation. The costs are the same as in CostModel.
+ */
+class Policy
+{
+ public:
+  //! What to do with an invocation.
+  struct Decision {
+    //! True if the invocation is served as a microservice, ignored if the
+    //! app already is a microservice.
+    bool theMicroservice;
+    //! How long to keep the microservice warm after the invocation.
+    double theTimeout;
+  };
+
+  virtual ~Policy() {
+  }
+
+  /**
+   * @brief Decide what to do with the current invocation.
+   *
+   * @param aMicroservice True if the app is currently a microservice.
+   * @param aWrite True if the invocation is a write.
+   */
+  virtual Decision decide(const bool aMicroservice, const bool aWrite) = 0;
+
+  //! Learn the time between the current and the next invocation.
+  virtual void observe(const double aTimeToNext) = 0;
+
+  //! Create the policy of a single app, given the cost model and an
+  //! identifier of the app.
+  using Factory = std::function<std::unique_ptr<Policy>(const CostModel&,
+                                                        const std::size_t)>;
+
+  /**
+   * @brief Parse a description of a policy once, returning a factory that
+   * creates a new policy for every app.
+   *
+   * @param aDescription the following descriptions are supported:
+   *
+   * - ski-rental -> see SkiRentalPolicy
+   * - randomized-ski-rental or randomized-ski-rental(seed) -> see
+   *   RandomizedSkiRentalPolicy, the seed is 0 if not specified
+   * - ewma or ewma(alpha) -> see EwmaPolicy, alpha is 0.5 if not specified
+   *
+   * The identifier of the app is used so that the randomized policies draw
+   * different values for different apps.
+   *
+   * @throw std::runtime_error if the description is not valid
+   */
+  static Factory factory(const std::string& aDescription);
+
+  /**
+   * @brief Return a new policy for a single app, same as
+   * factory(aDescription)(aCostModel, aApp).
+   *
+   * @throw std::runtime_error if the description is not valid
+   */
+  static std::unique_ptr<Policy> fromString(const std::string& aDescription,
+                                            const CostModel&   aCostModel,
+                                            const std::size_t  aApp);
+};
+
+/**
+ * @brief Deterministic ski-rental policy.
+ *
+ * The policy accumulates the regret of the current state, i.e., how much
+ * more it has paid than it would have in the other state, and it migrates
+ * when the regret reaches the cost of migrating there and back, after which
+ * the regret starts again from zero. As a microservice the regret grows
+ * continuously while waiting, so the migration happens at a timeout, whereas
+ * a stateless function can only migrate when invoked. This is the break-even
+ * strategy: if waiting as a microservice costs at least as much as waiting
+ * as a stateless function, it pays at most twice the optimal cost plus that
+ * of one migration in each direction; otherwise the cost of a stateless
+ * function waiting for a long time is not bounded.
+ */
+class SkiRentalPolicy : public Policy
+{
+ public:
+  explicit SkiRentalPolicy(const CostModel& aCostModel);
+
+  Decision decide(const bool aMicroservice, const bool aWrite) override;
+  void     observe(const double aTimeToNext) override;
+
+ protected:
+  //! @return the fraction of the migration cost that triggers a migration.
+  virtual double threshold();
+
+  //! Called after every migration.
+  void reset();
+
+  //! @return the cost of a read or write as stateless function.
+  double rw(const bool aWrite) const;
+
+ private:
+  const CostModel theCostModel;
+  double          theThreshold;
+  double          theRegret;
+
+  // the last decision
+  bool   theMicroservice;
+  double theTimeout;
+};
+
+/**
+ * @brief Randomized ski-rental policy.
+ *
+ * Like SkiRentalPolicy, but after every migration the regret that triggers
+ * the next one is a random fraction of the migration cost between 0 and 1,
+ * with probability density proportional to exp(x), which brings the expected
+ * competitive ratio down to e/(e-1). The fractions are drawn from a
+ * counter-based generator, which is cheap to create for every app.
+ */
+class RandomizedSkiRentalPolicy final : public SkiRentalPolicy
+{
+ public:
+  explicit RandomizedSkiRentalPolicy(const CostModel&  aCostModel,
+                                     const std::size_t aSeed,
+                                     const std::size_t aApp);
+
+ protected:
+  double threshold() override;
+
+ private:
+  support::Philox4x32 theGenerator;
+};
+
+/**
+ * @brief Policy predicting the next inter-arrival time with an exponentially
+ * weighted moving average of the past ones.
+ *
+ * The app is served as a microservice if it would be cheaper than as a
+ * stateless function with the predicted inter-arrival time, like best-next
+ * does with the actual ones. A microservice is kept warm until its extra cost
+ * exceeds that of migrating to stateless function. Until the first
+ * inter-arrival time is known the app is a stateless function.
+ */
+class EwmaPolicy final : public Policy
+{
+ public:
+  /**
+   * @brief Create a policy.
+   *
+   * @param aCostModel The cost model.
+   * @param aAlpha The weight of the last inter-arrival time, in (0, 1].
+   *
+   * @throw std::runtime_error if aAlpha is not valid.
+   */
+  explicit EwmaPolicy(const CostModel& aCostModel, const double aAlpha);
+
+  Decision decide(const bool aMicroservice, const bool aWrite) override;
+  void     observe(const double aTimeToNext) override;
+
+ private:
+  const CostModel theCostModel;
+  const double    theAlpha;
+  bool            theValid;
+  double          thePrediction;
+};
+
+} // namespace dataset
+} // namespace uiiit
@@ -0,0 +1,187 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ support library
+ |_______|__||__|__|__|    https://github.com/ccicconetti/support
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2022 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Dataset/afdb-replayer.h"
+#include "Dataset/afdb-utils.h"
+#include "Support/glograii.h"
+#include "Support/queue.h"
+#include "Support/split.h"
+#include "Support/versionutils.h"
+
+#include <boost/program_options.hpp>
+
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace po = boost::program_options;
+namespace us = uiiit::support;
+namespace ud = uiiit::dataset;
+
+int main(int argc, char* argv[]) {
+  us::GlogRaii myGlogRaii(argv[0]);
+
+  std::string   myInputTimestamp;
+  std::string   myOutput;
+  double        mySpeedup;
+  double        myTolerance;
+  std::size_t   myBatchSize;
+  std::string   myApps;
+  ud::RowFilter myFilter;
+
+  po::options_description myDesc("Allowed options");
+  // clang-format off
+  myDesc.add_options()
+    ("help,h", "produce help message")
+    ("version,v", "print version and quit")
+    ("explain", "Print the meaning of the output columns and quit.")
+    ("input-timestamp",
+     po::value<std::string>(&myInputTimestamp)->default_value(""),
+     "Load the timestamp dataset to replay from this file.")
+    ("output",
+     po::value<std::string>(&myOutput)->default_value(""),
+     "Save the events replayed to this file, one per line, with key, timestamp, and write flag.")
+    ("speedup",
+     po::value<double>(&mySpeedup)->default_value(1),
+     "Factor by which the time of the dataset is accelerated, 0 means as fast as possible.")
+    ("tolerance",
+     po::value<double>(&myTolerance)->default_value(0.001),
+     "Lateness above which an event is counted as late, in s.")
+    ("batch-size",
+     po::value<std::size_t>(&myBatchSize)->default_value(0),
+     "If not zero dispatch the events to a consumer thread through a queue, in batches of at most this size.")
+    ("apps",
+     po::value<std::string>(&myApps)->default_value(""),
+     "Comma-separated list of the apps whose events are replayed, all if empty.")
+    ("begin-time",
+     po::value<double>(&myFilter.theBegin),
+     "Only replay the events with a timestamp not smaller than this value, in ms.")
+    ("end-time",
+     po::value<double>(&myFilter.theEnd),
+     "Only replay the events with a timestamp smaller than this value, in ms.")
+    ;
+  // clang-format on
+
+  try {
+    po::variables_map myVarMap;
+    po::store(po::parse_command_line(argc, argv, myDesc), myVarMap);
+    po::notify(myVarMap);
+
+    if (myVarMap.count("help")) {
+      std::cout << myDesc << std::endl;
+      return EXIT_SUCCESS;
+    }
+
+    if (myVarMap.count("version")) {
+      std::cout << us::version() << std::endl;
+      return EXIT_SUCCESS;
+    }
+
+    if (myVarMap.count("explain")) {
+      std::size_t myIndex = 1;
+      for (const auto& myLabel : ud::Replayer::Stats::explain()) {
+        std::cout << '#' << myIndex++ << '\t' << myLabel << '\n';
+      }
+      return EXIT_SUCCESS;
+    }
+
+    if (myInputTimestamp.empty()) {
+      throw std::runtime_error("Empty timestamp dataset file name");
+    }
+
+    myFilter.theApps =
+        us::split<std::set<std::string, std::less<>>>(myApps, ",");
+
+    const auto myDataset =
+        ud::loadTimestampDataset(myInputTimestamp, myFilter);
+    ud::Replayer myReplayer(myDataset, mySpeedup, myTolerance);
+
+    std::ofstream myFile;
+    if (not myOutput.empty()) {
+      myFile.open(myOutput);
+      if (not myFile) {
+        throw std::runtime_error("Could not open file for writing: " +
+                                 myOutput);
+      }
+    }
+    const auto mySave = [&](const ud::Replayer::Event& aEvent) {
+      if (myFile.is_open()) {
+        // shortest representation that is read back as the same timestamp
+        std::array<char, 32> myChars;
+        const auto           myEnd =
+            std::to_chars(myChars.begin(), myChars.end(), aEvent.theTimestamp)
+                .ptr;
+        myFile << myReplayer.key(aEvent.theKey) << ','
+               << std::string_view(myChars.begin(), myEnd - myChars.begin())
+               << ',' << (aEvent.theWrite ? '1' : '0') << '\n';
+      }
+    };
+
+    ud::Replayer::Stats myStats;
+    if (myBatchSize == 0) {
+      myStats = myReplayer.run(mySave);
+
+    } else {
+      us::Queue<std::vector<ud::Replayer::Event>> myQueue;
+      std::thread myConsumer([&]() {
+        while (true) {
+          const auto myBatch = myQueue.pop();
+          if (myBatch.empty()) {
+            break;
+          }
+          for (const auto& myEvent : myBatch) {
+            mySave(myEvent);
+          }
+        }
+      });
+      myStats = myReplayer.run(myQueue, myBatchSize);
+      myConsumer.join();
+    }
+
+    std::cout << myStats.toString() << std::endl;
+
+    return EXIT_SUCCESS;
+  } catch (const std::exception& aErr) {
+    std::cerr << "Exception caught: " << aErr.what() << std::endl;
+  } catch (...) {
+    std::cerr << "Unknown exception caught" << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}
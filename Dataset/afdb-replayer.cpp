@@ -0,0 +1,199 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ support library
+ |_______|__||__|__|__|    https://github.com/ccicconetti/support
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2022 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Dataset/afdb-replayer.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace uiiit {
+namespace dataset {
+
+std::string Replayer::Stats::toString() const {
+  std::stringstream ret;
+  ret << theNumEvents << ',' << theNumLate << ',' << theTarget << ','
+      << theElapsed << ','
+      << (theElapsed > 0 ? theNumEvents / theElapsed : 0.0) << ','
+      << theLatenessAvg << ',' << theLatenessMax;
+  return ret.str();
+}
+
+const std::vector<std::string>& Replayer::Stats::explain() {
+  static std::vector<std::string> myExplain({
+      "number of events",
+      "number of late events",
+      "target duration, in s",
+      "actual duration, in s",
+      "events per second",
+      "average lateness, in s",
+      "maximum lateness, in s",
+  });
+  return myExplain;
+}
+
+Replayer::Replayer(const TimestampDataset& aDataset,
+                   const double            aSpeedup,
+                   const double            aTolerance)
+    : theSpeedup(aSpeedup)
+    , theTolerance(aTolerance)
+    , theKeys()
+    , theCursors()
+    , theHeap() {
+  if (aSpeedup < 0) {
+    throw std::runtime_error("Invalid negative speedup: " +
+                             std::to_string(aSpeedup));
+  }
+  if (aTolerance < 0) {
+    throw std::runtime_error("Invalid negative tolerance: " +
+                             std::to_string(aTolerance));
+  }
+  if (aDataset.size() > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("Too many keys to replay: " +
+                             std::to_string(aDataset.size()));
+  }
+
+  // sort the keys so that the replay does not depend on the hash table
+  theKeys.reserve(aDataset.size());
+  for (const auto& myElem : aDataset) {
+    theKeys.emplace_back(&myElem);
+  }
+  std::sort(theKeys.begin(), theKeys.end(), [](auto aLhs, auto aRhs) {
+    return aLhs->first < aRhs->first;
+  });
+
+  theCursors.resize(theKeys.size());
+  theHeap.reserve(theKeys.size());
+}
+
+Replayer::Stats Replayer::run(support::Queue<std::vector<Event>>& aQueue,
+                              const std::size_t aBatchSize) {
+  if (aBatchSize == 0) {
+    throw std::runtime_error("Invalid zero batch size");
+  }
+
+  std::vector<Event> myBatch;
+  myBatch.reserve(aBatchSize);
+  const auto myFlush = [&]() {
+    if (not myBatch.empty()) {
+      aQueue.push(std::move(myBatch));
+      myBatch = std::vector<Event>();
+      myBatch.reserve(aBatchSize);
+    }
+  };
+  const auto ret = run(
+      [&](const Event& aEvent) {
+        myBatch.emplace_back(aEvent);
+        if (myBatch.size() == aBatchSize) {
+          myFlush();
+        }
+      },
+      myFlush);
+  aQueue.push(std::vector<Event>());
+  return ret;
+}
+
+void Replayer::reset() {
+  theHeap.clear();
+  for (std::uint32_t i = 0; i < theKeys.size(); i++) {
+    const auto& myEvents = theKeys[i]->second;
+    theCursors[i]        = {myEvents.begin(), myEvents.end()};
+    if (not myEvents.empty()) {
+      theHeap.emplace_back(Head{std::get<0>(myEvents.front()), i});
+    }
+  }
+  for (auto i = theHeap.size() / 2; i > 0; i--) {
+    siftDown(i - 1);
+  }
+}
+
+bool Replayer::next(Event& aEvent) {
+  if (theHeap.empty()) {
+    return false;
+  }
+
+  // replace the top of the heap with the next event of the same key, if any
+  auto& myTop    = theHeap.front();
+  auto& myCursor = theCursors[myTop.theKey];
+  aEvent =
+      Event{myTop.theKey, myTop.theTimestamp, std::get<1>(*myCursor.first)};
+  if (++myCursor.first != myCursor.second) {
+    myTop.theTimestamp = std::get<0>(*myCursor.first);
+  } else {
+    myTop = theHeap.back();
+    theHeap.pop_back();
+  }
+  if (not theHeap.empty()) {
+    siftDown(0);
+  }
+  return true;
+}
+
+void Replayer::siftDown(std::size_t aPos) noexcept {
+  const auto mySize  = theHeap.size();
+  const auto myEntry = theHeap[aPos];
+  while (true) {
+    auto myChild = 2 * aPos + 1;
+    if (myChild >= mySize) {
+      break;
+    }
+    if (myChild + 1 < mySize and theHeap[myChild + 1] < theHeap[myChild]) {
+      myChild++;
+    }
+    if (not(theHeap[myChild] < myEntry)) {
+      break;
+    }
+    theHeap[aPos] = theHeap[myChild];
+    aPos          = myChild;
+  }
+  theHeap[aPos] = myEntry;
+}
+
+Replayer::Clock::time_point
+Replayer::waitUntil(const Clock::time_point& aTarget) {
+  // sleeping is not accurate enough below this threshold, hence we spin
+  constexpr auto mySpin = std::chrono::microseconds(200);
+
+  auto myNow = Clock::now();
+  if (aTarget - myNow > mySpin) {
+    std::this_thread::sleep_until(aTarget - mySpin);
+    myNow = Clock::now();
+  }
+  while (myNow < aTarget) {
+    myNow = Clock::now();
+  }
+  return myNow;
+}
+
+} // namespace dataset
+} // namespace uiiit
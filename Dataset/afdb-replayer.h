@@ -0,0 +1,254 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ support library
+ |_______|__||__|__|__|    https://github.com/ccicconetti/support
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2022 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Dataset/afdb-utils.h"
+#include "Support/macros.h"
+#include "Support/queue.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace uiiit {
+namespace dataset {
+
+/**
+ * @brief Replay the events of a timestamp dataset in chronological order.
+ *
+ * The keys are merged with a min-heap of their next events, so that every
+ * event costs a logarithmic number of comparisons in the number of keys and
+ * no copy of the dataset is needed, which must outlive the replayer.
+ *
+ * The events are paced in real time, with the timestamps of the dataset,
+ * in ms, divided by a speedup factor: when the next event is in the future
+ * the replayer sleeps until just before its target time, then it spins on a
+ * high-resolution clock. When the replayer is behind the events are
+ * dispatched back-to-back and the clock is read only every few events. The
+ * lateness of every event, i.e., how much later than its target time it was
+ * dispatched, is collected in the statistics returned by run().
+ */
+class Replayer final
+{
+  NONCOPYABLE_NONMOVABLE(Replayer);
+
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  //! An event dispatched.
+  struct Event {
+    //! The index of the key, see key().
+    std::uint32_t theKey;
+    //! The timestamp in the dataset, in ms.
+    double theTimestamp;
+    //! True if the event is a write access.
+    bool theWrite;
+  };
+
+  //! Achieved vs. target timing of a replay.
+  struct Stats {
+    std::size_t theNumEvents = 0;
+    //! Number of events with lateness above the tolerance.
+    std::size_t theNumLate = 0;
+    //! Target duration of the replay, in s.
+    double theTarget = 0;
+    //! Actual duration of the replay, in s.
+    double theElapsed = 0;
+    //! Average and maximum lateness, in s.
+    double theLatenessAvg = 0;
+    double theLatenessMax = 0;
+
+    std::string                            toString() const;
+    static const std::vector<std::string>& explain();
+  };
+
+  /**
+   * @brief Create a replayer of a timestamp dataset.
+   *
+   * @param aDataset The dataset, with the events of every key sorted in
+   * chronological order.
+   * @param aSpeedup The factor by which the time is accelerated, 1 means the
+   * original timing, while 0 means that the events are dispatched as fast as
+   * possible, without pacing.
+   * @param aTolerance The lateness above which an event is counted as late,
+   * in s.
+   *
+   * @throw std::runtime_error if the speedup or the tolerance are negative,
+   * or if the dataset has too many keys.
+   */
+  explicit Replayer(const TimestampDataset& aDataset,
+                    const double            aSpeedup,
+                    const double            aTolerance = 1e-3);
+
+  //! @return the number of keys.
+  std::size_t size() const noexcept {
+    return theKeys.size();
+  }
+
+  //! @return the name of a key, which are indexed in alphabetical order.
+  const std::string& key(const std::uint32_t aKey) const noexcept {
+    return theKeys[aKey]->first;
+  }
+
+  /**
+   * @brief Replay the whole dataset.
+   *
+   * Can be called multiple times, each replay starting from the beginning.
+   * The events with the same timestamp are dispatched in the order of their
+   * keys.
+   *
+   * @param aCallback Called with every event, as const Event&.
+   * @param aIdle Called without arguments before waiting for the next event
+   * and at the end of the replay.
+   * @return the statistics of the replay.
+   */
+  template <class CALLBACK, class IDLE>
+  Stats run(CALLBACK&& aCallback, IDLE&& aIdle);
+
+  //! Same as run(CALLBACK&&, IDLE&&) without a callback when idle.
+  template <class CALLBACK>
+  Stats run(CALLBACK&& aCallback) {
+    return run(std::forward<CALLBACK>(aCallback), []() {});
+  }
+
+  /**
+   * @brief Replay the whole dataset pushing the events to a queue.
+   *
+   * The events are pushed in batches, each with at most aBatchSize events,
+   * so that a consumer thread can keep up with millions of events per
+   * second. A batch is also pushed, if not empty, whenever the replayer
+   * waits, hence no event is delayed by batching. At the end an empty batch
+   * is pushed, while the queue is not closed.
+   *
+   * @throw std::runtime_error if the batch size is zero.
+   */
+  Stats run(support::Queue<std::vector<Event>>& aQueue,
+            const std::size_t                   aBatchSize = 1024);
+
+ private:
+  //! Entry of the min-heap, with the next event of a key.
+  struct Head {
+    double        theTimestamp;
+    std::uint32_t theKey;
+
+    bool operator<(const Head& aOther) const noexcept {
+      return theTimestamp < aOther.theTimestamp or
+             (theTimestamp == aOther.theTimestamp and theKey < aOther.theKey);
+    }
+  };
+
+  using Iterator = TimestampDataset::mapped_type::const_iterator;
+
+  //! Fill the heap with the first event of every key.
+  void reset();
+
+  //! Pop the next event in chronological order, false if there are none.
+  bool next(Event& aEvent);
+
+  //! Restore the heap property moving down the entry at the given position.
+  void siftDown(std::size_t aPos) noexcept;
+
+  //! Sleep and then spin until the given time, which is returned.
+  static Clock::time_point waitUntil(const Clock::time_point& aTarget);
+
+  const double theSpeedup;
+  const double theTolerance;
+
+  // keys in alphabetical order
+  std::vector<const TimestampDataset::value_type*> theKeys;
+
+  // current and end position of the events of every key
+  std::vector<std::pair<Iterator, Iterator>> theCursors;
+
+  std::vector<Head> theHeap;
+};
+
+template <class CALLBACK, class IDLE>
+Replayer::Stats Replayer::run(CALLBACK&& aCallback, IDLE&& aIdle) {
+  // number of events dispatched back-to-back between two clock readings
+  constexpr std::size_t myClockPeriod = 64;
+
+  Stats ret;
+  reset();
+  const auto myOrigin =
+      theHeap.empty() ? 0.0 : theHeap.front().theTimestamp;
+  const auto myStart = Clock::now();
+  auto       myNow   = myStart;
+
+  Event       myEvent{0, 0, false};
+  double      myLast      = myOrigin;
+  double      myLateness  = 0;
+  std::size_t myUnchecked = 0;
+  while (next(myEvent)) {
+    myLast = myEvent.theTimestamp;
+    if (theSpeedup > 0) {
+      const auto myTarget =
+          myStart + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double, std::milli>(
+                            (myEvent.theTimestamp - myOrigin) / theSpeedup));
+      if (myTarget > myNow or ++myUnchecked == myClockPeriod) {
+        myNow       = Clock::now();
+        myUnchecked = 0;
+        if (myTarget > myNow) {
+          aIdle();
+          myNow = waitUntil(myTarget);
+        }
+      }
+      const auto myLate =
+          std::chrono::duration<double>(myNow - myTarget).count();
+      myLateness += myLate;
+      if (myLate > ret.theLatenessMax) {
+        ret.theLatenessMax = myLate;
+      }
+      if (myLate > theTolerance) {
+        ret.theNumLate++;
+      }
+    }
+    aCallback(static_cast<const Event&>(myEvent));
+    ret.theNumEvents++;
+  }
+  aIdle();
+
+  ret.theElapsed =
+      std::chrono::duration<double>(Clock::now() - myStart).count();
+  if (theSpeedup > 0) {
+    ret.theTarget = (myLast - myOrigin) / 1000.0 / theSpeedup;
+  }
+  if (ret.theNumEvents > 0) {
+    ret.theLatenessAvg = myLateness / ret.theNumEvents;
+  }
+  return ret;
+}
+
+} // namespace dataset
+} // namespace uiiit
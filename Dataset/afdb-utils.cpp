@@ -31,64 +31,563 @@ SOFTWARE.
 
 #include "Dataset/afdb-utils.h"
 
+#include "Dataset/afdb-policies.h"
+#include "Support/radixsort.h"
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
 
 namespace uiiit {
 namespace dataset {
 
-const std::size_t theTimestampDatasetVersion = 1;
-
-Row::Row(const std::string& aRow) {
-  auto myTokens = support::split<std::vector<std::string>>(aRow, ",");
-  if (myTokens.size() != 11) {
-    throw std::runtime_error("Wrong number of elements in row: " + aRow);
-  }
-  theTimestamp = std::stod(myTokens[0]);
-  theRegion.swap(myTokens[1]);
-  theUser.swap(myTokens[2]);
-  theApp.swap(myTokens[3]);
-  theFunction.swap(myTokens[4]);
-  theBlob.swap(myTokens[5]);
-  theBlobType.swap(myTokens[6]);
-  theBlobVersion.swap(myTokens[7]);
-  theBlobSize = std::stoull(myTokens[8]);
-  if (myTokens[9] == "True" and myTokens[10].size() >= 5 and
-      myTokens[10].substr(0, 5) == "False") {
+namespace {
+
+//! Number of comma-separated fields in a row of the dataset.
+constexpr std::size_t theNumFields = 11;
+
+/**
+ * @brief Split a row into its non-empty comma-separated tokens, with the same
+ * result as support::split(), possibly in multiple steps.
+ *
+ * @param aCur The position in the row where to resume, updated.
+ * @param aEnd The end of the row.
+ * @param aTokens The tokens found.
+ * @param aNumTokens The number of tokens already found.
+ * @param aLast Stop after this number of tokens.
+ *
+ * @return the number of tokens found, which may exceed aTokens.size() by one
+ * at most, in which case the row is invalid.
+ */
+std::size_t tokenize(const char*&                                aCur,
+                     const char* const                           aEnd,
+                     std::array<std::string_view, theNumFields>& aTokens,
+                     std::size_t                                 aNumTokens,
+                     const std::size_t                           aLast) {
+  assert(aLast <= aTokens.size());
+  while (aCur < aEnd and aNumTokens < aLast) {
+    // memchr() is SIMD-accelerated in all the common C libraries
+    auto myComma =
+        static_cast<const char*>(std::memchr(aCur, ',', aEnd - aCur));
+    if (myComma == nullptr) {
+      myComma = aEnd;
+    }
+    if (myComma > aCur) {
+      aTokens[aNumTokens++] = std::string_view(aCur, myComma - aCur);
+    }
+    aCur = myComma + 1;
+  }
+  // with all the tokens found, any other character means an extra token
+  if (aNumTokens == aTokens.size()) {
+    for (; aCur < aEnd; ++aCur) {
+      if (*aCur != ',') {
+        return aNumTokens + 1;
+      }
+    }
+  }
+  return aNumTokens;
+}
+
+double toDouble(const std::string_view aToken) {
+#if defined(__cpp_lib_to_chars)
+  double     ret;
+  const auto myRes =
+      std::from_chars(aToken.data(), aToken.data() + aToken.size(), ret);
+  if (myRes.ec != std::errc() or myRes.ptr == aToken.data()) {
+    throw std::runtime_error("Invalid number: " + std::string(aToken));
+  }
+  return ret;
+#else
+  // floating point from_chars() is not available in all standard libraries
+  return std::stod(std::string(aToken));
+#endif
+}
+
+std::size_t toSize(const std::string_view aToken) {
+  std::size_t ret;
+  const auto  myRes =
+      std::from_chars(aToken.data(), aToken.data() + aToken.size(), ret);
+  if (myRes.ec != std::errc() or myRes.ptr == aToken.data()) {
+    throw std::runtime_error("Invalid number: " + std::string(aToken));
+  }
+  return ret;
+}
+
+bool startsWith(const std::string_view aToken, const std::string_view aPrefix) {
+  return aToken.substr(0, aPrefix.size()) == aPrefix;
+}
+
+//! The result of parsing a chunk of the dataset made of whole lines.
+struct ParsedChunk {
+  std::vector<RowView> theRows;
+  //! The errors found, with the line number relative to the chunk.
+  std::vector<MappedDataset::Error> theErrors;
+  //! The number of lines parsed, excluding the empty line, if any.
+  std::size_t theLines = 0;
+  //! True if an empty line was found, which terminates the dataset.
+  bool theEnd = false;
+};
+
+/**
+ * @brief Parse the rows in a buffer, one per line, stopping at the first
+ * empty line. Invalid rows are skipped and their errors saved.
+ */
+ParsedChunk parseChunk(const std::string_view aData,
+                       const RowFilter&       aFilter) {
+  ParsedChunk ret;
+  const char* myCur = aData.data();
+  const char* myEnd = aData.data() + aData.size();
+  while (myCur < myEnd) {
+    auto myNewline =
+        static_cast<const char*>(std::memchr(myCur, '\n', myEnd - myCur));
+    if (myNewline == nullptr) {
+      myNewline = myEnd;
+    }
+    if (myNewline == myCur) {
+      ret.theEnd = true;
+      break;
+    }
+    try {
+      auto myRow =
+          RowView::parse(std::string_view(myCur, myNewline - myCur), aFilter);
+      if (myRow.has_value()) {
+        ret.theRows.emplace_back(*myRow);
+      }
+    } catch (const std::exception& aErr) {
+      ret.theErrors.emplace_back(ret.theLines, aErr.what());
+    }
+    ++ret.theLines;
+    myCur = myNewline + 1;
+  }
+  return ret;
+}
+
+/**
+ * @brief Split a buffer into at most aNumChunks chunks of whole lines, each
+ * at least aMinChunk bytes long except the last one.
+ *
+ * @return the chunks, in order, covering the whole buffer.
+ */
+std::vector<std::string_view> splitLines(const std::string_view aData,
+                                         const std::size_t      aNumChunks,
+                                         const std::size_t      aMinChunk) {
+  const auto myChunkSize = std::max<std::size_t>(
+      {1, aMinChunk, aData.size() / std::max<std::size_t>(1, aNumChunks)});
+  std::vector<std::string_view> ret;
+  std::size_t                   myBegin = 0;
+  while (myBegin < aData.size()) {
+    // a chunk ends after the first newline past its nominal size
+    auto myEnd = myBegin + myChunkSize;
+    if (myEnd >= aData.size()) {
+      myEnd = aData.size();
+    } else {
+      myEnd = aData.find('\n', myEnd - 1);
+      myEnd = myEnd == std::string_view::npos ? aData.size() : myEnd + 1;
+    }
+    ret.emplace_back(aData.substr(myBegin, myEnd - myBegin));
+    myBegin = myEnd;
+  }
+  return ret;
+}
+
+//! The string fields of RowView, in the order of Column.
+const std::array<std::string_view RowView::*,
+                 static_cast<unsigned int>(Column::Size)>
+    theStringFields({
+        &RowView::theRegion,
+        &RowView::theUser,
+        &RowView::theApp,
+        &RowView::theFunction,
+        &RowView::theBlob,
+        &RowView::theBlobType,
+        &RowView::theBlobVersion,
+    });
+
+Row::Codes internAll(const RowView& aRow, Dictionary& aDictionary) {
+  Row::Codes ret;
+  for (unsigned int c = 0; c < ret.size(); c++) {
+    ret[c] =
+        aDictionary[static_cast<Column>(c)].intern(aRow.*theStringFields[c]);
+  }
+  return ret;
+}
+
+} // namespace
+
+namespace detail {
+
+std::size_t numThreads(const std::size_t aNumThreads) {
+  return aNumThreads > 0 ?
+             aNumThreads :
+             std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace detail
+
+std::string Dictionary::key(const Key& aKey) const {
+  const auto& myUser = (*this)[Column::User][aKey.first];
+  const auto& myApp  = (*this)[Column::App][aKey.second];
+  std::string ret;
+  ret.reserve(myUser.size() + 1 + myApp.size());
+  ret.append(myUser).append(1, ',').append(myApp);
+  return ret;
+}
+
+Key Dictionary::internKey(const RowView& aRow) {
+  return Key((*this)[Column::User].intern(aRow.theUser),
+             (*this)[Column::App].intern(aRow.theApp));
+}
+
+Row::Row(const std::string& aRow, Dictionary& aDictionary)
+    : Row(RowView(aRow), aDictionary) {
+  // noop
+}
+
+Row::Row(const RowView& aRow, Dictionary& aDictionary)
+    : Row(aRow, internAll(aRow, aDictionary)) {
+  // noop
+}
+
+Row::Row(const RowView& aRow, const Codes& aCodes)
+    : Row(aRow.theTimestamp, aCodes, aRow.theBlobSize, aRow.theWrite) {
+  // noop
+}
+
+Row::Row(const double      aTimestamp,
+         const Codes&      aCodes,
+         const std::size_t aBlobSize,
+         const bool        aWrite)
+    : theTimestamp(aTimestamp)
+    , theRegion(aCodes[static_cast<unsigned int>(Column::Region)])
+    , theUser(aCodes[static_cast<unsigned int>(Column::User)])
+    , theApp(aCodes[static_cast<unsigned int>(Column::App)])
+    , theFunction(aCodes[static_cast<unsigned int>(Column::Function)])
+    , theBlob(aCodes[static_cast<unsigned int>(Column::Blob)])
+    , theBlobType(aCodes[static_cast<unsigned int>(Column::BlobType)])
+    , theBlobVersion(aCodes[static_cast<unsigned int>(Column::BlobVersion)])
+    , theBlobSize(aBlobSize)
+    , theWrite(aWrite) {
+  // noop
+}
+
+bool RowFilter::matchKey(const std::string_view aKey) const {
+  if (theApps.empty()) {
+    return true;
+  }
+  const auto myComma = aKey.find(',');
+  return myComma != std::string_view::npos and
+         theApps.count(aKey.substr(myComma + 1)) > 0;
+}
+
+RowView::RowView() noexcept
+    : theTimestamp(0)
+    , theRegion()
+    , theUser()
+    , theApp()
+    , theFunction()
+    , theBlob()
+    , theBlobType()
+    , theBlobVersion()
+    , theBlobSize(0)
+    , theWrite(false) {
+  // noop
+}
+
+RowView::RowView(const std::string_view aRow)
+    : RowView() {
+  [[maybe_unused]] const auto myLoaded = load(aRow, RowFilter());
+  assert(myLoaded);
+}
+
+std::optional<RowView> RowView::parse(const std::string_view aRow,
+                                      const RowFilter&       aFilter) {
+  std::optional<RowView> ret(RowView{});
+  if (not ret->load(aRow, aFilter)) {
+    ret.reset();
+  }
+  return ret;
+}
+
+bool RowView::load(const std::string_view aRow, const RowFilter& aFilter) {
+  const auto myWrongNumber = [&aRow]() {
+    return std::runtime_error("Wrong number of elements in row: " +
+                              std::string(aRow));
+  };
+  std::array<std::string_view, theNumFields> myTokens;
+  const char*                                myCur = aRow.data();
+  const char* const                          myEnd = aRow.data() + aRow.size();
+
+  // the fields of the filter come first: timestamp, region, user, and app
+  if (tokenize(myCur, myEnd, myTokens, 0, 4) != 4) {
+    throw myWrongNumber();
+  }
+  theTimestamp       = toDouble(myTokens[0]);
+  const auto myMatch = aFilter.matchTimestamp(theTimestamp) and
+                       aFilter.matchRegion(myTokens[1]) and
+                       aFilter.matchApp(myTokens[3]);
+
+  // the rows not matching are only split, which is much cheaper than parsing
+  if (tokenize(myCur, myEnd, myTokens, 4, theNumFields) != theNumFields) {
+    throw myWrongNumber();
+  }
+  if (not myMatch) {
+    return false;
+  }
+  theRegion      = myTokens[1];
+  theUser        = myTokens[2];
+  theApp         = myTokens[3];
+  theFunction    = myTokens[4];
+  theBlob        = myTokens[5];
+  theBlobType    = myTokens[6];
+  theBlobVersion = myTokens[7];
+  theBlobSize    = toSize(myTokens[8]);
+  if (myTokens[9] == "True" and startsWith(myTokens[10], "False")) {
     theWrite = false;
-  } else if (myTokens[9] == "False" and myTokens[10].size() >= 4 and
-             myTokens[10].substr(0, 4) == "True") {
+  } else if (myTokens[9] == "False" and startsWith(myTokens[10], "True")) {
     theWrite = true;
   } else {
-    throw std::runtime_error("Invalid read/write flags in row: " + aRow);
+    throw std::runtime_error("Invalid read/write flags in row: " +
+                             std::string(aRow));
   }
+  return true;
 }
 
-std::deque<Row> loadDataset(std::istream& aStream, const bool aWithHeader) {
-  std::size_t myRowId = 0;
-  std::string myLine;
+MappedDataset::MappedDataset(const std::string& aFilename,
+                             const bool         aWithHeader,
+                             const std::size_t  aNumThreads,
+                             const RowFilter&   aFilter,
+                             const std::size_t  aMinChunkSize)
+    : theFile(aFilename)
+    , theRows()
+    , theErrors() {
+  auto myData = theFile.view();
   if (aWithHeader) {
-    std::getline(aStream, myLine);
-    if (myLine.empty()) {
+    const auto myNewline = myData.find('\n');
+    if (myNewline == 0 or myData.empty()) {
       throw std::runtime_error("Invalid empty header");
     }
+    myData.remove_prefix(myNewline == std::string_view::npos ? myData.size()
+                                                              : myNewline + 1);
   }
+
+  const auto myChunks =
+      splitLines(myData, detail::numThreads(aNumThreads), aMinChunkSize);
+  std::vector<ParsedChunk> myParsed(myChunks.size());
+  detail::parallelFor(myChunks.size(), [&](const std::size_t i) {
+    myParsed[i] = parseChunk(myChunks[i], aFilter);
+  });
+
+  // merge the chunks in order, up to the first one with an empty line
+  std::size_t myNumRows = 0;
+  for (const auto& myChunk : myParsed) {
+    myNumRows += myChunk.theRows.size();
+    if (myChunk.theEnd) {
+      break;
+    }
+  }
+  theRows.reserve(myNumRows);
+  std::size_t myRowId = 1;
+  for (const auto& myChunk : myParsed) {
+    for (const auto& myError : myChunk.theErrors) {
+      theErrors.emplace_back(myRowId + myError.first, myError.second);
+      LOG(ERROR) << "error reading line " << theErrors.back().first << ": "
+                 << myError.second;
+    }
+    theRows.insert(
+        theRows.end(), myChunk.theRows.begin(), myChunk.theRows.end());
+    myRowId += myChunk.theLines;
+    if (myChunk.theEnd) {
+      break;
+    }
+  }
+}
+
+std::deque<Row> loadDataset(const std::string& aFilename,
+                            const bool         aWithHeader,
+                            Dictionary&        aDictionary,
+                            const std::size_t  aNumThreads,
+                            const RowFilter&   aFilter) {
+  const auto myColumns =
+      loadColumns(aFilename, aWithHeader, aDictionary, aNumThreads, aFilter);
   std::deque<Row> ret;
-  while (aStream) {
-    ++myRowId;
+  for (std::size_t i = 0; i < myColumns.size(); i++) {
+    ret.emplace_back(myColumns.row(i));
+  }
+  return ret;
+}
+
+DatasetColumns::DatasetColumns()
+    : theTimestamps()
+    , theCodes()
+    , theSizes()
+    , theWrites() {
+  // noop
+}
+
+DatasetColumns::DatasetColumns(const std::deque<Row>& aDataset)
+    : DatasetColumns() {
+  for (const auto& myRow : aDataset) {
+    add(myRow);
+  }
+}
+
+DatasetColumns::DatasetColumns(const MappedDataset& aDataset,
+                               Dictionary&          aDictionary,
+                               const std::size_t    aNumThreads)
+    : DatasetColumns() {
+  const auto& myRows = aDataset.rows();
+
+  // one task per string column, since they have separate tables and can be
+  // interned without locking, plus one task for all the numeric columns
+  const auto myNumTasks   = theCodes.size() + 1;
+  const auto myNumThreads =
+      std::min(detail::numThreads(aNumThreads), myNumTasks);
+  detail::parallelFor(myNumThreads, [&](const std::size_t t) {
+    for (auto c = t; c < myNumTasks; c += myNumThreads) {
+      if (c < theCodes.size()) {
+        auto& myTable = aDictionary[static_cast<Column>(c)];
+        theCodes[c].reserve(myRows.size());
+        for (const auto& myRow : myRows) {
+          theCodes[c].emplace_back(myTable.intern(myRow.*theStringFields[c]));
+        }
+        continue;
+      }
+      theTimestamps.reserve(myRows.size());
+      theSizes.reserve(myRows.size());
+      theWrites.resize((myRows.size() + 63) / 64);
+      for (std::size_t i = 0; i < myRows.size(); i++) {
+        theTimestamps.emplace_back(myRows[i].theTimestamp);
+        theSizes.emplace_back(myRows[i].theBlobSize);
+        theWrites[i / 64] |= static_cast<std::uint64_t>(myRows[i].theWrite)
+                             << (i % 64);
+      }
+    }
+  });
+}
+
+void DatasetColumns::add(const Row& aRow) {
+  const auto myIndex = theTimestamps.size();
+  theTimestamps.emplace_back(aRow.theTimestamp);
+  const auto myCodes = aRow.codes();
+  for (std::size_t c = 0; c < theCodes.size(); c++) {
+    theCodes[c].emplace_back(myCodes[c]);
+  }
+  theSizes.emplace_back(aRow.theBlobSize);
+  if (myIndex % 64 == 0) {
+    theWrites.emplace_back(0);
+  }
+  theWrites.back() |= static_cast<std::uint64_t>(aRow.theWrite)
+                      << (myIndex % 64);
+}
+
+Row DatasetColumns::row(const std::size_t aIndex) const {
+  Row::Codes myCodes;
+  for (std::size_t c = 0; c < theCodes.size(); c++) {
+    myCodes[c] = theCodes[c][aIndex];
+  }
+  return Row(theTimestamps[aIndex], myCodes, theSizes[aIndex], write(aIndex));
+}
+
+DatasetColumns loadColumns(const std::string& aFilename,
+                           const bool         aWithHeader,
+                           Dictionary&        aDictionary,
+                           const std::size_t  aNumThreads,
+                           const RowFilter&   aFilter) {
+  return DatasetColumns(
+      MappedDataset(aFilename, aWithHeader, aNumThreads, aFilter),
+      aDictionary,
+      aNumThreads);
+}
+
+std::vector<std::uint32_t> keyIds(const DatasetColumns& aDataset,
+                                  KeyIndex&             aIndex) {
+  const auto&                myUsers = aDataset.codes(Column::User);
+  const auto&                myApps  = aDataset.codes(Column::App);
+  std::vector<std::uint32_t> ret(aDataset.size());
+  for (std::size_t i = 0; i < ret.size(); i++) {
+    ret[i] = aIndex.intern(Key(myUsers[i], myApps[i]));
+  }
+  return ret;
+}
+
+RowReader::RowReader(std::istream&    aStream,
+                     const bool       aWithHeader,
+                     const RowFilter& aFilter)
+    : theFile()
+    , theStream(aStream)
+    , theFilter(aFilter)
+    , theLine()
+    , theLineId(0)
+    , theRow() {
+  skipHeader(aWithHeader);
+}
+
+RowReader::RowReader(const std::string& aFilename,
+                     const bool         aWithHeader,
+                     const RowFilter&   aFilter)
+    : theFile(std::make_unique<std::ifstream>(aFilename))
+    , theStream(*theFile)
+    , theFilter(aFilter)
+    , theLine()
+    , theLineId(0)
+    , theRow() {
+  if (not *theFile) {
+    throw std::runtime_error("Could not open file for reading: " + aFilename);
+  }
+  skipHeader(aWithHeader);
+}
+
+void RowReader::skipHeader(const bool aWithHeader) {
+  if (aWithHeader) {
+    std::getline(theStream, theLine);
+    if (theLine.empty()) {
+      throw std::runtime_error("Invalid empty header");
+    }
+  }
+}
+
+bool RowReader::next() {
+  theRow.reset();
+  while (theStream) {
+    ++theLineId;
+    std::getline(theStream, theLine);
+    if (theLine.empty()) {
+      break;
+    }
     try {
-      std::getline(aStream, myLine);
-      if (myLine.empty()) {
-        break;
+      theRow = RowView::parse(theLine, theFilter);
+      if (theRow.has_value()) {
+        return true;
       }
-      ret.emplace_back(Row(myLine));
     } catch (const std::exception& aErr) {
-      LOG(ERROR) << "error reading line " << myRowId << ": " << aErr.what();
+      LOG(ERROR) << "error reading line " << theLineId << ": " << aErr.what();
     }
   }
+  return false;
+}
+
+std::deque<Row> loadDataset(std::istream&    aStream,
+                            const bool       aWithHeader,
+                            Dictionary&      aDictionary,
+                            const RowFilter& aFilter) {
+  RowReader       myReader(aStream, aWithHeader, aFilter);
+  std::deque<Row> ret;
+  while (myReader.next()) {
+    ret.emplace_back(myReader.row(), aDictionary);
+  }
   return ret;
 }
 
@@ -98,6 +597,7 @@ std::string toString(const ExecMode aExecMode) {
     case ExecMode::AlwaysMu:     return "always-mu";
     case ExecMode::AlwaysLambda: return "always-lambda";
     case ExecMode::BestNext:     return "best-next";
+    case ExecMode::Optimal:      return "optimal";
     default: throw std::runtime_error("unknown");
   }
   // clang-format on
@@ -110,6 +610,7 @@ allExecModes() {
           ExecMode::AlwaysMu,
           ExecMode::AlwaysLambda,
           ExecMode::BestNext,
+          ExecMode::Optimal,
       });
   return myExecModes;
 }
@@ -138,14 +639,80 @@ const std::vector<std::string>& CostModel::explain() {
   return myExplain;
 }
 
+std::vector<CostModel> loadCostModels(const std::string& aFilename) {
+  std::ifstream myFile(aFilename);
+  if (not myFile) {
+    throw std::runtime_error("Could not open file for reading: " + aFilename);
+  }
+
+  static const std::array<double CostModel::*, 8> myFields({
+      &CostModel::theCostExecMu,
+      &CostModel::theCostExecLambda,
+      &CostModel::theCostReadLambda,
+      &CostModel::theCostWriteLambda,
+      &CostModel::theCostWarmMu,
+      &CostModel::theCostWarmLambda,
+      &CostModel::theCostMigrateMu,
+      &CostModel::theCostMigrateLambda,
+  });
+
+  std::vector<CostModel> ret;
+  std::string            myLine;
+  while (std::getline(myFile, myLine)) {
+    if (myLine.empty() or myLine[0] == '#') {
+      continue;
+    }
+    const auto myTokens =
+        support::split<std::vector<std::string>>(myLine, ",");
+    if (myTokens.size() != myFields.size()) {
+      throw std::runtime_error("Invalid cost model in " + aFilename + ": " +
+                               myLine);
+    }
+
+    // expand the Cartesian product of the values, one field at a time
+    std::vector<CostModel> myModels(1);
+    for (std::size_t i = 0; i < myFields.size(); ++i) {
+      std::vector<CostModel> myExpanded;
+      for (const auto& myValue :
+           support::split<std::vector<std::string>>(myTokens[i], ":")) {
+        for (auto myModel : myModels) {
+          myModel.*myFields[i] = toDouble(myValue);
+          myExpanded.emplace_back(myModel);
+        }
+      }
+      myModels.swap(myExpanded);
+    }
+    if (myModels.empty()) {
+      throw std::runtime_error("Invalid cost model in " + aFilename + ": " +
+                               myLine);
+    }
+    ret.insert(ret.end(), myModels.begin(), myModels.end());
+  }
+
+  return ret;
+}
+
+double CostOutput::bestNextGap() const {
+  return theCosts[static_cast<unsigned int>(ExecMode::BestNext)] -
+         theCosts[static_cast<unsigned int>(ExecMode::Optimal)];
+}
+
 std::string CostOutput::toString() const {
+  // the optimal cost comes last so that the other columns do not move
   std::stringstream ret;
   ret << theDuration << ',' << theNumInvocations;
-  for (const auto& myCost : theCosts) {
-    ret << ',' << myCost;
+  for (const auto& myExecMode : allExecModes()) {
+    if (myExecMode != ExecMode::Optimal) {
+      ret << ',' << theCosts[static_cast<unsigned int>(myExecMode)];
+    }
   }
   ret << ',' << theBestNextNumMu << ',' << theBestNextNumLambda << ','
-      << theBestNextDurMu << ',' << theBestNextDurLambda;
+      << theBestNextDurMu << ',' << theBestNextDurLambda << ','
+      << theCosts[static_cast<unsigned int>(ExecMode::Optimal)] << ','
+      << bestNextGap();
+  for (const auto& myCost : thePolicyCosts) {
+    ret << ',' << myCost;
+  }
   return ret.str();
 }
 
@@ -156,25 +723,71 @@ const std::vector<std::string>& CostOutput::explain() {
   });
   if (myExplain.size() == 2) {
     for (const auto& myExecMode : allExecModes()) {
-      myExplain.emplace_back(uiiit::dataset::toString(myExecMode));
+      if (myExecMode != ExecMode::Optimal) {
+        myExplain.emplace_back(uiiit::dataset::toString(myExecMode));
+      }
     }
     myExplain.emplace_back("best-next-num-mu");
     myExplain.emplace_back("best-next-num-lambda");
     myExplain.emplace_back("best-next-dur-mu");
     myExplain.emplace_back("best-next-dur-lambda");
+    myExplain.emplace_back(uiiit::dataset::toString(ExecMode::Optimal));
+    myExplain.emplace_back("best-next-gap");
   }
 
   return myExplain;
 }
 
-TimestampDataset toTimestampDataset(const std::deque<Row>& aDataset) {
+TimestampDatasetBuilder::TimestampDatasetBuilder()
+    : theGroups() {
+  // noop
+}
+
+TimestampDataset TimestampDatasetBuilder::build(const Dictionary& aDictionary) {
+  // the keys are converted to strings only once
   TimestampDataset ret;
-  for (const auto& myRow : aDataset) {
-    ret[myRow.key()].emplace_back(myRow.theTimestamp, myRow.theWrite);
+  for (auto& myGroup : theGroups) {
+    ret.emplace(aDictionary.key(myGroup.first), std::move(myGroup.second));
   }
+  theGroups.clear();
   return ret;
 }
 
+TimestampDataset toTimestampDataset(const std::deque<Row>& aDataset,
+                                    const Dictionary&      aDictionary) {
+  TimestampDatasetBuilder myBuilder;
+  for (const auto& myRow : aDataset) {
+    myBuilder.add(myRow.key(), myRow.theTimestamp, myRow.theWrite);
+  }
+  return myBuilder.build(aDictionary);
+}
+
+TimestampDataset toTimestampDataset(const DatasetColumns& aDataset,
+                                    const Dictionary&     aDictionary) {
+  const auto&             myTimestamps = aDataset.timestamps();
+  const auto&             myUsers      = aDataset.codes(Column::User);
+  const auto&             myApps       = aDataset.codes(Column::App);
+  TimestampDatasetBuilder myBuilder;
+  for (std::size_t i = 0; i < aDataset.size(); i++) {
+    myBuilder.add(
+        Key(myUsers[i], myApps[i]), myTimestamps[i], aDataset.write(i));
+  }
+  return myBuilder.build(aDictionary);
+}
+
+TimestampDataset toTimestampDataset(RowReader&  aReader,
+                                    Dictionary& aDictionary) {
+  TimestampDatasetBuilder myBuilder;
+  while (aReader.next()) {
+    const auto& myRow = aReader.row();
+    myBuilder.add(
+        aDictionary.internKey(myRow), myRow.theTimestamp, myRow.theWrite);
+  }
+  return myBuilder.build(aDictionary);
+}
+
+namespace {
+
 struct EndOfStream final : public std::runtime_error {
   explicit EndOfStream()
       : std::runtime_error("EOF") {
@@ -190,205 +803,1240 @@ void readFromFile(std::istream& aStream, T& aValue) {
   }
 }
 
-TimestampDataset loadTimestampDataset(const std::string& aFilename) {
-  std::ifstream myInfile(aFilename);
-  if (not myInfile) {
-    throw std::runtime_error("Could not open file for reading: " + aFilename);
-  }
-  TimestampDataset ret;
+//! Store a 64-bit integer in little-endian order at aData.
+void storeLittleEndian(std::uint64_t aValue, char* aData) noexcept {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  aValue = __builtin_bswap64(aValue);
+#endif
+  std::memcpy(aData, &aValue, sizeof(aValue));
+}
 
-  // load version number
-  std::size_t myVersion;
-  readFromFile(myInfile, myVersion);
-  if (myVersion != theTimestampDatasetVersion) {
-    throw std::runtime_error("Invalid file version: expecting " +
-                             std::to_string(theTimestampDatasetVersion) +
-                             ", found " + std::to_string(myVersion));
-  }
+//! @return aSize rounded up to a multiple of 64 bits.
+std::uint64_t padded(const std::uint64_t aSize) noexcept {
+  return (aSize + 7) / 8 * 8;
+}
 
+//! @return the size of a block of events in version 2 of the format.
+std::uint64_t blockSize(const std::uint64_t aNumEvents) noexcept {
+  return aNumEvents * 8 + (aNumEvents + 63) / 64 * 8;
+}
+
+/**
+ * @brief Load the keys after the version number in version 1 of the format.
+ *
+ * @throw std::runtime_error if the file ends in the middle of a key or its
+ * events, or a key is duplicate.
+ */
+void loadTimestampDatasetV1(std::istream&      aStream,
+                            const std::string& aFilename,
+                            const RowFilter&   aFilter,
+                            TimestampDataset&  aDataset) {
+  const auto myInvalid = [&aFilename](const std::string& aWhat) {
+    return std::runtime_error("Invalid timestamp dataset in " + aFilename +
+                              ": " + aWhat);
+  };
+  const auto myBegin = aStream.tellg();
+  aStream.seekg(0, std::ios::end);
+  const auto myEnd = aStream.tellg();
+  aStream.seekg(myBegin);
+  const auto myRemaining = [&aStream, myEnd]() {
+    return static_cast<std::size_t>(myEnd - aStream.tellg());
+  };
+
+  // each event is stored as a timestamp followed by the write flag
+  constexpr std::size_t myEventSize = sizeof(double) + sizeof(bool);
   try {
     std::size_t myLength;
     double      myTimestamp;
     bool        myWriteFlag;
-    while (true) {
+    while (myRemaining() > 0) {
       // read length, then the key
-      readFromFile(myInfile, myLength);
+      readFromFile(aStream, myLength);
+      if (myLength > myRemaining()) {
+        throw EndOfStream();
+      }
       std::string myKey(myLength, 0);
-      myInfile.read(myKey.data(), myLength);
+      aStream.read(myKey.data(), myLength);
 
       // read the number of elements, then all the elements
-      readFromFile(myInfile, myLength);
+      readFromFile(aStream, myLength);
+      if (myLength > myRemaining() / myEventSize) {
+        throw EndOfStream();
+      }
+      if (not aFilter.matchKey(myKey)) {
+        aStream.seekg(myLength * myEventSize, std::ios::cur);
+        continue;
+      }
       auto myNewElem =
-          ret.emplace(myKey, std::deque<std::tuple<double, bool>>());
-      assert(myNewElem.second == true);
+          aDataset.emplace(myKey, std::deque<std::tuple<double, bool>>());
+      if (not myNewElem.second) {
+        throw myInvalid("duplicate key " + myKey);
+      }
       for (std::size_t i = 0; i < myLength; i++) {
-        readFromFile(myInfile, myTimestamp);
-        readFromFile(myInfile, myWriteFlag);
+        readFromFile(aStream, myTimestamp);
+        readFromFile(aStream, myWriteFlag);
         myNewElem.first->second.emplace_back(myTimestamp, myWriteFlag);
       }
     }
   } catch (const EndOfStream&) {
-    // ignore
+    throw myInvalid("truncated file");
   }
-
-  return ret;
 }
 
-void saveTimestampDataset(const TimestampDataset& aDataset,
-                          const std::string&      aFilename) {
-  std::ofstream myOutfile(aFilename);
-  if (not myOutfile) {
-    throw std::runtime_error("Could not open file for writing: " + aFilename);
-  }
-
-  // write version number
-  myOutfile.write(reinterpret_cast<const char*>(&theTimestampDatasetVersion),
-                  sizeof(std::size_t));
-
+//! Save the keys after the version number in version 1 of the format.
+void saveTimestampDatasetV1(const TimestampDataset& aDataset,
+                            std::ostream&           aStream) {
   std::size_t myLength;
   for (const auto& myApp : aDataset) {
     // write size of the key, then the key
     myLength = myApp.first.size();
-    myOutfile.write(reinterpret_cast<const char*>(&myLength), sizeof(myLength));
-    myOutfile.write(myApp.first.data(), myLength);
+    aStream.write(reinterpret_cast<const char*>(&myLength), sizeof(myLength));
+    aStream.write(myApp.first.data(), myLength);
 
     // write then number of elements, then all the elements
     myLength = myApp.second.size();
-    myOutfile.write(reinterpret_cast<const char*>(&myLength), sizeof(myLength));
+    aStream.write(reinterpret_cast<const char*>(&myLength), sizeof(myLength));
     for (const auto& elem : myApp.second) {
-      myOutfile.write(reinterpret_cast<const char*>(&std::get<0>(elem)),
-                      sizeof(std::get<0>(elem)));
-      myOutfile.write(reinterpret_cast<const char*>(&std::get<1>(elem)),
-                      sizeof(std::get<1>(elem)));
+      aStream.write(reinterpret_cast<const char*>(&std::get<0>(elem)),
+                    sizeof(std::get<0>(elem)));
+      aStream.write(reinterpret_cast<const char*>(&std::get<1>(elem)),
+                    sizeof(std::get<1>(elem)));
     }
   }
 }
 
-std::unordered_map<std::string, CostOutput>
-cost(const TimestampDataset& aDataset,
-     const CostModel&        aCostModel,
-     const bool              aSaveBnPeriods) {
-  const std::size_t myBestNextLookAhead = 500;
-
-  struct PeriodSaver {
-    PeriodSaver(CostOutput& aCost, const bool aSave)
-        : theCost(aCost)
-        , theSave(aSave)
-        , theAcc(0) {
-      // noop
-    }
-    void remain(const double aPeriod) {
-      theAcc += aPeriod;
-    }
-    void migrate(const double aPeriod) {
-      if (theSave) {
-        theCost.theBestNextPeriods.emplace_back(theAcc);
-      }
-      theAcc = aPeriod;
+//! Encode the events of a key in a block of version 2 of the format.
+void encodeV2(const TimestampDataset::mapped_type& aEvents,
+              std::vector<char>&                   aBlock) {
+  aBlock.assign(blockSize(aEvents.size()), 0);
+  auto          myTimestamp = aBlock.data();
+  auto          myWrites    = aBlock.data() + aEvents.size() * 8;
+  std::uint64_t myWord      = 0;
+  std::size_t   i           = 0;
+  for (const auto& elem : aEvents) {
+    std::uint64_t myValue;
+    std::memcpy(&myValue, &std::get<0>(elem), sizeof(myValue));
+    storeLittleEndian(myValue, myTimestamp);
+    myTimestamp += 8;
+    myWord |= static_cast<std::uint64_t>(std::get<1>(elem)) << (i % 64);
+    if (++i % 64 == 0) {
+      storeLittleEndian(myWord, myWrites);
+      myWrites += 8;
+      myWord = 0;
     }
+  }
+  if (i % 64 != 0) {
+    storeLittleEndian(myWord, myWrites);
+  }
+}
 
-    CostOutput& theCost;
-    const bool  theSave;
-    double      theAcc;
-  };
+//! Largest number of decimal digits of the timestamps in version 3.
+constexpr std::size_t theMaxDecimals = 6;
 
-  // compute the costs
-  std::unordered_map<std::string, CostOutput> ret;
-  for (const auto& elem : aDataset) {
-    auto&       myOut = ret.emplace(elem.first, CostOutput()).first->second;
-    PeriodSaver myPeriodSaver(myOut, aSaveBnPeriods);
-    for (auto cur = elem.second.begin(); cur != elem.second.end(); ++cur) {
-      auto next = std::next(cur);
-      if (next == elem.second.end()) {
+//! Number of decimal digits meaning that the bits of the timestamps are stored.
+constexpr std::uint8_t theRawBits = 0xff;
+
+//! Powers of ten up to theMaxDecimals.
+constexpr std::array<double, theMaxDecimals + 1> thePowersOfTen{
+    1, 10, 100, 1000, 10000, 100000, 1000000};
+
+/**
+ * @brief Find the resolution with which timestamps can be stored as integers.
+ *
+ * @return the smallest number of decimal digits such that every timestamp,
+ * multiplied by the corresponding power of ten, is an integer from which the
+ * timestamp is obtained back exactly, or an empty optional if none.
+ */
+std::optional<std::size_t>
+numDecimals(const TimestampDataset::mapped_type& aEvents) {
+  for (std::size_t d = 0; d <= theMaxDecimals; d++) {
+    const auto myScale = thePowersOfTen[d];
+    auto       myExact = true;
+    for (const auto& elem : aEvents) {
+      const auto myTicks = std::nearbyint(std::get<0>(elem) * myScale);
+      if (not(std::abs(myTicks) < 0x1p53) or
+          myTicks / myScale != std::get<0>(elem)) {
+        myExact = false;
         break;
       }
+    }
+    if (myExact) {
+      return d;
+    }
+  }
+  return std::nullopt;
+}
+
+//! @return a signed integer mapped to an unsigned one, close to 0 if small.
+std::uint64_t zigzag(const std::int64_t aValue) noexcept {
+  return (static_cast<std::uint64_t>(aValue) << 1) ^
+         static_cast<std::uint64_t>(aValue >> 63);
+}
+
+//! @return the inverse of zigzag().
+std::int64_t unzigzag(const std::uint64_t aValue) noexcept {
+  return static_cast<std::int64_t>(aValue >> 1) ^
+         -static_cast<std::int64_t>(aValue & 1u);
+}
+
+/**
+ * @brief Append a value and a flag as the LEB128 varint of the 65-bit integer
+ * with the value shifted left by one bit and the flag in the least
+ * significant bit.
+ */
+void appendVarint(std::uint64_t      aValue,
+                  const bool         aFlag,
+                  std::vector<char>& aBlock) {
+  auto myByte = ((aValue & 0x3fu) << 1) | static_cast<std::uint64_t>(aFlag);
+  aValue >>= 6;
+  while (aValue != 0) {
+    aBlock.emplace_back(static_cast<char>(myByte | 0x80));
+    myByte = aValue & 0x7fu;
+    aValue >>= 7;
+  }
+  aBlock.emplace_back(static_cast<char>(myByte));
+}
+
+/**
+ * @brief Encode the events of a key in a block of version 3 of the format.
+ *
+ * The block begins with the number of decimal digits d of the timestamps,
+ * in one byte. Then every event is a LEB128 varint with the difference
+ * between its timestamp and the previous one, in units of 10^-d ms, in
+ * zigzag encoding, and the write flag, see appendVarint(). The first
+ * timestamp is relative to 0.
+ *
+ * If the timestamps cannot be represented exactly with at most
+ * theMaxDecimals digits, then d is theRawBits and the differences are
+ * between the bits of the timestamps, which are close for close positive
+ * values.
+ */
+void encodeV3(const TimestampDataset::mapped_type& aEvents,
+              std::vector<char>&                   aBlock) {
+  const auto myDecimals = numDecimals(aEvents);
+  const auto myScale    = thePowersOfTen[myDecimals.value_or(0)];
+  aBlock.clear();
+  aBlock.reserve(1 + aEvents.size() * 3);
+  aBlock.emplace_back(static_cast<char>(myDecimals.value_or(theRawBits)));
+  std::int64_t myLast = 0;
+  for (const auto& elem : aEvents) {
+    std::int64_t myTicks;
+    if (myDecimals.has_value()) {
+      myTicks = static_cast<std::int64_t>(
+          std::nearbyint(std::get<0>(elem) * myScale));
+    } else {
+      std::memcpy(&myTicks, &std::get<0>(elem), sizeof(myTicks));
+    }
+    appendVarint(zigzag(static_cast<std::int64_t>(
+                     static_cast<std::uint64_t>(myTicks) -
+                     static_cast<std::uint64_t>(myLast))),
+                 std::get<1>(elem),
+                 aBlock);
+    myLast = myTicks;
+  }
+}
 
-      const auto myTimeToNext = std::get<0>(*next) - std::get<0>(*cur);
-      myOut.theDuration += myTimeToNext;
-      myOut.theNumInvocations++;
-
-      // AlwaysMu
-      myOut.theCosts[static_cast<unsigned int>(ExecMode::AlwaysMu)] +=
-          aCostModel.theCostExecMu + aCostModel.theCostWarmMu * myTimeToNext;
-
-      // AlwaysLambda
-      myOut.theCosts[static_cast<unsigned int>(ExecMode::AlwaysLambda)] +=
-          aCostModel.theCostExecLambda +
-          aCostModel.theCostWarmLambda * myTimeToNext +
-          (std::get<1>(*cur) ? aCostModel.theCostWriteLambda :
-                               aCostModel.theCostReadLambda);
-
-      // BestNext
-      auto& myBnCost =
-          myOut.theCosts[static_cast<unsigned int>(ExecMode::BestNext)];
-      if (myOut.theBestNextLastType == CostOutput::Type::Microservice) {
-        myBnCost += aCostModel.theCostExecMu;
-        myOut.theBestNextNumMu++;
-
-        if ((aCostModel.theCostWarmMu * myTimeToNext) >
-            (aCostModel.theCostMigrateLambda +
-             aCostModel.theCostWarmLambda * myTimeToNext)) {
-          // migrate from microservice to stateless
-          myPeriodSaver.migrate(myTimeToNext);
-          myOut.theBestNextLastType = CostOutput::Type::Stateless;
-          myOut.theBestNextDurLambda += myTimeToNext;
-          myBnCost += aCostModel.theCostMigrateLambda +
-                      aCostModel.theCostWarmLambda * myTimeToNext;
-
-        } else {
-          myPeriodSaver.remain(myTimeToNext);
-          myOut.theBestNextDurMu += myTimeToNext;
-          myBnCost += aCostModel.theCostWarmMu * myTimeToNext;
+/**
+ * @brief Decode the events of a key from a block of version 3 of the format.
+ *
+ * @param aBlock The data from the start of the block, which may continue with
+ * other blocks.
+ * @param aNumEvents The number of events in the block.
+ * @param aEvents Where to save the events decoded.
+ *
+ * @throw std::runtime_error if the block is invalid.
+ */
+void decodeV3(const std::string_view         aBlock,
+              const std::uint64_t            aNumEvents,
+              TimestampDataset::mapped_type& aEvents) {
+  auto       myCur = reinterpret_cast<const std::uint8_t*>(aBlock.data());
+  const auto myEnd = myCur + aBlock.size();
+  if (myCur == myEnd or (*myCur > theMaxDecimals and *myCur != theRawBits)) {
+    throw std::runtime_error("Invalid number of decimal digits");
+  }
+  const auto myRawBits = *myCur == theRawBits;
+  const auto myScale   = myRawBits ? 1.0 : thePowersOfTen[*myCur];
+  ++myCur;
+  aEvents.resize(aNumEvents);
+  std::uint64_t myTicks = 0;
+  for (auto& myEvent : aEvents) {
+    // fast paths for values that fit in one or two bytes, the most common
+    std::uint64_t myValue;
+    bool          myFlag;
+    if (myCur != myEnd and (myCur[0] & 0x80) == 0) {
+      myFlag  = myCur[0] & 1u;
+      myValue = myCur[0] >> 1;
+      myCur += 1;
+    } else if (myEnd - myCur >= 2 and (myCur[1] & 0x80) == 0) {
+      myFlag  = myCur[0] & 1u;
+      myValue = ((myCur[0] & 0x7fu) >> 1) |
+                (static_cast<std::uint64_t>(myCur[1]) << 6);
+      myCur += 2;
+    } else {
+      if (myCur == myEnd) {
+        throw std::runtime_error("Invalid varint");
+      }
+      myFlag  = myCur[0] & 1u;
+      myValue = (myCur[0] & 0x7fu) >> 1;
+      for (unsigned myShift = 6; (*myCur++ & 0x80) != 0; myShift += 7) {
+        if (myCur == myEnd or myShift > 62) {
+          throw std::runtime_error("Invalid varint");
         }
+        myValue |= static_cast<std::uint64_t>(*myCur & 0x7fu) << myShift;
+      }
+    }
+    myTicks += static_cast<std::uint64_t>(unzigzag(myValue));
+    double myTimestamp;
+    if (myRawBits) {
+      std::memcpy(&myTimestamp, &myTicks, sizeof(myTimestamp));
+    } else {
+      myTimestamp = static_cast<std::int64_t>(myTicks) / myScale;
+    }
+    myEvent = std::make_tuple(myTimestamp, myFlag);
+  }
+}
+
+//! An entry of the directory in version 2 or 3 of the format.
+struct DirectoryEntry {
+  std::string_view theKey;
+  //! From the start of the block of events to the start of the directory.
+  std::string_view theBlock;
+  std::uint64_t    theNumEvents;
+};
+
+/**
+ * @brief Read the directory of a timestamp dataset in version 2 or 3 of the
+ * format, checking that everything is within the file and that the directory
+ * ends at the trailer.
+ *
+ * @param aData The content of the file.
+ * @param aVersion The version expected.
+ * @param aFilename The name of the file, for error messages.
+ *
+ * @throw std::runtime_error if the file is not in the version expected or it
+ * is invalid.
+ */
+std::vector<DirectoryEntry> readDirectory(const std::string_view aData,
+                                          const std::uint64_t    aVersion,
+                                          const std::string&     aFilename) {
+  const auto myInvalid = [&aFilename](const std::string& aWhat) {
+    return std::runtime_error("Invalid timestamp dataset in " + aFilename +
+                              ": " + aWhat);
+  };
+  const auto myData = aData.data();
+  if (aData.size() < 24) {
+    throw myInvalid("file too short");
+  }
+  if (detail::loadLittleEndian(myData) != aVersion) {
+    throw myInvalid("not in version " + std::to_string(aVersion) +
+                    " of the format");
+  }
+
+  const auto myEnd       = aData.size() - 16;
+  const auto myDirectory = detail::loadLittleEndian(myData + myEnd);
+  const auto myNumKeys   = detail::loadLittleEndian(myData + myEnd + 8);
+  if (myDirectory < 8 or myDirectory > myEnd or
+      myNumKeys > (myEnd - myDirectory) / 24) {
+    throw myInvalid("invalid directory");
+  }
+  std::vector<DirectoryEntry> ret;
+  ret.reserve(myNumKeys);
+  auto myCur = myDirectory;
+  for (std::uint64_t k = 0; k < myNumKeys; k++) {
+    if (myEnd - myCur < 24) {
+      throw myInvalid("truncated directory");
+    }
+    const auto myOffset    = detail::loadLittleEndian(myData + myCur);
+    const auto myNumEvents = detail::loadLittleEndian(myData + myCur + 8);
+    const auto myKeySize   = detail::loadLittleEndian(myData + myCur + 16);
+    myCur += 24;
+    // the first check prevents overflows when padding
+    if (myKeySize > myEnd - myCur or padded(myKeySize) > myEnd - myCur) {
+      throw myInvalid("truncated directory");
+    }
+    const std::string_view myKey(myData + myCur, myKeySize);
+    myCur += padded(myKeySize);
+    // every event takes at least one byte in all versions
+    if (myOffset < 8 or myOffset > myDirectory or
+        myNumEvents > myDirectory - myOffset) {
+      throw myInvalid("events of key " + std::string(myKey) +
+                      " out of bounds");
+    }
+    ret.emplace_back(DirectoryEntry{
+        myKey,
+        std::string_view(myData + myOffset, myDirectory - myOffset),
+        myNumEvents});
+  }
+  if (myCur != myEnd) {
+    throw myInvalid("directory does not end at the trailer");
+  }
+  return ret;
+}
+
+} // namespace
+
+TimestampDatasetWriter::TimestampDatasetWriter(const std::string& aFilename,
+                                               const std::size_t  aVersion)
+    : theFilename(aFilename)
+    , theVersion(aVersion)
+    , theStream()
+    , theBuffer()
+    , theDirectory()
+    , theOffset(8)
+    , theClosed(false) {
+  if (aVersion != 2 and aVersion != 3) {
+    throw std::runtime_error("Invalid file version for writing by key: " +
+                             std::to_string(aVersion));
+  }
+  theStream.open(aFilename, std::ios::binary);
+  if (not theStream) {
+    throw std::runtime_error("Could not open file for writing: " + aFilename);
+  }
+  // the version number is written by close(), until then it is invalid
+  const char myData[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  write(myData, sizeof(myData));
+}
+
+TimestampDatasetWriter::~TimestampDatasetWriter() {
+  // noop: the file is closed without writing the directory
+}
+
+void TimestampDatasetWriter::add(
+    const std::string& aKey, const TimestampDataset::mapped_type& aEvents) {
+  if (theClosed) {
+    throw std::runtime_error("Cannot add to a closed timestamp dataset: " +
+                             theFilename);
+  }
+  if (theVersion == 2) {
+    encodeV2(aEvents, theBuffer);
+  } else {
+    encodeV3(aEvents, theBuffer);
+  }
+  write(theBuffer.data(), theBuffer.size());
+  theDirectory.emplace_back(Entry{aKey, theOffset, aEvents.size()});
+  theOffset += theBuffer.size();
+}
+
+void TimestampDatasetWriter::close() {
+  if (theClosed) {
+    return;
+  }
+  theClosed = true;
+
+  // the directory and the trailer are written with a single call
+  theBuffer.clear();
+  for (const auto& myEntry : theDirectory) {
+    const auto& myKey = myEntry.theKey;
+    const auto  myPos = theBuffer.size();
+    theBuffer.resize(myPos + 24 + padded(myKey.size()), 0);
+    storeLittleEndian(myEntry.theOffset, theBuffer.data() + myPos);
+    storeLittleEndian(myEntry.theNumEvents, theBuffer.data() + myPos + 8);
+    storeLittleEndian(myKey.size(), theBuffer.data() + myPos + 16);
+    std::memcpy(theBuffer.data() + myPos + 24, myKey.data(), myKey.size());
+  }
+  const auto myPos = theBuffer.size();
+  theBuffer.resize(myPos + 16);
+  storeLittleEndian(theOffset, theBuffer.data() + myPos);
+  storeLittleEndian(theDirectory.size(), theBuffer.data() + myPos + 8);
+  write(theBuffer.data(), theBuffer.size());
+  theDirectory.clear();
+
+  // the file becomes valid only after everything else has been written
+  char myVersion[8];
+  storeLittleEndian(theVersion, myVersion);
+  if (not theStream.seekp(0)) {
+    throw std::runtime_error("Could not write to file: " + theFilename);
+  }
+  write(myVersion, sizeof(myVersion));
+  theStream.close();
+  if (not theStream) {
+    throw std::runtime_error("Could not write to file: " + theFilename);
+  }
+}
+
+void TimestampDatasetWriter::write(const char*       aData,
+                                   const std::size_t aSize) {
+  if (not theStream.write(aData, aSize)) {
+    throw std::runtime_error("Could not write to file: " + theFilename);
+  }
+}
+
+std::size_t timestampDatasetVersion(const std::string& aFilename) {
+  std::ifstream myInfile(aFilename, std::ios::binary);
+  char          myData[8];
+  if (not myInfile or not myInfile.read(myData, sizeof(myData))) {
+    throw std::runtime_error("Could not read from file: " + aFilename);
+  }
+  // version 1 is stored with the endianness of the host
+  const auto myVersion = detail::loadLittleEndian(myData);
+  if (myVersion == 2 or myVersion == 3) {
+    return myVersion;
+  }
+  std::size_t ret;
+  std::memcpy(&ret, myData, sizeof(ret));
+  return ret;
+}
+
+void countIntervals(
+    std::vector<std::uint64_t>                          aBegins,
+    std::vector<std::uint64_t>                          aEnds,
+    const std::uint64_t                                 aResolution,
+    std::vector<std::pair<std::uint64_t, std::size_t>>& aSeries) {
+  if (aBegins.size() != aEnds.size()) {
+    throw std::runtime_error("Mismatching number of begins and ends: " +
+                             std::to_string(aBegins.size()) + " vs. " +
+                             std::to_string(aEnds.size()));
+  }
+
+  // sweep the begins and ends, each sorted separately
+  support::radixSort(aBegins);
+  support::radixSort(aEnds);
+  for (std::size_t i = 0; i < aBegins.size(); i++) {
+    if (aEnds[i] < aBegins[i]) {
+      throw std::runtime_error("Invalid interval ending at " +
+                               std::to_string(aEnds[i]));
+    }
+  }
+
+  // with a resolution, only save the values at its multiples
+  std::uint64_t myNextSample = 0;
+  if (aResolution > 0 and not aBegins.empty()) {
+    myNextSample = aBegins.front() / aResolution * aResolution;
+  }
+
+  std::size_t b = 0;
+  std::size_t e = 0;
+  while (e < aEnds.size()) {
+    // the i-th end never comes before the i-th begin
+    const auto myTimestamp =
+        b < aBegins.size() ? std::min(aBegins[b], aEnds[e]) : aEnds[e];
+    if (aResolution > 0) {
+      for (; myNextSample < myTimestamp; myNextSample += aResolution) {
+        aSeries.emplace_back(myNextSample, b - e);
+      }
+    }
+
+    // all the events with the same timestamp are coalesced
+    while (b < aBegins.size() and aBegins[b] == myTimestamp) {
+      b++;
+    }
+    while (e < aEnds.size() and aEnds[e] == myTimestamp) {
+      e++;
+    }
+    if (aResolution == 0) {
+      aSeries.emplace_back(myTimestamp, b - e);
+    }
+  }
+  if (aResolution > 0 and not aEnds.empty()) {
+    aSeries.emplace_back(myNextSample, 0);
+  }
+}
+
+MappedTimestampDataset::Events::Events(const char*       aTimestamps,
+                                       const char*       aWrites,
+                                       const std::size_t aSize)
+    : theTimestamps(aTimestamps)
+    , theWrites(aWrites)
+    , theSize(aSize) {
+  // noop
+}
+
+MappedTimestampDataset::MappedTimestampDataset(const std::string& aFilename)
+    : theFile(aFilename)
+    , theEntries()
+    , theIndex() {
+  const auto myDirectory = readDirectory(theFile.view(), 2, aFilename);
+  theEntries.reserve(myDirectory.size());
+  theIndex.reserve(myDirectory.size());
+  for (const auto& myEntry : myDirectory) {
+    const auto myNumEvents = myEntry.theNumEvents;
+    if (blockSize(myNumEvents) > myEntry.theBlock.size()) {
+      throw std::runtime_error("Invalid timestamp dataset in " + aFilename +
+                               ": events of key " +
+                               std::string(myEntry.theKey) + " out of bounds");
+    }
+    if (not theIndex.emplace(myEntry.theKey, theEntries.size()).second) {
+      throw std::runtime_error("Invalid timestamp dataset in " + aFilename +
+                               ": duplicate key " +
+                               std::string(myEntry.theKey));
+    }
+    const auto myBlock = myEntry.theBlock.data();
+    theEntries.emplace_back(
+        myEntry.theKey,
+        Events(myBlock, myBlock + myNumEvents * 8, myNumEvents));
+  }
+}
+
+const MappedTimestampDataset::Events*
+MappedTimestampDataset::find(const std::string_view aKey) const {
+  const auto it = theIndex.find(aKey);
+  return it == theIndex.end() ? nullptr : &theEntries[it->second].second;
+}
+
+TimestampDataset loadTimestampDataset(const std::string& aFilename,
+                                      const RowFilter&   aFilter) {
+  if (not aFilter.theRegions.empty()) {
+    throw std::runtime_error(
+        "Cannot filter by region a timestamp dataset, found in " + aFilename);
+  }
+  const auto myTimeRange =
+      aFilter.theBegin != -std::numeric_limits<double>::infinity() or
+      aFilter.theEnd != std::numeric_limits<double>::infinity();
+
+  TimestampDataset ret;
+  const auto       myVersion = timestampDatasetVersion(aFilename);
+  if (myVersion == 1) {
+    std::ifstream myInfile(aFilename, std::ios::binary);
+    myInfile.seekg(sizeof(std::size_t));
+    loadTimestampDatasetV1(myInfile, aFilename, aFilter, ret);
+
+  } else if (myVersion == 2) {
+    const MappedTimestampDataset myDataset(aFilename);
+    ret.reserve(myDataset.size());
+    for (std::size_t k = 0; k < myDataset.size(); k++) {
+      // the events of the keys skipped are never accessed
+      if (not aFilter.matchKey(myDataset.key(k))) {
+        continue;
+      }
+
+      // the events are sorted, hence the time range is found by bisection
+      const auto& myEvents = myDataset.events(k);
+      const auto  myLowerBound =
+          [&myEvents](const double aTimestamp) {
+            std::size_t myLow  = 0;
+            std::size_t myHigh = myEvents.size();
+            while (myLow < myHigh) {
+              const auto myMid = myLow + (myHigh - myLow) / 2;
+              if (myEvents.timestamp(myMid) < aTimestamp) {
+                myLow = myMid + 1;
+              } else {
+                myHigh = myMid;
+              }
+            }
+            return myLow;
+          };
+      const auto myFirst = myLowerBound(aFilter.theBegin);
+      const auto myLast  = std::max(myFirst, myLowerBound(aFilter.theEnd));
+      if (myTimeRange and myFirst == myLast) {
+        continue;
+      }
+
+      auto& myOut =
+          ret.emplace(std::string(myDataset.key(k)),
+                      TimestampDataset::mapped_type(myLast - myFirst))
+              .first->second;
+      for (std::size_t i = myFirst; i < myLast; i++) {
+        myOut[i - myFirst] =
+            std::make_tuple(myEvents.timestamp(i), myEvents.write(i));
+      }
+    }
+
+  } else if (myVersion == 3) {
+    const support::MappedFile myFile(aFilename);
+    const auto myDirectory = readDirectory(myFile.view(), 3, aFilename);
+    ret.reserve(myDirectory.size());
+    for (const auto& myEntry : myDirectory) {
+      // the events of the keys skipped are not decoded
+      if (not aFilter.matchKey(myEntry.theKey)) {
+        continue;
+      }
+      auto myNewElem = ret.emplace(std::string(myEntry.theKey),
+                                   TimestampDataset::mapped_type());
+      if (not myNewElem.second) {
+        throw std::runtime_error("Invalid timestamp dataset in " + aFilename +
+                                 ": duplicate key " + myNewElem.first->first);
+      }
+      try {
+        decodeV3(
+            myEntry.theBlock, myEntry.theNumEvents, myNewElem.first->second);
+      } catch (const std::exception& aErr) {
+        throw std::runtime_error("Invalid timestamp dataset in " + aFilename +
+                                 ": events of key " + myNewElem.first->first +
+                                 ": " + aErr.what());
+      }
+    }
+
+  } else {
+    throw std::runtime_error(
+        "Invalid file version: expecting 1, 2, or 3, found " +
+        std::to_string(myVersion));
+  }
+
+  // versions 1 and 3 are filtered by time only after reading the events
+  if (myTimeRange and myVersion != 2) {
+    for (auto it = ret.begin(); it != ret.end();) {
+      auto& myEvents = it->second;
+      myEvents.erase(std::remove_if(myEvents.begin(),
+                                    myEvents.end(),
+                                    [&aFilter](const auto& aEvent) {
+                                      return not aFilter.matchTimestamp(
+                                          std::get<0>(aEvent));
+                                    }),
+                     myEvents.end());
+      it = myEvents.empty() ? ret.erase(it) : std::next(it);
+    }
+  }
+  return ret;
+}
+
+void saveTimestampDataset(const TimestampDataset& aDataset,
+                          const std::string&      aFilename,
+                          const std::size_t       aVersion) {
+  if (aVersion < 1 or aVersion > 3) {
+    throw std::runtime_error("Invalid file version: " +
+                             std::to_string(aVersion));
+  }
+
+  if (aVersion != 1) {
+    TimestampDatasetWriter myWriter(aFilename, aVersion);
+    for (const auto& myApp : aDataset) {
+      myWriter.add(myApp.first, myApp.second);
+    }
+    myWriter.close();
+    return;
+  }
+
+  std::ofstream myOutfile(aFilename, std::ios::binary);
+  if (not myOutfile) {
+    throw std::runtime_error("Could not open file for writing: " + aFilename);
+  }
+  // write version number
+  myOutfile.write(reinterpret_cast<const char*>(&aVersion),
+                  sizeof(std::size_t));
+  saveTimestampDatasetV1(aDataset, myOutfile);
+  if (not myOutfile) {
+    throw std::runtime_error("Could not write to file: " + aFilename);
+  }
+}
+
+namespace {
+
+//! Accumulates the durations of the alternating best-next periods.
+struct PeriodSaver {
+  PeriodSaver(CostOutput& aCost, const bool aSave)
+      : theCost(aCost)
+      , theSave(aSave)
+      , theAcc(0) {
+    // noop
+  }
+  void remain(const double aPeriod) {
+    theAcc += aPeriod;
+  }
+  void migrate(const double aPeriod) {
+    if (theSave) {
+      theCost.theBestNextPeriods.emplace_back(theAcc);
+    }
+    theAcc = aPeriod;
+  }
+
+  CostOutput& theCost;
+  const bool  theSave;
+  double      theAcc;
+};
+
+//! The events of an app, with the prefix sums needed by best-next.
+struct AppTrace {
+  explicit AppTrace(const TimestampDataset::mapped_type& aEvents)
+      : theTimes()
+      , theWrites()
+      , theNumWrites() {
+    theTimes.reserve(aEvents.size());
+    theWrites.reserve(aEvents.size());
+    theNumWrites.reserve(aEvents.size());
+    for (const auto& myEvent : aEvents) {
+      theTimes.emplace_back(std::get<0>(myEvent));
+      theWrites.emplace_back(std::get<1>(myEvent));
+      theNumWrites.emplace_back(
+          theNumWrites.empty() ? 0 :
+                                 theNumWrites.back() + std::get<1>(myEvent));
+    }
+  }
+
+  //! @return the time between the invocations i and i + 1.
+  double gap(const std::size_t i) const {
+    return theTimes[i + 1] - theTimes[i];
+  }
+
+  std::vector<double>      theTimes;     //!< the timestamps
+  std::vector<char>        theWrites;    //!< the write flags
+  std::vector<std::size_t> theNumWrites; //!< writes in the events 1..i
+};
+
+/**
+ * @brief Tell whether best-next should migrate from stateless function to
+ * microservice, i.e., whether the latter becomes cheaper within the
+ * look-ahead window of the next invocations.
+ *
+ * After k invocations the stateless cost minus the microservice cost is
+ * C + F(i + k) - F(i), where F only depends on the timestamps and on the
+ * prefix sums of the writes, so the answer only depends on the maximum of
+ * F in the window, which is kept in a monotonic deque in amortized
+ * constant time per invocation. If the maximum is so close to the
+ * threshold that rounding errors might matter, then the costs are summed
+ * one invocation at a time, as before, so the decisions do not change.
+ */
+class BestNextLookAhead final
+{
+ public:
+  /**
+   * @brief Create an object for a given app and cost model.
+   *
+   * @param aTrace The events of the app.
+   * @param aCostModel The cost model.
+   * @param aLookAhead The maximum number of future invocations considered,
+   * 0 means all of them.
+   */
+  BestNextLookAhead(const AppTrace&   aTrace,
+                    const CostModel&  aCostModel,
+                    const std::size_t aLookAhead)
+      : theTrace(aTrace)
+      , theCostModel(aCostModel)
+      , theLookAhead(aLookAhead)
+      , theStep(aCostModel.theCostExecLambda - aCostModel.theCostExecMu +
+                aCostModel.theCostReadLambda)
+      , theWriteStep(aCostModel.theCostWriteLambda -
+                     aCostModel.theCostReadLambda)
+      , theWarm(aCostModel.theCostWarmLambda - aCostModel.theCostWarmMu)
+      , theMaxAbsF(0)
+      , theWindow()
+      , theNext(1) {
+    if (not aTrace.theTimes.empty()) {
+      // the timestamps are sorted, hence the largest is at either end
+      const auto myMaxAbsTime = std::max(std::abs(aTrace.theTimes.front()),
+                                         std::abs(aTrace.theTimes.back()));
+      theMaxAbsF = std::abs(theStep) * aTrace.theTimes.size() +
+                   std::abs(theWriteStep) * aTrace.theNumWrites.back() +
+                   std::abs(theWarm) * myMaxAbsTime;
+    }
+  }
+
+  //! @return true if it is better to migrate at the invocation aIndex.
+  bool operator()(const std::size_t aIndex) {
+    assert((aIndex + 1) < theTrace.theTimes.size());
+    const auto myLast =
+        theLookAhead == 0 ?
+            theTrace.theTimes.size() - 1 :
+            std::min(theTrace.theTimes.size() - 1, aIndex + theLookAhead);
+
+    // slide the window to aIndex + 1..myLast
+    for (; theNext <= myLast; ++theNext) {
+      const auto myValue = f(theNext);
+      while (not theWindow.empty() and theWindow.back().second <= myValue) {
+        theWindow.pop_back();
+      }
+      theWindow.emplace_back(theNext, myValue);
+    }
+    while (theWindow.front().first <= aIndex) {
+      theWindow.pop_front();
+    }
+    assert(not theWindow.empty());
+
+    const auto myConst =
+        theCostModel.theCostExecLambda +
+        (theTrace.theWrites[aIndex] ? theCostModel.theCostWriteLambda :
+                                      theCostModel.theCostReadLambda) -
+        theCostModel.theCostMigrateMu - theCostModel.theCostExecMu;
+    const auto myMaxDiff = myConst + (theWindow.front().second - f(aIndex));
+
+    // bound the rounding errors of both the invocation-by-invocation sums
+    // and the prefix sums, with some slack
+    const double myNumSteps = myLast - aIndex;
+    const auto   myMaxCost =
+        std::max(std::abs(theCostModel.theCostReadLambda),
+                 std::abs(theCostModel.theCostWriteLambda)) +
+        std::abs(theCostModel.theCostExecLambda) +
+        std::abs(theCostModel.theCostExecMu);
+    const auto mySumAbs =
+        std::abs(theCostModel.theCostMigrateMu) + (myNumSteps + 1) * myMaxCost +
+        (std::abs(theCostModel.theCostWarmMu) +
+         std::abs(theCostModel.theCostWarmLambda)) *
+            (theTrace.theTimes[myLast] - theTrace.theTimes[aIndex]);
+    const auto myTolerance =
+        2 * std::numeric_limits<double>::epsilon() *
+        ((myNumSteps + 2) * mySumAbs + 8 * (theMaxAbsF + std::abs(myConst)));
+
+    if (myMaxDiff > myTolerance) {
+      return true;
+    } else if (myMaxDiff < -myTolerance) {
+      return false;
+    }
+    return exact(aIndex, myLast);
+  }
+
+ private:
+  //! @return the stateless minus microservice cost up to invocation i.
+  double f(const std::size_t i) const {
+    return theStep * i + theWriteStep * theTrace.theNumWrites[i] +
+           theWarm * theTrace.theTimes[i];
+  }
+
+  //! Sum the costs one invocation at a time until aLast.
+  bool exact(const std::size_t aIndex, const std::size_t aLast) const {
+    auto myCostMu = theCostModel.theCostMigrateMu + theCostModel.theCostExecMu;
+    auto myCostLambda =
+        theCostModel.theCostExecLambda +
+        (theTrace.theWrites[aIndex] ? theCostModel.theCostWriteLambda :
+                                      theCostModel.theCostReadLambda);
+    for (auto j = aIndex; j < aLast; ++j) {
+      const auto myDuration = theTrace.gap(j);
+      myCostMu +=
+          theCostModel.theCostExecMu + theCostModel.theCostWarmMu * myDuration;
+      myCostLambda += theCostModel.theCostExecLambda +
+                      (theTrace.theWrites[j + 1] ?
+                           theCostModel.theCostWriteLambda :
+                           theCostModel.theCostReadLambda) +
+                      theCostModel.theCostWarmLambda * myDuration;
+
+      if (myCostMu < myCostLambda) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  const AppTrace&   theTrace;
+  const CostModel&  theCostModel;
+  const std::size_t theLookAhead;
+  const double      theStep;
+  const double      theWriteStep;
+  const double      theWarm;
+  double            theMaxAbsF;
+
+  // (index, F(index)) with decreasing values of F
+  std::deque<std::pair<std::size_t, double>> theWindow;
+  std::size_t                                theNext;
+};
+
+/**
+ * @brief Minimum cost of an app with full knowledge of its invocations.
+ *
+ * Two-state dynamic program: after every invocation we keep the cheapest
+ * schedule that leaves the app as microservice and the cheapest one that
+ * leaves it as stateless function. The app starts as stateless function and
+ * it can migrate right before or right after every invocation: since the
+ * cost of migrating while waiting is linear in the time of the migration,
+ * one of the two is always the cheapest, hence the result is a lower bound
+ * of best-next, always-lambda and the online policies, whose timeouts can
+ * migrate at any time.
+ */
+class OptimalSchedule final
+{
+ public:
+  OptimalSchedule()
+      : theMu(std::numeric_limits<double>::infinity())
+      , theLambda(0) {
+    // noop
+  }
+
+  //! Extend the schedules with the invocation aIndex.
+  void step(const AppTrace&   aTrace,
+            const std::size_t aIndex,
+            const CostModel&  aCostModel) {
+    const auto myTimeToNext = aTrace.gap(aIndex);
+    const auto myWarmMu     = aCostModel.theCostWarmMu * myTimeToNext;
+    const auto myWarmLambda = aCostModel.theCostWarmLambda * myTimeToNext;
+
+    const auto myExecMu =
+        std::min(theMu, theLambda + aCostModel.theCostMigrateMu) +
+        aCostModel.theCostExecMu;
+    const auto myExecLambda =
+        std::min(theLambda, theMu + aCostModel.theCostMigrateLambda) +
+        aCostModel.theCostExecLambda +
+        (aTrace.theWrites[aIndex] ? aCostModel.theCostWriteLambda :
+                                    aCostModel.theCostReadLambda);
+
+    theMu = std::min(myExecMu, myExecLambda + aCostModel.theCostMigrateMu) +
+            myWarmMu;
+    theLambda =
+        std::min(myExecLambda, myExecMu + aCostModel.theCostMigrateLambda) +
+        myWarmLambda;
+  }
+
+  //! @return the minimum cost of the invocations so far.
+  double cost() const {
+    return std::min(theMu, theLambda);
+  }
 
+ private:
+  double theMu;
+  double theLambda;
+};
+
+//! Run an online policy on an app.
+class PolicySimulation final
+{
+ public:
+  PolicySimulation(std::unique_ptr<Policy>&& aPolicy, double& aCost)
+      : thePolicy(std::move(aPolicy))
+      , theCost(aCost)
+      , theMicroservice(false) {
+    // noop
+  }
+
+  //! Serve the invocation aIndex as decided by the policy.
+  void step(const AppTrace&   aTrace,
+            const std::size_t aIndex,
+            const CostModel&  aCostModel) {
+    const auto myTimeToNext = aTrace.gap(aIndex);
+    const auto myDecision =
+        thePolicy->decide(theMicroservice, aTrace.theWrites[aIndex]);
+
+    if (not theMicroservice and not myDecision.theMicroservice) {
+      theCost += aCostModel.theCostExecLambda +
+                 (aTrace.theWrites[aIndex] ? aCostModel.theCostWriteLambda :
+                                             aCostModel.theCostReadLambda) +
+                 aCostModel.theCostWarmLambda * myTimeToNext;
+
+    } else {
+      if (not theMicroservice) {
+        theCost += aCostModel.theCostMigrateMu;
+      }
+      theCost += aCostModel.theCostExecMu;
+      theMicroservice = myTimeToNext <= myDecision.theTimeout;
+      if (theMicroservice) {
+        theCost += aCostModel.theCostWarmMu * myTimeToNext;
       } else {
-        assert(myOut.theBestNextLastType == CostOutput::Type::Stateless);
-
-        auto myCostMu = aCostModel.theCostMigrateMu + aCostModel.theCostExecMu;
-        auto myCostLambda = aCostModel.theCostExecLambda +
-                            (std::get<1>(*cur) ? aCostModel.theCostWriteLambda :
-                                                 aCostModel.theCostReadLambda);
-        auto        myLast = std::get<0>(*cur);
-        std::size_t i      = 0;
-        for (auto it = next;
-             it != elem.second.end() and i < myBestNextLookAhead;
-             ++it, ++i) {
-          const auto myDuration = std::get<0>(*it) - myLast;
-          myCostMu +=
-              aCostModel.theCostExecMu + aCostModel.theCostWarmMu * myDuration;
-          myCostLambda += aCostModel.theCostExecLambda +
-                          (std::get<1>(*it) ? aCostModel.theCostWriteLambda :
-                                              aCostModel.theCostReadLambda) +
-                          aCostModel.theCostWarmLambda * myDuration;
-          myLast = std::get<0>(*it);
-
-          if (myCostMu < myCostLambda) {
-            break;
-          }
-        }
+        theCost += aCostModel.theCostWarmMu * myDecision.theTimeout +
+                   aCostModel.theCostMigrateLambda +
+                   aCostModel.theCostWarmLambda *
+                       (myTimeToNext - myDecision.theTimeout);
+      }
+    }
 
-        if (myCostMu < myCostLambda) {
-          // migrate from stateless to microservice
-          myPeriodSaver.migrate(myTimeToNext);
-          myOut.theBestNextLastType = CostOutput::Type::Microservice;
-          myOut.theBestNextNumMu++;
-          myOut.theBestNextDurMu += myTimeToNext;
-          myBnCost += aCostModel.theCostMigrateMu + aCostModel.theCostExecMu +
-                      aCostModel.theCostWarmMu * myTimeToNext;
-
-        } else {
-          myPeriodSaver.remain(myTimeToNext);
-          myOut.theBestNextNumLambda++;
-          myOut.theBestNextDurLambda += myTimeToNext;
-          myBnCost += aCostModel.theCostExecLambda +
-                      (std::get<1>(*cur) ? aCostModel.theCostWriteLambda :
-                                           aCostModel.theCostReadLambda) +
-                      aCostModel.theCostWarmLambda * myTimeToNext;
-        }
+    thePolicy->observe(myTimeToNext);
+  }
+
+ private:
+  std::unique_ptr<Policy> thePolicy;
+  double&                 theCost;
+  bool                    theMicroservice;
+};
+
+/**
+ * @brief Advance the execution cost of a single app by one invocation.
+ *
+ * @param aTrace The events of the app.
+ * @param aIndex The index of the current invocation.
+ * @param aCostModel The cost model.
+ * @param aLookAhead The best-next look-ahead of the cost model.
+ * @param aOut Where to save the performance metrics.
+ * @param aPeriodSaver Where to save the alternating best-next periods.
+ */
+void costStep(const AppTrace&    aTrace,
+              const std::size_t  aIndex,
+              const CostModel&   aCostModel,
+              BestNextLookAhead& aLookAhead,
+              CostOutput&        aOut,
+              PeriodSaver&       aPeriodSaver) {
+  const auto myTimeToNext = aTrace.gap(aIndex);
+  const auto myWrite      = aTrace.theWrites[aIndex];
+  aOut.theDuration += myTimeToNext;
+  aOut.theNumInvocations++;
+
+  // AlwaysMu
+  aOut.theCosts[static_cast<unsigned int>(ExecMode::AlwaysMu)] +=
+      aCostModel.theCostExecMu + aCostModel.theCostWarmMu * myTimeToNext;
+
+  // AlwaysLambda
+  aOut.theCosts[static_cast<unsigned int>(ExecMode::AlwaysLambda)] +=
+      aCostModel.theCostExecLambda +
+      aCostModel.theCostWarmLambda * myTimeToNext +
+      (myWrite ? aCostModel.theCostWriteLambda : aCostModel.theCostReadLambda);
+
+  // BestNext
+  auto& myBnCost = aOut.theCosts[static_cast<unsigned int>(ExecMode::BestNext)];
+  if (aOut.theBestNextLastType == CostOutput::Type::Microservice) {
+    myBnCost += aCostModel.theCostExecMu;
+    aOut.theBestNextNumMu++;
+
+    if ((aCostModel.theCostWarmMu * myTimeToNext) >
+        (aCostModel.theCostMigrateLambda +
+         aCostModel.theCostWarmLambda * myTimeToNext)) {
+      // migrate from microservice to stateless
+      aPeriodSaver.migrate(myTimeToNext);
+      aOut.theBestNextLastType = CostOutput::Type::Stateless;
+      aOut.theBestNextDurLambda += myTimeToNext;
+      myBnCost += aCostModel.theCostMigrateLambda +
+                  aCostModel.theCostWarmLambda * myTimeToNext;
+
+    } else {
+      aPeriodSaver.remain(myTimeToNext);
+      aOut.theBestNextDurMu += myTimeToNext;
+      myBnCost += aCostModel.theCostWarmMu * myTimeToNext;
+    }
+
+  } else {
+    assert(aOut.theBestNextLastType == CostOutput::Type::Stateless);
+
+    if (aLookAhead(aIndex)) {
+      // migrate from stateless to microservice
+      aPeriodSaver.migrate(myTimeToNext);
+      aOut.theBestNextLastType = CostOutput::Type::Microservice;
+      aOut.theBestNextNumMu++;
+      aOut.theBestNextDurMu += myTimeToNext;
+      myBnCost += aCostModel.theCostMigrateMu + aCostModel.theCostExecMu +
+                  aCostModel.theCostWarmMu * myTimeToNext;
+
+    } else {
+      aPeriodSaver.remain(myTimeToNext);
+      aOut.theBestNextNumLambda++;
+      aOut.theBestNextDurLambda += myTimeToNext;
+      myBnCost += aCostModel.theCostExecLambda +
+                  (myWrite ? aCostModel.theCostWriteLambda :
+                             aCostModel.theCostReadLambda) +
+                  aCostModel.theCostWarmLambda * myTimeToNext;
+    }
+  }
+}
+
+/**
+ * @brief Compute the execution cost of the invocations of a single app with
+ * all the cost models.
+ *
+ * @param aEvents The events of the app, in chronological order.
+ * @param aCostModels The cost models.
+ * @param aSaveBnPeriods If true also save the alternating best-next periods.
+ * @param aBestNextLookAhead The best-next look-ahead, 0 means unlimited.
+ * @param aPolicies The factories of the online policies.
+ * @param aApp The identifier of the app passed to the policies.
+ * @param aOuts Where to save the performance metrics, one per cost model.
+ */
+void costOne(const TimestampDataset::mapped_type& aEvents,
+             const std::vector<CostModel>&        aCostModels,
+             const bool                           aSaveBnPeriods,
+             const std::size_t                    aBestNextLookAhead,
+             const std::vector<Policy::Factory>&  aPolicies,
+             const std::size_t                    aApp,
+             std::vector<CostOutput>&             aOuts) {
+  assert(aOuts.size() == aCostModels.size());
+
+  // the timestamps and their prefix sums are shared by all the models
+  const AppTrace myTrace(aEvents);
+
+  std::vector<PeriodSaver>       myPeriodSavers;
+  std::vector<BestNextLookAhead> myLookAheads;
+  std::vector<OptimalSchedule>   mySchedules(aOuts.size());
+  // the policies of the model m are in m * aPolicies.size() onwards
+  std::vector<PolicySimulation> mySimulations;
+  myPeriodSavers.reserve(aOuts.size());
+  myLookAheads.reserve(aOuts.size());
+  mySimulations.reserve(aOuts.size() * aPolicies.size());
+  for (std::size_t m = 0; m < aCostModels.size(); ++m) {
+    myPeriodSavers.emplace_back(aOuts[m], aSaveBnPeriods);
+    myLookAheads.emplace_back(myTrace, aCostModels[m], aBestNextLookAhead);
+    aOuts[m].thePolicyCosts.resize(aPolicies.size(), 0);
+    for (std::size_t p = 0; p < aPolicies.size(); ++p) {
+      mySimulations.emplace_back(
+          aPolicies[p](aCostModels[m], aApp),
+          aOuts[m].thePolicyCosts[p]);
+    }
+  }
+
+  for (std::size_t i = 0; (i + 1) < myTrace.theTimes.size(); ++i) {
+    for (std::size_t m = 0; m < aCostModels.size(); ++m) {
+      costStep(myTrace,
+               i,
+               aCostModels[m],
+               myLookAheads[m],
+               aOuts[m],
+               myPeriodSavers[m]);
+      mySchedules[m].step(myTrace, i, aCostModels[m]);
+      for (std::size_t p = 0; p < aPolicies.size(); ++p) {
+        mySimulations[m * aPolicies.size() + p].step(
+            myTrace, i, aCostModels[m]);
       }
     }
   }
 
+  for (std::size_t m = 0; m < aCostModels.size(); ++m) {
+    aOuts[m].theCosts[static_cast<unsigned int>(ExecMode::Optimal)] =
+        mySchedules[m].cost();
+  }
+}
+
+} // namespace
+
+std::unordered_map<std::string, CostOutput>
+cost(const TimestampDataset&         aDataset,
+     const CostModel&                aCostModel,
+     const bool                      aSaveBnPeriods,
+     const std::size_t               aNumThreads,
+     const std::size_t               aBestNextLookAhead,
+     const std::vector<std::string>& aPolicies) {
+  auto myCosts = cost(aDataset,
+                      std::vector<CostModel>({aCostModel}),
+                      aSaveBnPeriods,
+                      aNumThreads,
+                      aBestNextLookAhead,
+                      aPolicies);
+
+  std::unordered_map<std::string, CostOutput> ret;
+  ret.reserve(myCosts.size());
+  for (auto& elem : myCosts) {
+    assert(elem.second.size() == 1);
+    ret.emplace(elem.first, std::move(elem.second.front()));
+  }
+  return ret;
+}
+
+std::unordered_map<std::string, std::vector<CostOutput>>
+cost(const TimestampDataset&         aDataset,
+     const std::vector<CostModel>&   aCostModels,
+     const bool                      aSaveBnPeriods,
+     const std::size_t               aNumThreads,
+     const std::size_t               aBestNextLookAhead,
+     const std::vector<std::string>& aPolicies) {
+  // the descriptions are parsed once, which also fails early if a policy is
+  // not valid, rather than in the worker threads
+  std::vector<Policy::Factory> myPolicies;
+  myPolicies.reserve(aPolicies.size());
+  for (const auto& myPolicy : aPolicies) {
+    myPolicies.emplace_back(Policy::factory(myPolicy));
+  }
+
+  // all the outputs are created in advance, then each thread only writes into
+  // the outputs of the apps that it picks, hence without locking
+  std::unordered_map<std::string, std::vector<CostOutput>> ret;
+  std::vector<std::tuple<const std::string*,
+                         const TimestampDataset::mapped_type*,
+                         std::vector<CostOutput>*>>
+      myTasks;
+  ret.reserve(aDataset.size());
+  myTasks.reserve(aDataset.size());
+  for (const auto& elem : aDataset) {
+    myTasks.emplace_back(
+        &elem.first,
+        &elem.second,
+        &ret.emplace(elem.first,
+                     std::vector<CostOutput>(aCostModels.size()))
+             .first->second);
+  }
+
+  // the largest apps are evaluated first, otherwise one of them picked last
+  // would keep its thread busy long after the others are done
+  std::sort(myTasks.begin(),
+            myTasks.end(),
+            [](const auto& aLhs, const auto& aRhs) {
+              return std::get<1>(aLhs)->size() > std::get<1>(aRhs)->size();
+            });
+
+  std::atomic<std::size_t> myNext(0);
+  detail::parallelFor(
+      std::min(detail::numThreads(aNumThreads), myTasks.size()),
+      [&](const std::size_t) {
+        for (auto i = myNext++; i < myTasks.size(); i = myNext++) {
+          // the app identifier does not depend on the scheduling
+          costOne(*std::get<1>(myTasks[i]),
+                  aCostModels,
+                  aSaveBnPeriods,
+                  aBestNextLookAhead,
+                  myPolicies,
+                  std::hash<std::string>()(*std::get<0>(myTasks[i])),
+                  *std::get<2>(myTasks[i]));
+        }
+      });
+
   return ret;
 }
 
@@ -32,44 +32,270 @@ SOFTWARE.
 #pragma once
 
 #include "Support/glograii.h"
+#include "Support/mappedfile.h"
 #include "Support/split.h"
+#include "Support/stringtable.h"
 
 #include <glog/logging.h>
 
 #include <array>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <deque>
 #include <exception>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <list>
+#include <memory>
+#include <optional>
+#include <set>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace uiiit {
 namespace dataset {
 
+struct RowView;
+
+/**
+ * @brief Predicates on the rows of a dataset, checked by the loaders right
+ * after parsing the fields involved, so that the rows not matching are
+ * skipped before parsing the others.
+ *
+ * A row matches if all the predicates are true. An empty set matches any
+ * value.
+ *
+ * The rows not matching are still split into their fields, and they are
+ * invalid if the number of fields is wrong, as are those matching, but the
+ * values of their other fields are not checked, e.g., the size or the
+ * read/write flags.
+ */
+struct RowFilter {
+  //! The regions accepted.
+  std::set<std::string, std::less<>> theRegions;
+  //! The apps accepted.
+  std::set<std::string, std::less<>> theApps;
+  //! The first timestamp accepted, in ms.
+  double theBegin = -std::numeric_limits<double>::infinity();
+  //! The timestamps accepted are strictly smaller than this, in ms.
+  double theEnd = std::numeric_limits<double>::infinity();
+
+  //! @return true if all the rows match.
+  bool all() const noexcept {
+    return theRegions.empty() and theApps.empty() and
+           theBegin == -std::numeric_limits<double>::infinity() and
+           theEnd == std::numeric_limits<double>::infinity();
+  }
+
+  //! @return true if the timestamp is in the range accepted.
+  bool matchTimestamp(const double aTimestamp) const noexcept {
+    return aTimestamp >= theBegin and aTimestamp < theEnd;
+  }
+
+  //! @return true if the region is accepted.
+  bool matchRegion(const std::string_view aRegion) const {
+    return theRegions.empty() or theRegions.count(aRegion) > 0;
+  }
+
+  //! @return true if the app is accepted.
+  bool matchApp(const std::string_view aApp) const {
+    return theApps.empty() or theApps.count(aApp) > 0;
+  }
+
+  //! @return true if the app of a key in the format "user,app" is accepted.
+  bool matchKey(const std::string_view aKey) const;
+};
+
+//! The columns of the dataset with string values.
+enum class Column : unsigned int {
+  Region      = 0,
+  User        = 1,
+  App         = 2,
+  Function    = 3,
+  Blob        = 4,
+  BlobType    = 5,
+  BlobVersion = 6,
+  Size        = 7,
+};
+
+/**
+ * @brief The identifier of an application, made of the codes of the user and
+ * the app in the dictionary.
+ */
+using Key = std::pair<std::uint32_t, std::uint32_t>;
+
+//! Hash function of a Key, to be used with unordered containers.
+struct KeyHash {
+  std::size_t operator()(const Key& aKey) const noexcept {
+    return std::hash<std::uint64_t>()(
+        (static_cast<std::uint64_t>(aKey.first) << 32) | aKey.second);
+  }
+};
+
+/**
+ * @brief Map the keys of the applications to dense integer IDs, assigned in
+ * order of appearance, so that per-app state can be kept in flat vectors.
+ *
+ * The IDs are found in a flat open-addressing table, indexed by a
+ * multiplicative hash of the two codes, which does not need any allocation
+ * per key and does not depend on how users and apps are distributed.
+ */
+class KeyIndex final
+{
+ public:
+  //! Create an empty index.
+  KeyIndex()
+      : theSlots(16, theNone)
+      , theBits(4)
+      , theKeys() {
+    // noop
+  }
+
+  //! Add a key, if not already present.
+  //! @return the dense ID of the key.
+  std::uint32_t intern(const Key& aKey) {
+    const auto myMask = theSlots.size() - 1;
+    for (auto i = slot(aKey);; i = (i + 1) & myMask) {
+      const auto myId = theSlots[i];
+      if (myId == theNone) {
+        const auto ret = static_cast<std::uint32_t>(theKeys.size());
+        theSlots[i]    = ret;
+        theKeys.emplace_back(aKey);
+        if (theKeys.size() * 2 > theSlots.size()) {
+          rehash();
+        }
+        return ret;
+      }
+      if (theKeys[myId] == aKey) {
+        return myId;
+      }
+    }
+  }
+
+  //! @return the key with the given dense ID.
+  const Key& key(const std::uint32_t aId) const noexcept {
+    assert(aId < theKeys.size());
+    return theKeys[aId];
+  }
+
+  //! @return the number of keys, i.e., one more than the largest ID.
+  std::size_t size() const noexcept {
+    return theKeys.size();
+  }
+
+ private:
+  static constexpr std::uint32_t theNone = UINT32_MAX;
+
+  //! @return the first slot where to look for a key.
+  std::size_t slot(const Key& aKey) const noexcept {
+    const auto myKey =
+        (static_cast<std::uint64_t>(aKey.first) << 32) | aKey.second;
+    return static_cast<std::size_t>((myKey * 0x9e3779b97f4a7c15ull) >>
+                                    (64 - theBits));
+  }
+
+  //! Double the size of the table, which is kept at most half full.
+  void rehash() {
+    theSlots.assign(theSlots.size() * 2, theNone);
+    theBits++;
+    const auto myMask = theSlots.size() - 1;
+    for (std::uint32_t myId = 0; myId < theKeys.size(); myId++) {
+      auto i = slot(theKeys[myId]);
+      while (theSlots[i] != theNone) {
+        i = (i + 1) & myMask;
+      }
+      theSlots[i] = myId;
+    }
+  }
+
+  // the IDs of the keys, theNone if the slot is empty; the size is 2^theBits
+  std::vector<std::uint32_t> theSlots;
+  unsigned int               theBits;
+  // indexed by ID: the key
+  std::vector<Key> theKeys;
+};
+
+/**
+ * @brief The dictionaries of the string columns of a dataset, which are
+ * shared by all its rows.
+ */
+class Dictionary final
+{
+ public:
+  support::StringTable& operator[](const Column aColumn) noexcept {
+    return theTables[static_cast<unsigned int>(aColumn)];
+  }
+
+  const support::StringTable& operator[](const Column aColumn) const noexcept {
+    return theTables[static_cast<unsigned int>(aColumn)];
+  }
+
+  //! @return the key in the format "user,app".
+  std::string key(const Key& aKey) const;
+
+  //! Add the user and app of a row, if not already present.
+  //! @return the key of the row.
+  Key internKey(const RowView& aRow);
+
+ private:
+  std::array<support::StringTable, static_cast<unsigned int>(Column::Size)>
+      theTables;
+};
+
 /**
  * @brief A row from the Azure function dataset:
  *
  * https://github.com/Azure/AzurePublicDataset/blob/master/AzureFunctionsBlobDataset2020.md
+ *
+ * The string fields are stored as codes of a Dictionary.
  */
 struct Row {
-  explicit Row(const std::string& aRow);
+  //! The codes of the string fields, in the order of Column.
+  using Codes =
+      std::array<std::uint32_t, static_cast<unsigned int>(Column::Size)>;
 
-  std::string key() const {
-    return theUser + "," + theApp;
+  explicit Row(const std::string& aRow, Dictionary& aDictionary);
+  explicit Row(const RowView& aRow, Dictionary& aDictionary);
+  //! Build a row whose strings have already been added to the dictionary.
+  explicit Row(const RowView& aRow, const Codes& aCodes);
+  //! Build a row from its fields.
+  explicit Row(const double      aTimestamp,
+               const Codes&      aCodes,
+               const std::size_t aBlobSize,
+               const bool        aWrite);
+
+  Key key() const noexcept {
+    return Key(theUser, theApp);
+  }
+
+  //! @return the codes of the string fields, in the order of Column.
+  Codes codes() const noexcept {
+    return Codes{theRegion,
+                 theUser,
+                 theApp,
+                 theFunction,
+                 theBlob,
+                 theBlobType,
+                 theBlobVersion};
   }
 
-  double      theTimestamp;   // in ms
-  std::string theRegion;      // unique ID for the region
-  std::string theUser;        // unique ID for the user
-  std::string theApp;         // unique ID for the app
-  std::string theFunction;    // unique ID for the invocation
-  std::string theBlob;        // unique ID for the BLOB accessed
-  std::string theBlobType;    // BLOB type
-  std::string theBlobVersion; // BLOB version
-  std::size_t theBlobSize;    // in bytes
-  bool        theWrite;       // true: write access; false: read access
+  double        theTimestamp;   // in ms
+  std::uint32_t theRegion;      // unique ID for the region
+  std::uint32_t theUser;        // unique ID for the user
+  std::uint32_t theApp;         // unique ID for the app
+  std::uint32_t theFunction;    // unique ID for the invocation
+  std::uint32_t theBlob;        // unique ID for the BLOB accessed
+  std::uint32_t theBlobType;    // BLOB type
+  std::uint32_t theBlobVersion; // BLOB version
+  std::size_t   theBlobSize;    // in bytes
+  bool          theWrite;       // true: write access; false: read access
 };
 
 /**
@@ -77,9 +303,325 @@ struct Row {
  *
  * @param aStream The stream containing the dataset.
  * @param aWithHeader True if the header is present
+ * @param aDictionary The dictionary where to add the strings found.
+ * @param aFilter Only the rows matching this filter are loaded.
  * @return std::deque<Row> The in-memory dataset.
  */
-std::deque<Row> loadDataset(std::istream& aStream, const bool aWithHeader);
+std::deque<Row> loadDataset(std::istream&    aStream,
+                            const bool       aWithHeader,
+                            Dictionary&      aDictionary,
+                            const RowFilter& aFilter = RowFilter());
+
+/**
+ * @brief A row from the Azure function dataset whose string fields refer to
+ * the memory holding the input, which must outlive the object.
+ */
+struct RowView {
+  /**
+   * @brief Parse a row, with the same rules as Row.
+   *
+   * @throw std::runtime_error if the row is invalid.
+   */
+  explicit RowView(const std::string_view aRow);
+
+  /**
+   * @brief Parse a row only if it matches a filter.
+   *
+   * The timestamp, region, and app are checked before parsing the other
+   * fields, hence a row that does not match can have invalid values in
+   * those, but not the wrong number of fields.
+   *
+   * @return the row, or an empty optional if it does not match the filter.
+   *
+   * @throw std::runtime_error if the row is invalid.
+   */
+  static std::optional<RowView> parse(const std::string_view aRow,
+                                      const RowFilter&       aFilter);
+
+  std::string key() const {
+    std::string ret;
+    ret.reserve(theUser.size() + 1 + theApp.size());
+    ret.append(theUser).append(1, ',').append(theApp);
+    return ret;
+  }
+
+  double           theTimestamp;   // in ms
+  std::string_view theRegion;      // unique ID for the region
+  std::string_view theUser;        // unique ID for the user
+  std::string_view theApp;         // unique ID for the app
+  std::string_view theFunction;    // unique ID for the invocation
+  std::string_view theBlob;        // unique ID for the BLOB accessed
+  std::string_view theBlobType;    // BLOB type
+  std::string_view theBlobVersion; // BLOB version
+  std::size_t      theBlobSize;    // in bytes
+  bool             theWrite;       // true: write access; false: read access
+
+ private:
+  RowView() noexcept;
+
+  //! Parse a row, unless it does not match aFilter, then return false.
+  bool load(const std::string_view aRow, const RowFilter& aFilter);
+};
+
+/**
+ * @brief A dataset parsed from a file mapped in memory, whose rows refer
+ * directly to the content of the file, i.e., without copying strings.
+ *
+ * Parsing stops at the first empty line. Invalid rows are skipped and logged,
+ * as with loadDataset(), including those not matching the filter with the
+ * wrong number of fields (see RowFilter). Their errors are also returned by
+ * errors().
+ */
+class MappedDataset final
+{
+  NONCOPYABLE_NONMOVABLE(MappedDataset);
+
+ public:
+  //! The line of an invalid row, counted from 1 after the header, and why.
+  using Error = std::pair<std::size_t, std::string>;
+
+  //! Default minimum size of a chunk parsed by a thread, in bytes.
+  static constexpr std::size_t theMinChunkSize = 1 << 20;
+
+  /**
+   * @brief Map and parse a dataset.
+   *
+   * The file is split into chunks of whole lines, which are parsed in
+   * parallel and then concatenated in order.
+   *
+   * @param aFilename The name of the file containing the dataset.
+   * @param aWithHeader True if the header is present.
+   * @param aNumThreads The maximum number of threads used for parsing, 0
+   * means as many as the hardware concurrency.
+   * @param aFilter Only the rows matching this filter are kept.
+   * @param aMinChunkSize The minimum size of a chunk, in bytes, so that
+   * small files are not split among many threads.
+   *
+   * @throw std::runtime_error if the file cannot be mapped or the header is
+   * missing.
+   */
+  explicit MappedDataset(const std::string& aFilename,
+                         const bool         aWithHeader,
+                         const std::size_t  aNumThreads   = 0,
+                         const RowFilter&   aFilter       = RowFilter(),
+                         const std::size_t  aMinChunkSize = theMinChunkSize);
+
+  //! @return the rows of the dataset, in the order of the file.
+  const std::vector<RowView>& rows() const noexcept {
+    return theRows;
+  }
+
+  //! @return the invalid rows skipped, in the order of the file.
+  const std::vector<Error>& errors() const noexcept {
+    return theErrors;
+  }
+
+ private:
+  support::MappedFile  theFile;
+  std::vector<RowView> theRows;
+  std::vector<Error>   theErrors;
+};
+
+/**
+ * @brief Load a dataset in memory from a file, which is mapped and parsed
+ * in parallel without intermediate copies. Same as
+ * loadDataset(std::istream&, bool, Dictionary&) but much faster.
+ *
+ * @param aFilename The name of the file containing the dataset.
+ * @param aWithHeader True if the header is present
+ * @param aDictionary The dictionary where to add the strings found.
+ * @param aNumThreads The maximum number of threads, 0 means as many as the
+ * hardware concurrency.
+ * @param aFilter Only the rows matching this filter are loaded.
+ * @return std::deque<Row> The in-memory dataset.
+ */
+std::deque<Row> loadDataset(const std::string& aFilename,
+                            const bool         aWithHeader,
+                            Dictionary&        aDictionary,
+                            const std::size_t  aNumThreads = 0,
+                            const RowFilter&   aFilter     = RowFilter());
+
+/**
+ * @brief The Azure function dataset stored by column, i.e., with one array
+ * per field, so that a pass over the dataset only reads the fields that it
+ * needs.
+ *
+ * The string fields are stored as codes of a Dictionary and the read/write
+ * flags as a bitmap.
+ */
+class DatasetColumns final
+{
+ public:
+  //! Create an empty dataset.
+  DatasetColumns();
+
+  //! Create from a row-based dataset.
+  explicit DatasetColumns(const std::deque<Row>& aDataset);
+
+  /**
+   * @brief Create from a mapped dataset, whose strings are added to a
+   * dictionary.
+   *
+   * The columns are filled in parallel, each by a single thread, hence the
+   * codes assigned do not depend on the number of threads.
+   *
+   * @param aDataset The mapped dataset.
+   * @param aDictionary The dictionary where to add the strings found.
+   * @param aNumThreads The maximum number of threads, 0 means as many as the
+   * hardware concurrency.
+   */
+  explicit DatasetColumns(const MappedDataset& aDataset,
+                          Dictionary&          aDictionary,
+                          const std::size_t    aNumThreads = 0);
+
+  //! Add a row at the end of the dataset.
+  void add(const Row& aRow);
+
+  //! @return the number of rows.
+  std::size_t size() const noexcept {
+    return theTimestamps.size();
+  }
+
+  //! @return true if there are no rows.
+  bool empty() const noexcept {
+    return theTimestamps.empty();
+  }
+
+  //! @return the timestamps, in ms.
+  const std::vector<double>& timestamps() const noexcept {
+    return theTimestamps;
+  }
+
+  //! @return the codes of a string column.
+  const std::vector<std::uint32_t>& codes(const Column aColumn) const noexcept {
+    return theCodes[static_cast<unsigned int>(aColumn)];
+  }
+
+  //! @return the BLOB sizes, in bytes.
+  const std::vector<std::uint64_t>& sizes() const noexcept {
+    return theSizes;
+  }
+
+  //! @return the write flags, 64 rows per word starting from the LSB.
+  const std::vector<std::uint64_t>& writes() const noexcept {
+    return theWrites;
+  }
+
+  //! @return true if the given row is a write access.
+  bool write(const std::size_t aIndex) const noexcept {
+    return (theWrites[aIndex / 64] >> (aIndex % 64)) & 1u;
+  }
+
+  //! @return the key of the given row.
+  Key key(const std::size_t aIndex) const noexcept {
+    return Key(theCodes[static_cast<unsigned int>(Column::User)][aIndex],
+               theCodes[static_cast<unsigned int>(Column::App)][aIndex]);
+  }
+
+  //! @return the given row.
+  Row row(const std::size_t aIndex) const;
+
+ private:
+  std::vector<double> theTimestamps;
+  std::array<std::vector<std::uint32_t>,
+             static_cast<unsigned int>(Column::Size)>
+                             theCodes;
+  std::vector<std::uint64_t> theSizes;
+  std::vector<std::uint64_t> theWrites;
+};
+
+/**
+ * @brief Load a dataset in memory by column from a file, which is mapped and
+ * parsed in parallel.
+ *
+ * @param aFilename The name of the file containing the dataset.
+ * @param aWithHeader True if the header is present
+ * @param aDictionary The dictionary where to add the strings found.
+ * @param aNumThreads The maximum number of threads, 0 means as many as the
+ * hardware concurrency.
+ * @param aFilter Only the rows matching this filter are loaded.
+ * @return DatasetColumns The in-memory dataset.
+ */
+DatasetColumns loadColumns(const std::string& aFilename,
+                           const bool         aWithHeader,
+                           Dictionary&        aDictionary,
+                           const std::size_t  aNumThreads = 0,
+                           const RowFilter&   aFilter     = RowFilter());
+
+/**
+ * @brief Assign a dense ID to the key of every row of a dataset.
+ *
+ * @param aDataset The in-memory dataset.
+ * @param aIndex The index where to add the keys found.
+ * @return the dense IDs of the keys, one per row.
+ */
+std::vector<std::uint32_t> keyIds(const DatasetColumns& aDataset,
+                                  KeyIndex&             aIndex);
+
+/**
+ * @brief Read a dataset one row at a time, i.e., with memory that does not
+ * depend on the size of the dataset.
+ *
+ * Reading stops at the first empty line. Invalid rows are skipped and logged,
+ * as with loadDataset(), including those not matching the filter with the
+ * wrong number of fields (see RowFilter).
+ */
+class RowReader final
+{
+  NONCOPYABLE_NONMOVABLE(RowReader);
+
+ public:
+  /**
+   * @brief Read from a stream, which must outlive the object.
+   *
+   * @param aStream The stream containing the dataset.
+   * @param aWithHeader True if the header is present.
+   * @param aFilter Only the rows matching this filter are read.
+   *
+   * @throw std::runtime_error if the header is missing.
+   */
+  explicit RowReader(std::istream&    aStream,
+                     const bool       aWithHeader,
+                     const RowFilter& aFilter = RowFilter());
+
+  /**
+   * @brief Read from a file.
+   *
+   * @param aFilename The name of the file containing the dataset.
+   * @param aWithHeader True if the header is present.
+   * @param aFilter Only the rows matching this filter are read.
+   *
+   * @throw std::runtime_error if the file cannot be opened or the header is
+   * missing.
+   */
+  explicit RowReader(const std::string& aFilename,
+                     const bool         aWithHeader,
+                     const RowFilter&   aFilter = RowFilter());
+
+  /**
+   * @brief Read the next valid row.
+   *
+   * @return false if there are no more rows.
+   */
+  bool next();
+
+  //! @return the last row read, which is valid until the next call to next().
+  const RowView& row() const noexcept {
+    assert(theRow.has_value());
+    return *theRow;
+  }
+
+ private:
+  void skipHeader(const bool aWithHeader);
+
+ private:
+  std::unique_ptr<std::ifstream> theFile;
+  std::istream&                  theStream;
+  const RowFilter                theFilter;
+  std::string                    theLine;
+  std::size_t                    theLineId;
+  std::optional<RowView>         theRow;
+};
 
 /**
  * @brief How we assume functions will be invoked.
@@ -88,7 +630,8 @@ enum class ExecMode : unsigned int {
   AlwaysMu     = 0, //!< microservices only
   AlwaysLambda = 1, //!< stateless functions only
   BestNext     = 2, //!< decide based on the next invocation
-  Size         = 3,
+  Optimal      = 3, //!< minimum cost, knowing all the invocations in advance
+  Size         = 4,
 };
 
 std::string toString(const ExecMode aExecMode);
@@ -110,6 +653,22 @@ struct CostModel {
   static const std::vector<std::string>& explain();
 };
 
+/**
+ * @brief Load a list of cost models from a text file.
+ *
+ * Every line contains the eight costs, comma-separated in the same order
+ * as CostModel::explain(); empty lines and lines starting with # are
+ * ignored. Any cost can be given as a colon-separated list of values, in
+ * which case the line expands to the Cartesian product of all the values,
+ * e.g. 0,0.6,0.4,5,6.3e-3:6.3e-6,0,12,12 yields two cost models.
+ *
+ * @param aFilename The name of the file.
+ * @return The cost models, in the order in which they appear in the file.
+ *
+ * @throw std::runtime_error if the file cannot be read or it is invalid.
+ */
+std::vector<CostModel> loadCostModels(const std::string& aFilename);
+
 struct CostOutput {
   enum class Type : unsigned int {
     Microservice = 0,
@@ -133,6 +692,12 @@ struct CostOutput {
   // default value of theBestNextLastType
   std::deque<double> theBestNextPeriods;
 
+  // costs of the online policies, in the same order as passed to cost()
+  std::vector<double> thePolicyCosts;
+
+  //! @return the extra cost of best-next compared to the optimal schedule.
+  double bestNextGap() const;
+
   std::string                            toString() const;
   static const std::vector<std::string>& explain();
 };
@@ -148,39 +713,375 @@ using TimestampDataset =
  * @brief Convert a raw dataset to a timestamp dataset.
  *
  * @param aDataset The raw dataset.
+ * @param aDictionary The dictionary of the raw dataset.
  * @return TimestampDataset
  */
-TimestampDataset toTimestampDataset(const std::deque<Row>& aDataset);
+TimestampDataset toTimestampDataset(const std::deque<Row>& aDataset,
+                                    const Dictionary&      aDictionary);
 
 /**
- * @brief Load a timestamp dataset from file.
+ * @brief Build a timestamp dataset one event at a time.
  *
- * @param aFilename The name of the file to load the dataset from.
+ * Only the timestamps and read/write flags are kept, grouped by key.
+ */
+class TimestampDatasetBuilder final
+{
+ public:
+  TimestampDatasetBuilder();
+
+  //! Add an event of the app with the given key.
+  void add(const Key& aKey, const double aTimestamp, const bool aWrite) {
+    theGroups[aKey].emplace_back(aTimestamp, aWrite);
+  }
+
+  //! @return the timestamp dataset, after which the builder is empty.
+  TimestampDataset build(const Dictionary& aDictionary);
+
+ private:
+  std::unordered_map<Key, TimestampDataset::mapped_type, KeyHash> theGroups;
+};
+
+//! Same as toTimestampDataset(const std::deque<Row>&, const Dictionary&).
+TimestampDataset toTimestampDataset(const DatasetColumns& aDataset,
+                                    const Dictionary&     aDictionary);
+
+/**
+ * @brief Convert a raw dataset to a timestamp dataset reading it one row at a
+ * time, hence without loading the raw dataset in memory.
+ *
+ * @param aReader The reader of the raw dataset.
+ * @param aDictionary The dictionary where to add the users and apps found.
  * @return TimestampDataset
  */
-TimestampDataset loadTimestampDataset(const std::string& aFilename);
+TimestampDataset toTimestampDataset(RowReader&  aReader,
+                                    Dictionary& aDictionary);
 
 /**
- * @brief Load a timestamp dataset from file.
+ * @brief Load a timestamp dataset from file, in any version of the format.
+ *
+ * With versions 2 and 3 the keys whose app does not match the filter are
+ * skipped using the directory, without reading their events. The keys left
+ * without events in the time range of the filter are not loaded.
  *
  * @param aFilename The name of the file to load the dataset from.
+ * @param aFilter Only the events matching this filter are loaded, which
+ * cannot select regions since they are not stored in the file.
  * @return TimestampDataset
+ *
+ * @throw std::runtime_error if the file cannot be read or it is invalid, or
+ * if the filter selects regions.
+ */
+TimestampDataset loadTimestampDataset(const std::string& aFilename,
+                                      const RowFilter&   aFilter = RowFilter());
+
+/**
+ * @brief Save a timestamp dataset to file.
+ *
+ * Version 1 of the format stores each key followed by its events, as
+ * (timestamp, write flag) pairs, with the endianness and padding of the host.
+ *
+ * Version 2 stores in little-endian order:
+ * - the version number, as a 64-bit integer;
+ * - the events of each key in a contiguous block, made of the timestamps
+ *   followed by a bitmap of the write flags, padded to 64 bits;
+ * - a directory with the offset of the block, the number of events, and the
+ *   name of each key, padded to 64 bits;
+ * - the offset of the directory and the number of keys, as 64-bit integers.
+ *
+ * Version 3 is the same as version 2, but the blocks of events are
+ * compressed: the timestamps are converted to integers, with the smallest
+ * number of decimal digits that represents all the timestamps of the key
+ * exactly, then the differences between consecutive timestamps are stored as
+ * variable-length integers, each with the write flag in the least
+ * significant bit. Timestamps with more than 6 decimal digits are stored as
+ * differences between their bit representations. The conversion is lossless.
+ *
+ * @param aDataset The dataset to be saved.
+ * @param aFilename The name of the file to save the dataset to.
+ * @param aVersion The version of the format, one of 1, 2, or 3.
+ *
+ * @throw std::runtime_error if the file cannot be written or the version is
+ * invalid.
  */
 void saveTimestampDataset(const TimestampDataset& aDataset,
-                          const std::string&      aFilename);
+                          const std::string&      aFilename,
+                          const std::size_t       aVersion = 2);
+
+/**
+ * @brief Save a timestamp dataset to file one key at a time, in version 2 or
+ * 3 of the format, see saveTimestampDataset(), so that the whole dataset is
+ * never in memory.
+ *
+ * The directory is kept in memory until close(), which is the only method
+ * that makes the file valid: the version number is zero until then, hence
+ * a file left incomplete, e.g., by an exception, is rejected when loaded.
+ * Not thread-safe.
+ */
+class TimestampDatasetWriter final
+{
+  NONCOPYABLE_NONMOVABLE(TimestampDatasetWriter);
+
+ public:
+  /**
+   * @brief Open the file, which must be seekable.
+   *
+   * @throw std::runtime_error if the file cannot be written or the version is
+   * not 2 or 3.
+   */
+  explicit TimestampDatasetWriter(const std::string& aFilename,
+                                  const std::size_t  aVersion);
+
+  //! Close the file, which is invalid unless close() has been called.
+  ~TimestampDatasetWriter();
+
+  /**
+   * @brief Append the events of a key, which must not have been added before.
+   *
+   * @throw std::runtime_error if the file cannot be written or it is closed.
+   */
+  void add(const std::string&                   aKey,
+           const TimestampDataset::mapped_type& aEvents);
+
+  /**
+   * @brief Write the directory and the version number, then close the file.
+   * Subsequent calls have no effect.
+   *
+   * @throw std::runtime_error if the file cannot be written.
+   */
+  void close();
+
+ private:
+  void write(const char* aData, const std::size_t aSize);
+
+ private:
+  struct Entry {
+    std::string   theKey;
+    std::uint64_t theOffset;
+    std::uint64_t theNumEvents;
+  };
+
+  const std::string  theFilename;
+  const std::size_t  theVersion;
+  std::ofstream      theStream;
+  std::vector<char>  theBuffer;
+  std::vector<Entry> theDirectory;
+  std::uint64_t      theOffset;
+  bool               theClosed;
+};
+
+/**
+ * @brief Return the version of the format of a timestamp dataset file.
+ *
+ * @throw std::runtime_error if the file cannot be read.
+ */
+std::size_t timestampDatasetVersion(const std::string& aFilename);
+
+/**
+ * @brief Count over time the intervals [begin, end) that are open, e.g., the
+ * apps running concurrently.
+ *
+ * All the begins and ends with the same timestamp are coalesced, hence an
+ * interval whose begin is equal to its end is never counted.
+ *
+ * @param aBegins The begins of the intervals, in any order.
+ * @param aEnds The ends of the intervals, in any order.
+ * @param aResolution If zero, the count is saved at every timestamp where an
+ * interval begins or ends, after all of them. Otherwise, the count is saved
+ * at every multiple of aResolution, from the last one not after the first
+ * begin to the first one not before the last end, where it is zero.
+ * @param aSeries Where to append the pairs (timestamp, count), in
+ * chronological order.
+ *
+ * @throw std::runtime_error if the number of begins and ends are different or
+ * an interval would end before it begins.
+ */
+void countIntervals(
+    std::vector<std::uint64_t>                          aBegins,
+    std::vector<std::uint64_t>                          aEnds,
+    const std::uint64_t                                 aResolution,
+    std::vector<std::pair<std::uint64_t, std::size_t>>& aSeries);
+
+namespace detail {
+
+//! @return the actual number of threads, 0 meaning all hardware threads.
+std::size_t numThreads(const std::size_t aNumThreads);
+
+/**
+ * @brief Call aFunctor(i) for i in [0, aSize), each in a dedicated thread,
+ * or in the calling thread if aSize is 1.
+ *
+ * @throw the first exception thrown by aFunctor, if any.
+ */
+template <class FUNCTOR>
+void parallelFor(const std::size_t aSize, FUNCTOR&& aFunctor) {
+  if (aSize == 1) {
+    aFunctor(std::size_t(0));
+    return;
+  }
+  std::vector<std::exception_ptr> myErrors(aSize);
+  std::vector<std::thread>        myThreads;
+  myThreads.reserve(aSize);
+  for (std::size_t i = 0; i < aSize; i++) {
+    myThreads.emplace_back([&, i]() {
+      try {
+        aFunctor(i);
+      } catch (...) {
+        myErrors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto& myThread : myThreads) {
+    myThread.join();
+  }
+  for (const auto& myError : myErrors) {
+    if (myError) {
+      std::rethrow_exception(myError);
+    }
+  }
+}
+
+//! @return the 64-bit integer stored in little-endian order at aData.
+inline std::uint64_t loadLittleEndian(const char* aData) noexcept {
+  std::uint64_t ret;
+  std::memcpy(&ret, aData, sizeof(ret));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  ret = __builtin_bswap64(ret);
+#endif
+  return ret;
+}
+
+} // namespace detail
+
+/**
+ * @brief A timestamp dataset saved in version 2 of the format and mapped in
+ * memory, whose events are read directly from the file, without copies.
+ */
+class MappedTimestampDataset final
+{
+  NONCOPYABLE_NONMOVABLE(MappedTimestampDataset);
+
+ public:
+  //! The events of a key, in chronological order.
+  class Events final
+  {
+   public:
+    explicit Events(const char*       aTimestamps,
+                    const char*       aWrites,
+                    const std::size_t aSize);
+
+    //! @return the number of events.
+    std::size_t size() const noexcept {
+      return theSize;
+    }
+
+    //! @return the timestamp of the given event.
+    double timestamp(const std::size_t aIndex) const noexcept {
+      const auto myValue = detail::loadLittleEndian(theTimestamps + aIndex * 8);
+      double     ret;
+      std::memcpy(&ret, &myValue, sizeof(ret));
+      return ret;
+    }
+
+    //! @return true if the given event is a write access.
+    bool write(const std::size_t aIndex) const noexcept {
+      return (detail::loadLittleEndian(theWrites + aIndex / 64 * 8) >>
+              (aIndex % 64)) &
+             1u;
+    }
+
+   private:
+    const char* theTimestamps;
+    const char* theWrites;
+    std::size_t theSize;
+  };
+
+  /**
+   * @brief Map a timestamp dataset and read its directory.
+   *
+   * @param aFilename The name of the file containing the dataset.
+   *
+   * @throw std::runtime_error if the file cannot be mapped, it is not in
+   * version 2 of the format, or it is invalid.
+   */
+  explicit MappedTimestampDataset(const std::string& aFilename);
+
+  //! @return the number of keys.
+  std::size_t size() const noexcept {
+    return theEntries.size();
+  }
+
+  //! @return the i-th key, in the order of the file.
+  std::string_view key(const std::size_t aIndex) const noexcept {
+    return theEntries[aIndex].first;
+  }
+
+  //! @return the events of the i-th key, in the order of the file.
+  const Events& events(const std::size_t aIndex) const noexcept {
+    return theEntries[aIndex].second;
+  }
+
+  //! @return the events of a key, nullptr if not present.
+  const Events* find(const std::string_view aKey) const;
+
+ private:
+  support::MappedFile                               theFile;
+  std::vector<std::pair<std::string_view, Events>>  theEntries;
+  std::unordered_map<std::string_view, std::size_t> theIndex;
+};
 
 /**
  * @brief Compute the execution cost of function invocation with all modes.
  *
+ * The keys are independent from one another and they are evaluated in
+ * parallel, starting from those with the most invocations.
+ *
  * @param aDataset The input dataset.
  * @param aCostModel The cost model.
  * @param aSaveBnPeriods If true also save the alternating best-next periods.
+ * @param aNumThreads The number of threads, 0 means hardware concurrency.
+ * @param aBestNextLookAhead The maximum number of future invocations that
+ * best-next considers to decide whether to migrate from stateless function
+ * to microservice, 0 means unlimited.
+ * @param aPolicies The descriptions of the online policies to evaluate in
+ * addition to the execution modes, see Policy::fromString().
  * @return The performance metrics, one per key.
+ *
+ * @throw std::runtime_error if a policy description is not valid.
  */
 std::unordered_map<std::string, CostOutput>
-cost(const TimestampDataset& aDataset,
-     const CostModel&        aCostModel,
-     const bool              aSaveBnPeriods);
+cost(const TimestampDataset&         aDataset,
+     const CostModel&                aCostModel,
+     const bool                      aSaveBnPeriods,
+     const std::size_t               aNumThreads        = 0,
+     const std::size_t               aBestNextLookAhead = 500,
+     const std::vector<std::string>& aPolicies          = {});
+
+/**
+ * @brief Compute the execution cost of function invocation with all modes
+ * for many cost models at once.
+ *
+ * The timestamps of every key are scanned only once and the inter-arrival
+ * times are shared by all the cost models, rather than being recomputed by
+ * calling cost() once per model.
+ *
+ * @param aDataset The input dataset.
+ * @param aCostModels The cost models.
+ * @param aSaveBnPeriods If true also save the alternating best-next periods.
+ * @param aNumThreads The number of threads, 0 means hardware concurrency.
+ * @param aBestNextLookAhead The best-next look-ahead, 0 means unlimited.
+ * @param aPolicies The descriptions of the online policies.
+ * @return The performance metrics, one per key, each with one element per
+ * cost model, in the same order as aCostModels.
+ *
+ * @throw std::runtime_error if a policy description is not valid.
+ */
+std::unordered_map<std::string, std::vector<CostOutput>>
+cost(const TimestampDataset&         aDataset,
+     const std::vector<CostModel>&   aCostModels,
+     const bool                      aSaveBnPeriods,
+     const std::size_t               aNumThreads        = 0,
+     const std::size_t               aBestNextLookAhead = 500,
+     const std::vector<std::string>& aPolicies          = {});
 
 } // namespace dataset
 } // namespace uiiit
\ No newline at end of file
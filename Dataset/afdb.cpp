@@ -34,6 +34,7 @@ SOFTWARE.
 //
 
 #include "Dataset/afdb-utils.h"
+#include "Support/filewriter.h"
 #include "Support/glograii.h"
 #include "Support/split.h"
 #include "Support/versionutils.h"
@@ -45,36 +46,60 @@ SOFTWARE.
 
 #include <glog/logging.h>
 
+#include <array>
 #include <cassert>
+#include <charconv>
 #include <deque>
 #include <exception>
-#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <map>
-#include <sstream>
+#include <optional>
+#include <set>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <type_traits>
 #include <vector>
 
 namespace po = boost::program_options;
 namespace us = uiiit::support;
 namespace ud = uiiit::dataset;
 
-std::unique_ptr<std::ofstream>
-openFile(const std::string&             aFilename,
-         const boost::filesystem::path& aOutputPath) {
-  const auto myFilename = (aOutputPath / aFilename).string();
-  auto       ret        = std::make_unique<std::ofstream>(myFilename);
-  if (not *ret) {
-    throw std::runtime_error("error when opening file for writing: " +
-                             myFilename);
+//! Append a number to a buffer, with the same format as std::ostream.
+template <class T>
+void appendNumber(std::string& aBuffer, const T aValue) {
+  std::array<char, 32> myChars;
+  char*                myEnd;
+  if constexpr (std::is_floating_point_v<T>) {
+    // same as the default precision of std::ostream
+    myEnd = std::to_chars(myChars.begin(),
+                          myChars.end(),
+                          aValue,
+                          std::chars_format::general,
+                          6)
+                .ptr;
+  } else {
+    myEnd = std::to_chars(myChars.begin(), myChars.end(), aValue).ptr;
   }
-  return ret;
+  aBuffer.append(myChars.begin(), myEnd);
 }
 
-//! Collects lifetime information of an application.
+//! Append a key in the format "user,app" to a buffer.
+void appendKey(std::string&          aBuffer,
+               const ud::Dictionary& aDictionary,
+               const ud::Key&        aKey) {
+  aBuffer.append(aDictionary[ud::Column::User][aKey.first])
+      .append(1, ',')
+      .append(aDictionary[ud::Column::App][aKey.second]);
+}
+
+//! Collects lifetime information of an application in a region.
 struct Lifecycle {
+  //! The code of the region.
+  std::uint32_t theRegion = 0;
+  //! The dense ID of the key of the application.
+  std::uint32_t theId = 0;
   //! The timestamp of the first event of the application.
   uint64_t theBegin = 0;
   //! The timestamp of the last event of the application.
@@ -98,129 +123,237 @@ struct Lifecycle {
     return theCalls == 1 or (theBegin == theEnd);
   }
 
-  //! \return a string with values separated by commas.
-  std::string toString() const {
-    std::stringstream ret;
-    ret << theBegin << ',' << theEnd << ',' << theWrite << ',' << theRead << ','
-        << theCalls << ',' << theSession;
-    return ret.str();
+  //! Append the values, separated by commas, to a buffer.
+  void format(std::string& aBuffer) const {
+    appendNumber(aBuffer, theBegin);
+    aBuffer.push_back(',');
+    appendNumber(aBuffer, theEnd);
+    aBuffer.push_back(',');
+    appendNumber(aBuffer, theWrite);
+    aBuffer.push_back(',');
+    appendNumber(aBuffer, theRead);
+    aBuffer.push_back(',');
+    appendNumber(aBuffer, theCalls);
+    aBuffer.push_back(',');
+    appendNumber(aBuffer, theSession);
   }
 };
 
-using Lifecycles =
-    std::unordered_map<std::string, std::unordered_map<std::string, Lifecycle>>;
+// one per region and app, in order of appearance
+using Lifecycles = std::vector<Lifecycle>;
+
+//! The fields of a row of the dataset used by the analyses.
+struct Event {
+  double        theTimestamp; // in ms
+  std::uint32_t theRegion;    // code of the region
+  std::uint32_t theId;        // dense ID of the key of the app
+  std::uint64_t theSize;      // BLOB size, in bytes
+  bool          theWrite;     // true: write access; false: read access
+};
+
+/**
+ * @brief Call aFunctor with each event of a dataset loaded in memory.
+ *
+ * @param aDataset The dataset.
+ * @param aIds The dense IDs of the keys of the rows, see ud::keyIds().
+ * @param aFunctor The functor called with each event.
+ */
+template <class FUNCTOR>
+void forEachEvent(const ud::DatasetColumns&         aDataset,
+                  const std::vector<std::uint32_t>& aIds,
+                  FUNCTOR&&                         aFunctor) {
+  assert(aIds.size() == aDataset.size());
+  const auto& myTimestamps = aDataset.timestamps();
+  const auto& myRegions    = aDataset.codes(ud::Column::Region);
+  const auto& mySizes      = aDataset.sizes();
+  for (std::size_t i = 0; i < aDataset.size(); i++) {
+    aFunctor(Event{myTimestamps[i],
+                   myRegions[i],
+                   aIds[i],
+                   mySizes[i],
+                   aDataset.write(i)});
+  }
+}
 
 /**
- * @brief Extract from the dataset lifecycle information about the apps.
+ * @brief Call aFunctor with each event of a dataset read one row at a time.
  *
- * @param aDataset The input dataset.
- * @param aLifecycles The output data.
- * @param aSessionduration The session duration after the last call, in minutes.
+ * Only the regions, users, and apps are added to the dictionary, hence the
+ * memory used does not grow with the number of events.
  */
-void lifecycles(const std::deque<ud::Row>& aDataset,
-                Lifecycles&                aLifecycles,
-                const double               aSessionduration) {
-  assert(aLifecycles.empty());
-  if (aDataset.empty()) {
-    return;
+template <class FUNCTOR>
+void forEachEvent(ud::RowReader&  aReader,
+                  ud::Dictionary& aDictionary,
+                  ud::KeyIndex&   aIndex,
+                  FUNCTOR&&       aFunctor) {
+  while (aReader.next()) {
+    const auto& myRow = aReader.row();
+    aFunctor(Event{myRow.theTimestamp,
+                   aDictionary[ud::Column::Region].intern(myRow.theRegion),
+                   aIndex.intern(aDictionary.internKey(myRow)),
+                   myRow.theBlobSize,
+                   myRow.theWrite});
+  }
+}
+
+//! Extract lifecycle information about the apps, one event at a time.
+class LifecyclesAnalysis final
+{
+ public:
+  /**
+   * @brief Create an analysis without events.
+   *
+   * @param aSessionDuration The session duration after the last call, in
+   * minutes.
+   */
+  explicit LifecyclesAnalysis(const double aSessionDuration)
+      : theSessionDuration(
+            static_cast<uint64_t>(aSessionDuration * 60 * 1000)) // min -> ms
+      , theTimeRef()
+      , theHeads()
+      , theNext()
+      , theLifecycles() {
+    // noop
   }
-  const auto mySessionDuration =
-      static_cast<uint64_t>(aSessionduration * 60 * 1000); // minutes -> ms
-  const auto myTimeRef = static_cast<uint64_t>(aDataset.front().theTimestamp);
-  for (const auto& myRow : aDataset) {
-    auto& myPerRegion =
-        aLifecycles.emplace(myRow.theRegion, Lifecycles::mapped_type())
-            .first->second;
-    auto& myLifecycle =
-        myPerRegion.emplace(myRow.key(), Lifecycle()).first->second;
+
+  //! Add the next event, in chronological order.
+  void operator()(const Event& aEvent) {
+    if (not theTimeRef.has_value()) {
+      theTimeRef = static_cast<uint64_t>(aEvent.theTimestamp);
+    }
+    auto& myLifecycle = find(aEvent.theRegion, aEvent.theId);
     const auto myTimestamp =
-        static_cast<uint64_t>(myRow.theTimestamp) - myTimeRef;
+        static_cast<uint64_t>(aEvent.theTimestamp) - *theTimeRef;
     const auto myFirst = myLifecycle.first();
     if (myFirst) {
       myLifecycle.theBegin = myTimestamp;
     }
     const auto mySinceLast = myTimestamp - myLifecycle.theEnd;
     myLifecycle.theEnd     = myTimestamp;
-    if (myRow.theWrite) {
-      myLifecycle.theWrite += myRow.theBlobSize;
+    if (aEvent.theWrite) {
+      myLifecycle.theWrite += aEvent.theSize;
     } else {
-      myLifecycle.theRead += myRow.theBlobSize;
+      myLifecycle.theRead += aEvent.theSize;
     }
     myLifecycle.theCalls++;
     if (not myFirst) {
-      myLifecycle.theSession += std::min(mySinceLast, mySessionDuration);
+      myLifecycle.theSession += std::min(mySinceLast, theSessionDuration);
     }
   }
 
+  //! @return the lifecycles of the apps found so far.
+  const Lifecycles& lifecycles() const {
 #ifndef NDEBUG
-  // consistency checks
-  for (const auto& myPerRegion : aLifecycles) {
-    for (const auto& myPerApp : myPerRegion.second) {
-      const auto& myLifecycle = myPerApp.second;
+    // consistency checks
+    for (const auto& myLifecycle : theLifecycles) {
       assert(myLifecycle.theEnd >= myLifecycle.theBegin);
       assert(myLifecycle.singleton() or
              myLifecycle.theEnd > myLifecycle.theBegin);
       assert(not myLifecycle.first() or myLifecycle.theSession == 0);
     }
-  }
 #endif
-}
+    return theLifecycles;
+  }
+
+ private:
+  //! @return the lifecycle of an app in a region, added if not present.
+  Lifecycle& find(const std::uint32_t aRegion, const std::uint32_t aId) {
+    if (aId >= theHeads.size()) {
+      theHeads.resize(aId + 1, theNone);
+    }
+    // the lifecycles of the same app in different regions are chained
+    auto* myPos = &theHeads[aId];
+    while (*myPos != theNone) {
+      if (theLifecycles[*myPos].theRegion == aRegion) {
+        return theLifecycles[*myPos];
+      }
+      myPos = &theNext[*myPos];
+    }
+    *myPos = static_cast<std::uint32_t>(theLifecycles.size());
+    theNext.emplace_back(theNone);
+    auto& ret     = theLifecycles.emplace_back();
+    ret.theRegion = aRegion;
+    ret.theId     = aId;
+    return ret;
+  }
+
+  //! The end of a chain of lifecycles.
+  static constexpr std::uint32_t theNone = UINT32_MAX;
+
+  const uint64_t          theSessionDuration;
+  std::optional<uint64_t> theTimeRef;
+  // indexed by app ID: the position of its first lifecycle
+  std::vector<std::uint32_t> theHeads;
+  // indexed by position: the next lifecycle of the same app
+  std::vector<std::uint32_t> theNext;
+  Lifecycles                 theLifecycles;
+};
 
 /**
  * @brief Save to files info about the lifecycles of apps.
  *
  * @param aLifecycles The info data to be saved.
- * @param aOutputPath The directory where the data will be saved.
+ * @param aDictionary The dictionary of the dataset.
+ * @param aIndex The index of the keys of the apps.
+ * @param aWriter The writer of the output files.
  * @param aSingletons If true then also save apps with a single function call.
- *
- * \pre aOutputPath exists and it is a directory
+ * @param aResolution If not zero, the number of concurrent apps is only saved
+ * at the multiples of this value, in ms, rather than at every change.
  */
-void saveLifecycles(const Lifecycles&              aLifecycles,
-                    const boost::filesystem::path& aOutputPath,
-                    const bool                     aSingletons) {
-
-  // save lifecycles, one per region
-  for (const auto& myPerRegion : aLifecycles) {
-    auto myStream = openFile(myPerRegion.first + ".dat", aOutputPath);
-    for (const auto& myPerApp : myPerRegion.second) {
-      if (aSingletons or not myPerApp.second.singleton()) {
-        *myStream << myPerApp.first << ',' << myPerApp.second.toString()
-                  << '\n';
-      }
+void saveLifecycles(const Lifecycles&     aLifecycles,
+                    const ud::Dictionary& aDictionary,
+                    const ud::KeyIndex&   aIndex,
+                    us::FileWriter&       aWriter,
+                    const bool            aSingletons,
+                    const uint64_t        aResolution) {
+
+  // save lifecycles, one file per region, indexed by the region code
+  std::vector<std::optional<std::string>> myBuffers;
+  for (const auto& myLifecycle : aLifecycles) {
+    if (myLifecycle.theRegion >= myBuffers.size()) {
+      myBuffers.resize(myLifecycle.theRegion + 1);
     }
-  }
-
-  // save number of concurrent apps, in total
-  struct Event {
-    enum Type : uint8_t {
-      Begin = 0,
-      End   = 1,
-    };
-    uint64_t theTimestamp = 0;
-    Type     theType      = Type::Begin;
-    bool     operator<(const Event& aOther) const noexcept {
-      return theTimestamp < aOther.theTimestamp;
+    auto& myBuffer = myBuffers[myLifecycle.theRegion];
+    if (not myBuffer.has_value()) {
+      // the file is created even if all its apps are skipped
+      myBuffer.emplace();
     }
-  };
-
-  std::multiset<Event> myEvents;
-  for (const auto& myPerRegion : aLifecycles) {
-    for (const auto& myPerApp : myPerRegion.second) {
-      myEvents.emplace(Event{myPerApp.second.theBegin, Event::Begin});
-      myEvents.emplace(Event{myPerApp.second.theEnd, Event::End});
+    if (aSingletons or not myLifecycle.singleton()) {
+      appendKey(*myBuffer, aDictionary, aIndex.key(myLifecycle.theId));
+      myBuffer->push_back(',');
+      myLifecycle.format(*myBuffer);
+      myBuffer->push_back('\n');
     }
   }
-
-  auto        myStream     = openFile("concurrent.dat", aOutputPath);
-  std::size_t myConcurrent = 0;
-  for (const auto& myEvent : myEvents) {
-    if (myEvent.theType == Event::Begin) {
-      myConcurrent++;
-    } else {
-      myConcurrent--;
+  for (std::uint32_t myRegion = 0; myRegion < myBuffers.size(); myRegion++) {
+    if (myBuffers[myRegion].has_value()) {
+      aWriter.write(aDictionary[ud::Column::Region][myRegion] + ".dat",
+                    std::move(*myBuffers[myRegion]));
     }
-    *myStream << myEvent.theTimestamp << ' ' << myConcurrent << '\n';
   }
+  myBuffers.clear();
+
+  // save number of concurrent apps, in total
+  std::vector<uint64_t> myBegins;
+  std::vector<uint64_t> myEnds;
+  myBegins.reserve(aLifecycles.size());
+  myEnds.reserve(aLifecycles.size());
+  for (const auto& myLifecycle : aLifecycles) {
+    myBegins.emplace_back(myLifecycle.theBegin);
+    myEnds.emplace_back(myLifecycle.theEnd);
+  }
+  std::vector<std::pair<uint64_t, std::size_t>> mySeries;
+  ud::countIntervals(
+      std::move(myBegins), std::move(myEnds), aResolution, mySeries);
+
+  std::string myBuffer;
+  for (const auto& mySample : mySeries) {
+    appendNumber(myBuffer, mySample.first);
+    myBuffer.push_back(' ');
+    appendNumber(myBuffer, mySample.second);
+    myBuffer.push_back('\n');
+  }
+  aWriter.write("concurrent.dat", std::move(myBuffer));
 }
 
 //! Collects the read vs. write period durations and number of events in each
@@ -232,105 +365,170 @@ struct Period {
   std::vector<std::size_t> theWriteEvents;
 };
 
-std::size_t
-readWritePeriods(const std::deque<ud::Row>&               aDataset,
-                 std::unordered_map<std::string, Period>& aPeriods) {
-  // largest vector
-  std::size_t ret = 0;
-
-  // key: user id + app id
-  // value: 0: last timestamp
-  //        1: last write flag
-  //        2: consecutive events
-  std::unordered_map<std::string, std::tuple<double, bool, std::size_t>> myLast;
-  for (const auto& myRow : aDataset) {
-    const auto myKey = myRow.key();
-    auto       res   = myLast.emplace(
-        myKey, std::make_tuple(myRow.theTimestamp, myRow.theWrite, 1));
-
-    if (not res.second) {
-      if (std::get<1>(res.first->second) == myRow.theWrite) {
-        // we are in the middle of a period of consecutive read/write operations
-        std::get<2>(res.first->second)++;
+// indexed by the dense ID of the key of the app
+using Periods = std::vector<Period>;
 
-      } else {
-        // the read/write period just ended
-        auto& myPeriod = aPeriods[myKey];
+/**
+ * @brief Extract the read vs. write periods of the apps, one event at a time.
+ *
+ * Unlike the other analyses, the state is not bounded by the number of apps:
+ * every period ended is kept until the output is saved, hence the memory
+ * grows with the number of read/write switches in the dataset, also in
+ * streaming mode.
+ */
+class ReadWritePeriodsAnalysis final
+{
+ public:
+  ReadWritePeriodsAnalysis()
+      : thePeriods()
+      , theLast()
+      , theMaxValues(0) {
+    // noop
+  }
 
-        auto& myDurations = myRow.theWrite ? myPeriod.theReadDurations :
-                                             myPeriod.theWriteDurations;
-        myDurations.emplace_back(myRow.theTimestamp -
-                                 std::get<0>(res.first->second));
+  //! Add the next event, in chronological order.
+  void operator()(const Event& aEvent) {
+    if (aEvent.theId >= theLast.size()) {
+      theLast.resize(aEvent.theId + 1);
+      thePeriods.resize(aEvent.theId + 1);
+    }
+    auto& myLast = theLast[aEvent.theId];
 
-        auto& myEvents =
-            myRow.theWrite ? myPeriod.theReadEvents : myPeriod.theWriteEvents;
-        myEvents.emplace_back(std::get<2>(res.first->second));
+    if (myLast.theEvents == 0) {
+      // first event of this app
+      myLast = Last{aEvent.theTimestamp, aEvent.theWrite, 1};
 
-        ret = std::max(ret, myDurations.size());
+    } else if (myLast.theWrite == aEvent.theWrite) {
+      // we are in the middle of a period of consecutive read/write operations
+      myLast.theEvents++;
 
-        std::get<0>(res.first->second) = myRow.theTimestamp;
-        std::get<1>(res.first->second) = myRow.theWrite;
-        std::get<2>(res.first->second) = 1;
-      }
+    } else {
+      // the read/write period just ended
+      auto& myPeriod = thePeriods[aEvent.theId];
+
+      auto& myDurations = aEvent.theWrite ? myPeriod.theReadDurations :
+                                            myPeriod.theWriteDurations;
+      myDurations.emplace_back(aEvent.theTimestamp - myLast.theTimestamp);
+
+      auto& myEvents =
+          aEvent.theWrite ? myPeriod.theReadEvents : myPeriod.theWriteEvents;
+      myEvents.emplace_back(myLast.theEvents);
+
+      theMaxValues = std::max(theMaxValues, myDurations.size());
+
+      myLast = Last{aEvent.theTimestamp, aEvent.theWrite, 1};
     }
   }
 
-  return ret;
-}
+  //! @return the periods of the apps found so far.
+  const Periods& periods() const noexcept {
+    return thePeriods;
+  }
+
+  //! @return the size of the largest vector of periods.
+  std::size_t maxValues() const noexcept {
+    return theMaxValues;
+  }
+
+ private:
+  //! The current period of an app.
+  struct Last {
+    double      theTimestamp = 0;     // last timestamp
+    bool        theWrite     = false; // last write flag
+    std::size_t theEvents    = 0;     // consecutive events, 0 if no event yet
+  };
+
+  Periods thePeriods;
+  // indexed by the dense ID of the key of the app
+  std::vector<Last> theLast;
+  std::size_t       theMaxValues;
+};
+
+void savePeriods(const Periods& aPeriods, us::FileWriter& aWriter) {
+  // save one value per line in a file with given prefix and counter
+  const auto mySave = [&aWriter](const std::string& aPrefix,
+                                 const std::size_t  aCounter,
+                                 const auto&        aValues) {
+    std::string myBuffer;
+    for (const auto& myValue : aValues) {
+      appendNumber(myBuffer, myValue);
+      myBuffer.push_back('\n');
+    }
+    aWriter.write(aPrefix + std::to_string(aCounter) + ".dat",
+                  std::move(myBuffer));
+  };
 
-void savePeriods(std::unordered_map<std::string, Period>& aPeriods,
-                 const boost::filesystem::path&           aOutputPath) {
   std::size_t myCounter = 0;
   for (const auto& myPeriod : aPeriods) {
-    myCounter++;
-    auto myRDStream = openFile(std::string("read-durations-") +
-                                   std::to_string(myCounter) + ".dat",
-                               aOutputPath);
-    auto myWDStream = openFile(std::string("write-durations-") +
-                                   std::to_string(myCounter) + ".dat",
-                               aOutputPath);
-    auto myREStream = openFile(std::string("read-events-") +
-                                   std::to_string(myCounter) + ".dat",
-                               aOutputPath);
-    auto myWEStream = openFile(std::string("write-events-") +
-                                   std::to_string(myCounter) + ".dat",
-                               aOutputPath);
-    for (const auto& myValue : myPeriod.second.theReadDurations) {
-      *myRDStream << myValue << '\n';
-    }
-    for (const auto& myValue : myPeriod.second.theWriteDurations) {
-      *myWDStream << myValue << '\n';
-    }
-    for (const auto& myValue : myPeriod.second.theReadEvents) {
-      *myREStream << myValue << '\n';
-    }
-    for (const auto& myValue : myPeriod.second.theWriteEvents) {
-      *myWEStream << myValue << '\n';
+    if (myPeriod.theReadDurations.empty() and
+        myPeriod.theWriteDurations.empty()) {
+      // no period has ended for this app
+      continue;
     }
+    myCounter++;
+    mySave("read-durations-", myCounter, myPeriod.theReadDurations);
+    mySave("write-durations-", myCounter, myPeriod.theWriteDurations);
+    mySave("read-events-", myCounter, myPeriod.theReadEvents);
+    mySave("write-events-", myCounter, myPeriod.theWriteEvents);
   }
 }
 
-void saveNumInvocations(const std::deque<ud::Row>&     aDataset,
-                        const boost::filesystem::path& aOutputPath) {
-  std::unordered_map<std::string, std::size_t> myNumInvocations;
-  for (const auto& myRow : aDataset) {
-    auto it = myNumInvocations.emplace(myRow.key(), 0);
-    it.first->second++;
+//! Count the invocations of the apps, one event at a time.
+class NumInvocationsAnalysis final
+{
+ public:
+  NumInvocationsAnalysis()
+      : theNumInvocations() {
+    // noop
   }
 
-  auto myStream = openFile("num-invocations.dat", aOutputPath);
-  for (const auto& elem : myNumInvocations) {
-    *myStream << elem.first << ',' << elem.second << '\n';
+  //! Add the next event.
+  void operator()(const Event& aEvent) {
+    if (aEvent.theId >= theNumInvocations.size()) {
+      theNumInvocations.resize(aEvent.theId + 1);
+    }
+    theNumInvocations[aEvent.theId]++;
   }
-}
+
+  /**
+   * @brief Save to file the number of invocations of the apps.
+   *
+   * @param aDictionary The dictionary of the dataset.
+   * @param aIndex The index of the keys of the apps.
+   * @param aWriter The writer of the output files.
+   */
+  void save(const ud::Dictionary& aDictionary,
+            const ud::KeyIndex&   aIndex,
+            us::FileWriter&       aWriter) const {
+    std::string myBuffer;
+    for (std::uint32_t i = 0; i < theNumInvocations.size(); i++) {
+      appendKey(myBuffer, aDictionary, aIndex.key(i));
+      myBuffer.push_back(',');
+      appendNumber(myBuffer, theNumInvocations[i]);
+      myBuffer.push_back('\n');
+    }
+    aWriter.write("num-invocations.dat", std::move(myBuffer));
+  }
+
+ private:
+  // indexed by the dense ID of the key of the app
+  std::vector<std::size_t> theNumInvocations;
+};
 
 int main(int argc, char* argv[]) {
   us::GlogRaii myGlogRaii(argv[0]);
 
-  std::string myDatasetFilename;
-  std::string myOutputDir;
-  std::string myAnalysis;
-  double      mySessionDuration;
+  std::string   myDatasetFilename;
+  std::string   myOutputDir;
+  std::string   myAnalysis;
+  double        mySessionDuration;
+  uint64_t      myConcurrentResolution;
+  std::size_t   myNumThreads;
+  std::size_t   myOutputThreads;
+  std::string   myOutputArchive;
+  std::string   myRegions;
+  std::string   myApps;
+  ud::RowFilter myFilter;
 
   po::options_description myDesc("Allowed options");
   // clang-format off
@@ -345,12 +543,40 @@ int main(int argc, char* argv[]) {
      "Output directory.")
     ("analysis",
      po::value<std::string>(&myAnalysis)->default_value("num-invocations"),
-     "Type of analysis, one of: {read-write-periods, num-invocations, lifecycles}.")
+     "Types of analysis, separated by commas, all done in a single pass over the dataset, among: {read-write-periods, num-invocations, lifecycles}.")
     ("singletons",
      "Also include functions called only once (used with lifecycles analysis).")
     ("session-duration",
      po::value<double>(&mySessionDuration)->default_value(60),
      "Duration of a session, in minutes, after the last event (used with lifecycles analysis).")
+    ("concurrent-resolution",
+     po::value<uint64_t>(&myConcurrentResolution)->default_value(0),
+     "If not zero, save the number of concurrent apps only every given interval, in ms, rather than at every change (used with lifecycles analysis).")
+    ("num-threads",
+     po::value<std::size_t>(&myNumThreads)->default_value(0),
+     "Number of threads used to load the dataset, 0 means all the hardware threads.")
+    ("output-threads",
+     po::value<std::size_t>(&myOutputThreads)->default_value(4),
+     "Number of threads used to write the output files.")
+    ("output-archive",
+     po::value<std::string>(&myOutputArchive)->default_value(""),
+     "If not empty, store all the output files in a single indexed archive with this name in the output directory, rather than as separate files.")
+    ("parallel-analyses",
+     "Run each analysis in a dedicated thread, each traversing the dataset loaded in memory, rather than all in the same traversal (ignored with --streaming).")
+    ("regions",
+     po::value<std::string>(&myRegions)->default_value(""),
+     "Comma-separated list of the regions whose events are loaded, all if empty.")
+    ("apps",
+     po::value<std::string>(&myApps)->default_value(""),
+     "Comma-separated list of the apps whose events are loaded, all if empty.")
+    ("begin-time",
+     po::value<double>(&myFilter.theBegin),
+     "Only load the events with a timestamp not smaller than this value, in ms.")
+    ("end-time",
+     po::value<double>(&myFilter.theEnd),
+     "Only load the events with a timestamp smaller than this value, in ms.")
+    ("streaming",
+     "Read the dataset one row at a time in a single thread, instead of loading it in memory, so that memory only grows with the number of apps, except with read-write-periods, which keeps all the periods and hence grows with the number of read/write switches in the dataset.")
     ;
   // clang-format on
 
@@ -369,40 +595,100 @@ int main(int argc, char* argv[]) {
       return EXIT_SUCCESS;
     }
 
+    myFilter.theRegions =
+        us::split<std::set<std::string, std::less<>>>(myRegions, ",");
+    myFilter.theApps =
+        us::split<std::set<std::string, std::less<>>>(myApps, ",");
+
     if (not boost::filesystem::is_directory(myOutputDir)) {
       throw std::runtime_error("Output directory does not exist: " +
                                myOutputDir);
     }
 
-    VLOG(1) << "reading from: " << myDatasetFilename;
-    std::ifstream myDatasetStream(myDatasetFilename);
-    if (not myDatasetStream) {
-      throw std::runtime_error("could not open dataset file for reading: " +
-                               myDatasetFilename);
+    // create the analyses requested, each at most once
+    std::optional<ReadWritePeriodsAnalysis> myPeriods;
+    std::optional<NumInvocationsAnalysis>   myNumInvocations;
+    std::optional<LifecyclesAnalysis>       myLifecycles;
+    for (const auto& myName :
+         us::split<std::vector<std::string>>(myAnalysis, ",")) {
+      if (myName == "read-write-periods") {
+        myPeriods.emplace();
+      } else if (myName == "num-invocations") {
+        myNumInvocations.emplace();
+      } else if (myName == "lifecycles") {
+        myLifecycles.emplace(mySessionDuration);
+      } else {
+        throw std::runtime_error("Invalid type of analysis: " + myName);
+      }
     }
-    auto myDataset = ud::loadDataset(myDatasetStream, true);
-
-    VLOG(1) << "analyzing dataset";
-    if (myAnalysis == "read-write-periods") {
-      std::unordered_map<std::string, Period> myPeriods;
-      [[maybe_unused]] const auto             myMaxValues =
-          readWritePeriods(myDataset, myPeriods);
-
-      VLOG(1) << "writing output";
-      savePeriods(myPeriods, myOutputDir);
-
-    } else if (myAnalysis == "num-invocations") {
-      saveNumInvocations(myDataset, myOutputDir);
+    const auto myForEachAnalysis = [&](auto&& aFunctor) {
+      if (myPeriods.has_value()) {
+        aFunctor(*myPeriods);
+      }
+      if (myNumInvocations.has_value()) {
+        aFunctor(*myNumInvocations);
+      }
+      if (myLifecycles.has_value()) {
+        aFunctor(*myLifecycles);
+      }
+    };
+    const auto myAllAnalyses = [&](const Event& aEvent) {
+      myForEachAnalysis([&aEvent](auto& aAnalysis) { aAnalysis(aEvent); });
+    };
 
-    } else if (myAnalysis == "lifecycles") {
-      Lifecycles myLifecycles;
-      lifecycles(myDataset, myLifecycles, mySessionDuration);
-      saveLifecycles(
-          myLifecycles, myOutputDir, myVarMap.count("singletons") > 0);
+    // feed all the events of the dataset to the analyses
+    ud::Dictionary myDictionary;
+    ud::KeyIndex   myIndex;
+    VLOG(1) << "reading from: " << myDatasetFilename;
+    if (myVarMap.count("streaming") > 0) {
+      ud::RowReader myReader(myDatasetFilename, true, myFilter);
+      forEachEvent(myReader, myDictionary, myIndex, myAllAnalyses);
 
     } else {
-      throw std::runtime_error("Invalid type of analysis: " + myAnalysis);
+      const auto myDataset = ud::loadColumns(
+          myDatasetFilename, true, myDictionary, myNumThreads, myFilter);
+      const auto myIds = ud::keyIds(myDataset, myIndex);
+      VLOG(1) << "analyzing dataset";
+      if (myVarMap.count("parallel-analyses") > 0) {
+        // each analysis traverses the dataset in a dedicated thread
+        std::vector<std::future<void>> myTasks;
+        myForEachAnalysis([&](auto& aAnalysis) {
+          myTasks.emplace_back(std::async(std::launch::async, [&]() {
+            forEachEvent(myDataset, myIds, aAnalysis);
+          }));
+        });
+        for (auto& myTask : myTasks) {
+          myTask.get();
+        }
+      } else {
+        forEachEvent(myDataset, myIds, myAllAnalyses);
+      }
+    }
+
+    VLOG(1) << "writing output";
+    const auto     myArchive = not myOutputArchive.empty();
+    us::FileWriter myWriter(
+        myArchive ? (boost::filesystem::path(myOutputDir) / myOutputArchive)
+                        .string() :
+                    myOutputDir,
+        myArchive ? us::FileWriter::Mode::Archive :
+                    us::FileWriter::Mode::Directory,
+        std::max<std::size_t>(1, myOutputThreads));
+    if (myPeriods.has_value()) {
+      savePeriods(myPeriods->periods(), myWriter);
+    }
+    if (myNumInvocations.has_value()) {
+      myNumInvocations->save(myDictionary, myIndex, myWriter);
+    }
+    if (myLifecycles.has_value()) {
+      saveLifecycles(myLifecycles->lifecycles(),
+                     myDictionary,
+                     myIndex,
+                     myWriter,
+                     myVarMap.count("singletons") > 0,
+                     myConcurrentResolution);
     }
+    myWriter.close();
 
     VLOG(1) << "done";
 
@@ -0,0 +1,107 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace uiiit {
+namespace support {
+namespace detail {
+
+/**
+ * @brief Split the range [0, aSize) into contiguous chunks, reduce each of
+ * them in a dedicated thread, then combine the partial results in order.
+ *
+ * @param aSize The number of elements.
+ * @param aNumThreads The maximum number of threads, 0 means as many as the
+ * hardware concurrency.
+ * @param aMinChunk The minimum number of elements per chunk.
+ * @param aInit The initial value of the reduction.
+ * @param aReduce A functor (std::size_t from, std::size_t to) -> T returning
+ * the reduction of a chunk.
+ * @param aCombine A functor (T, T) -> T combining two partial results.
+ * @return the combined result.
+ *
+ * @throw the first exception thrown by aReduce, if any.
+ */
+template <typename T, typename REDUCE, typename COMBINE>
+T parallelReduce(const std::size_t aSize,
+                 std::size_t       aNumThreads,
+                 const std::size_t aMinChunk,
+                 const T&          aInit,
+                 REDUCE&&          aReduce,
+                 COMBINE&&         aCombine) {
+  if (aNumThreads == 0) {
+    aNumThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  aNumThreads =
+      std::min(aNumThreads, aSize / std::max<std::size_t>(1, aMinChunk));
+  if (aNumThreads <= 1) {
+    return aCombine(aInit, aReduce(std::size_t(0), aSize));
+  }
+
+  std::vector<T>                  myPartials(aNumThreads, aInit);
+  std::vector<std::exception_ptr> myErrors(aNumThreads);
+  std::vector<std::thread>        myThreads;
+  myThreads.reserve(aNumThreads);
+  for (std::size_t i = 0; i < aNumThreads; i++) {
+    myThreads.emplace_back([&, i]() {
+      try {
+        myPartials[i] =
+            aReduce(i * aSize / aNumThreads, (i + 1) * aSize / aNumThreads);
+      } catch (...) {
+        myErrors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto& myThread : myThreads) {
+    myThread.join();
+  }
+  for (const auto& myError : myErrors) {
+    if (myError) {
+      std::rethrow_exception(myError);
+    }
+  }
+
+  T ret = aInit;
+  for (const auto& myPartial : myPartials) {
+    ret = aCombine(ret, myPartial);
+  }
+  return ret;
+}
+
+} // namespace detail
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,193 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/batchrandom.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+namespace uiiit {
+namespace support {
+
+Xoshiro256pp::Xoshiro256pp(const std::size_t a,
+                           const std::size_t b,
+                           const std::size_t c) noexcept
+    : theState() {
+  std::uint64_t myMix = a;
+  myMix               = detail::splitMix64(myMix) ^ b;
+  myMix               = detail::splitMix64(myMix) ^ c;
+  for (auto& myWord : theState) {
+    myWord = detail::splitMix64(myMix);
+  }
+}
+
+void Xoshiro256pp::jump() noexcept {
+  static const std::array<std::uint64_t, 4> myPolynomial({
+      0x180ec6d33cfd0abaull,
+      0xd5a61266f0c9392cull,
+      0xa9582618e03fc9aaull,
+      0x39abdc4529b1661cull,
+  });
+  jump(myPolynomial);
+}
+
+void Xoshiro256pp::longJump() noexcept {
+  static const std::array<std::uint64_t, 4> myPolynomial({
+      0x76e15d3efefdcbbfull,
+      0xc5004e441c522fb3ull,
+      0x77710069854ee241ull,
+      0x39109bb02acbe635ull,
+  });
+  jump(myPolynomial);
+}
+
+void Xoshiro256pp::jump(
+    const std::array<std::uint64_t, 4>& aPolynomial) noexcept {
+  std::array<std::uint64_t, 4> myState({0, 0, 0, 0});
+  for (const auto& myWord : aPolynomial) {
+    for (auto b = 0; b < 64; b++) {
+      if (myWord & (std::uint64_t(1) << b)) {
+        for (std::size_t i = 0; i < myState.size(); i++) {
+          myState[i] ^= theState[i];
+        }
+      }
+      (*this)();
+    }
+  }
+  theState = myState;
+}
+
+Xoshiro256ppX4::Xoshiro256ppX4(const std::size_t a,
+                               const std::size_t b,
+                               const std::size_t c) noexcept {
+  Xoshiro256pp myGenerator(a, b, c);
+  for (std::size_t i = 0; i < theLanes; i++) {
+    const auto& myState = myGenerator.state();
+    theS0[i]            = myState[0];
+    theS1[i]            = myState[1];
+    theS2[i]            = myState[2];
+    theS3[i]            = myState[3];
+    myGenerator.jump();
+  }
+}
+
+void Xoshiro256ppX4::fillUnit(double*           aData,
+                              const std::size_t aSize) noexcept {
+  assert(aSize % theLanes == 0);
+  alignas(32) std::uint64_t myOut[theLanes];
+  for (std::size_t i = 0; i < aSize; i += theLanes) {
+    next(myOut);
+    for (std::size_t j = 0; j < theLanes; j++) {
+      aData[i + j] = detail::toUnitDouble(myOut[j]);
+    }
+  }
+}
+
+BatchRv::BatchRv(const std::size_t a, const std::size_t b, const std::size_t c)
+    : theGenerator(a, b, c)
+    , theBuffer()
+    , theNext(theBuffer.size()) {
+  // noop
+}
+
+double BatchRv::operator()() {
+  if (theNext == theBuffer.size()) {
+    theGenerator.fillUnit(theBuffer.data(), theBuffer.size());
+    transform(theBuffer.data(), theBuffer.size());
+    theNext = 0;
+  }
+  return theBuffer[theNext++];
+}
+
+void BatchRv::fill(double* aData, const std::size_t aSize) {
+  // consume the values left in the buffer from previous single draws
+  std::size_t myDone = std::min(aSize, theBuffer.size() - theNext);
+  std::copy_n(theBuffer.data() + theNext, myDone, aData);
+  theNext += myDone;
+
+  // draw full blocks directly into the output
+  const auto myBlocks =
+      (aSize - myDone) - (aSize - myDone) % Xoshiro256ppX4::theLanes;
+  theGenerator.fillUnit(aData + myDone, myBlocks);
+  transform(aData + myDone, myBlocks);
+  myDone += myBlocks;
+
+  // serve the remainder from a new buffer
+  for (; myDone < aSize; myDone++) {
+    aData[myDone] = (*this)();
+  }
+}
+
+BatchUniformRv::BatchUniformRv(const double      aMin,
+                               const double      aMax,
+                               const std::size_t a,
+                               const std::size_t b,
+                               const std::size_t c)
+    : BatchRv(a, b, c)
+    , theMin(aMin)
+    , theSpan(aMax - aMin) {
+  if (aMin > aMax) {
+    throw std::runtime_error("Invalid range for BatchUniformRv: [" +
+                             std::to_string(aMin) + ":" + std::to_string(aMax) +
+                             "]");
+  }
+}
+
+void BatchUniformRv::transform(double*           aData,
+                               const std::size_t aSize) const {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = theMin + theSpan * aData[i];
+  }
+}
+
+BatchExponentialRv::BatchExponentialRv(const double      aLambda,
+                                       const std::size_t a,
+                                       const std::size_t b,
+                                       const std::size_t c)
+    : BatchRv(a, b, c)
+    , theMean(1 / aLambda) {
+  if (not(aLambda > 0)) {
+    throw std::runtime_error("Invalid rate for BatchExponentialRv: " +
+                             std::to_string(aLambda));
+  }
+}
+
+void BatchExponentialRv::transform(double*           aData,
+                                   const std::size_t aSize) const {
+  // 1 - u is in (0, 1], hence the logarithm is always finite
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = -theMean * detail::fastLog(1.0 - aData[i]);
+  }
+}
+
+} // namespace support
+} // namespace uiiit
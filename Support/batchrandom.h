@@ -0,0 +1,273 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Support/random.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace uiiit {
+namespace support {
+
+namespace detail {
+
+//! SplitMix64 step, used to expand seeds into generator states.
+inline std::uint64_t splitMix64(std::uint64_t& aState) noexcept {
+  auto z = (aState += 0x9e3779b97f4a7c15ull);
+  z      = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z      = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+inline std::uint64_t rotl(const std::uint64_t aValue,
+                          const int           aBits) noexcept {
+  return (aValue << aBits) | (aValue >> (64 - aBits));
+}
+
+//! @return a double in [0, 1) from the 53 most significant bits.
+inline double toUnitDouble(const std::uint64_t aValue) noexcept {
+  return static_cast<double>(aValue >> 11) * 0x1.0p-53;
+}
+
+/**
+ * @brief Natural logarithm without branches, hence vectorizable.
+ *
+ * The argument is split into 2^e * m, with m in [sqrt(2)/2, sqrt(2)), then
+ * log(m) is computed with the series 2 atanh((m-1)/(m+1)), truncated so that
+ * the relative error is within a few ULPs.
+ *
+ * @pre aValue is a positive normal number.
+ */
+inline double fastLog(const double aValue) noexcept {
+  std::uint64_t myBits;
+  std::memcpy(&myBits, &aValue, sizeof(myBits));
+  auto myExp = static_cast<std::int64_t>((myBits >> 52) & 0x7ff) - 1023;
+  myBits     = (myBits & 0x000fffffffffffffull) | 0x3ff0000000000000ull;
+  double myMantissa;
+  std::memcpy(&myMantissa, &myBits, sizeof(myMantissa));
+  const auto myLarge = myMantissa > 1.4142135623730951;
+  myMantissa *= myLarge ? 0.5 : 1.0;
+  myExp += myLarge ? 1 : 0;
+
+  const auto s = (myMantissa - 1) / (myMantissa + 1);
+  const auto z = s * s;
+  // clang-format off
+  const auto myPoly =
+      1.0 + z * (1.0 / 3 + z * (1.0 / 5 + z * (1.0 / 7 + z * (1.0 / 9 +
+      z * (1.0 / 11 + z * (1.0 / 13 + z * (1.0 / 15 + z * (1.0 / 17 +
+      z * (1.0 / 19)))))))));
+  // clang-format on
+  return myExp * 0.6931471805599453 + 2 * s * myPoly;
+}
+
+} // namespace detail
+
+/**
+ * @brief The xoshiro256++ pseudo-random number generator by D. Blackman and
+ * S. Vigna, which satisfies the UniformRandomBitGenerator requirements.
+ *
+ * https://prng.di.unimi.it/
+ *
+ * It has a 256-bit state, a period of 2^256 - 1 and supports jumping ahead
+ * by 2^128 or 2^192 steps to obtain non-overlapping streams.
+ */
+class Xoshiro256pp final
+{
+ public:
+  using result_type = std::uint64_t;
+
+  //! Seed the state from three numbers, same semantics as GenericRv.
+  explicit Xoshiro256pp(const std::size_t a,
+                        const std::size_t b,
+                        const std::size_t c) noexcept;
+
+  static constexpr result_type min() noexcept {
+    return std::numeric_limits<result_type>::min();
+  }
+
+  static constexpr result_type max() noexcept {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  //! @return the next 64-bit value.
+  result_type operator()() noexcept {
+    const auto ret = detail::rotl(theState[0] + theState[3], 23) + theState[0];
+    const auto t   = theState[1] << 17;
+    theState[2] ^= theState[0];
+    theState[3] ^= theState[1];
+    theState[1] ^= theState[2];
+    theState[0] ^= theState[3];
+    theState[2] ^= t;
+    theState[3] = detail::rotl(theState[3], 45);
+    return ret;
+  }
+
+  //! Advance the state by 2^128 steps.
+  void jump() noexcept;
+
+  //! Advance the state by 2^192 steps.
+  void longJump() noexcept;
+
+  //! @return the current state.
+  const std::array<std::uint64_t, 4>& state() const noexcept {
+    return theState;
+  }
+
+ private:
+  void jump(const std::array<std::uint64_t, 4>& aPolynomial) noexcept;
+
+ private:
+  std::array<std::uint64_t, 4> theState;
+};
+
+/**
+ * @brief Four xoshiro256++ generators, 2^128 steps apart from one another,
+ * advanced together in a structure-of-arrays layout so that the compiler can
+ * map the lanes onto SIMD registers.
+ *
+ * The i-th output of the sequence is produced by lane i mod 4, hence the
+ * sequence only depends on the seed.
+ */
+class Xoshiro256ppX4 final
+{
+ public:
+  static constexpr std::size_t theLanes = 4;
+
+  explicit Xoshiro256ppX4(const std::size_t a,
+                          const std::size_t b,
+                          const std::size_t c) noexcept;
+
+  //! Produce the next value for each lane.
+  void next(std::uint64_t* aOut) noexcept {
+    for (std::size_t i = 0; i < theLanes; i++) {
+      aOut[i] = detail::rotl(theS0[i] + theS3[i], 23) + theS0[i];
+    }
+    for (std::size_t i = 0; i < theLanes; i++) {
+      const auto t = theS1[i] << 17;
+      theS2[i] ^= theS0[i];
+      theS3[i] ^= theS1[i];
+      theS1[i] ^= theS2[i];
+      theS0[i] ^= theS3[i];
+      theS2[i] ^= t;
+      theS3[i] = detail::rotl(theS3[i], 45);
+    }
+  }
+
+  /**
+   * @brief Fill a buffer with uniformly distributed values in [0, 1).
+   *
+   * @pre aSize is a multiple of theLanes.
+   */
+  void fillUnit(double* aData, const std::size_t aSize) noexcept;
+
+ private:
+  alignas(32) std::uint64_t theS0[theLanes];
+  alignas(32) std::uint64_t theS1[theLanes];
+  alignas(32) std::uint64_t theS2[theLanes];
+  alignas(32) std::uint64_t theS3[theLanes];
+};
+
+/**
+ * @brief Base class of r.v.'s that transform a batch of uniform values in
+ * [0, 1) produced by Xoshiro256ppX4.
+ *
+ * Single draws are served from a small buffer, so that the sequence of values
+ * does not depend on how it is split between operator() and fill().
+ */
+class BatchRv : public RealRvInterface
+{
+  NONCOPYABLE_NONMOVABLE(BatchRv);
+
+ public:
+  double operator()() override;
+  void   fill(double* aData, const std::size_t aSize) override;
+
+ protected:
+  explicit BatchRv(const std::size_t a,
+                   const std::size_t b,
+                   const std::size_t c);
+
+  //! Transform in place uniform values in [0, 1) into the target r.v.
+  virtual void transform(double* aData, const std::size_t aSize) const = 0;
+
+ private:
+  Xoshiro256ppX4                               theGenerator;
+  std::array<double, Xoshiro256ppX4::theLanes> theBuffer;
+  std::size_t                                  theNext;
+};
+
+//! Uniform r.v. in [aMin, aMax) drawn from Xoshiro256ppX4.
+class BatchUniformRv final : public BatchRv
+{
+ public:
+  /**
+   * @throw std::runtime_error if aMin > aMax.
+   */
+  explicit BatchUniformRv(const double      aMin,
+                          const double      aMax,
+                          const std::size_t a,
+                          const std::size_t b,
+                          const std::size_t c);
+
+ private:
+  void transform(double* aData, const std::size_t aSize) const override;
+
+ private:
+  const double theMin;
+  const double theSpan;
+};
+
+//! Exponential r.v. with rate aLambda drawn from Xoshiro256ppX4, with a
+//! vectorizable inverse cumulative distribution function.
+class BatchExponentialRv final : public BatchRv
+{
+ public:
+  /**
+   * @throw std::runtime_error if aLambda is not positive.
+   */
+  explicit BatchExponentialRv(const double      aLambda,
+                              const std::size_t a,
+                              const std::size_t b,
+                              const std::size_t c);
+
+ private:
+  void transform(double* aData, const std::size_t aSize) const override;
+
+ private:
+  const double theMean;
+};
+
+} // namespace support
+} // namespace uiiit
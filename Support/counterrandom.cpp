@@ -0,0 +1,181 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/counterrandom.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace uiiit {
+namespace support {
+
+namespace detail {
+
+std::array<std::uint32_t, 4>
+philox4x32(std::array<std::uint32_t, 4> aCounter,
+           std::array<std::uint32_t, 2> aKey) noexcept {
+  static constexpr std::uint64_t M0 = 0xd2511f53;
+  static constexpr std::uint64_t M1 = 0xcd9e8d57;
+  static constexpr std::uint32_t W0 = 0x9e3779b9;
+  static constexpr std::uint32_t W1 = 0xbb67ae85;
+
+  for (auto r = 0; r < 10; r++) {
+    if (r > 0) {
+      aKey[0] += W0;
+      aKey[1] += W1;
+    }
+    const auto myProd0 = M0 * aCounter[0];
+    const auto myProd1 = M1 * aCounter[2];
+    aCounter           = {
+        static_cast<std::uint32_t>(myProd1 >> 32) ^ aCounter[1] ^ aKey[0],
+        static_cast<std::uint32_t>(myProd1),
+        static_cast<std::uint32_t>(myProd0 >> 32) ^ aCounter[3] ^ aKey[1],
+        static_cast<std::uint32_t>(myProd0)};
+  }
+  return aCounter;
+}
+
+} // namespace detail
+
+Philox4x32::Philox4x32(const std::size_t a,
+                       const std::size_t b,
+                       const std::size_t c) noexcept
+    : theKey()
+    , theStream(0)
+    , theIndex(0) {
+  std::uint64_t myMix = a;
+  myMix               = detail::splitMix64(myMix) ^ b;
+  myMix               = detail::splitMix64(myMix) ^ c;
+  const auto myKey    = detail::splitMix64(myMix);
+  theKey[0]           = static_cast<std::uint32_t>(myKey);
+  theKey[1]           = static_cast<std::uint32_t>(myKey >> 32);
+  theStream           = detail::splitMix64(myMix);
+}
+
+std::array<std::uint64_t, 2>
+Philox4x32::block(const std::uint64_t aBlock) const noexcept {
+  const auto myOut = detail::philox4x32(
+      {static_cast<std::uint32_t>(aBlock),
+       static_cast<std::uint32_t>(aBlock >> 32),
+       static_cast<std::uint32_t>(theStream),
+       static_cast<std::uint32_t>(theStream >> 32)},
+      theKey);
+  return {(std::uint64_t(myOut[1]) << 32) | myOut[0],
+          (std::uint64_t(myOut[3]) << 32) | myOut[2]};
+}
+
+CounterRv::CounterRv(const std::size_t a,
+                     const std::size_t b,
+                     const std::size_t c)
+    : RealRvInterface()
+    , theGenerator(a, b, c) {
+  // noop
+}
+
+double CounterRv::operator()() {
+  auto ret = detail::toUnitDouble(theGenerator());
+  transform(&ret, 1);
+  return ret;
+}
+
+void CounterRv::fill(double* aData, const std::size_t aSize) {
+  auto        myIndex = theGenerator.index();
+  std::size_t myDone  = 0;
+
+  // align to the beginning of a block
+  if (aSize > 0 and myIndex % 2 == 1) {
+    aData[myDone++] = detail::toUnitDouble(theGenerator.at(myIndex++));
+  }
+
+  // use both the values of every block
+  for (; myDone + 2 <= aSize; myDone += 2, myIndex += 2) {
+    const auto myBlock = theGenerator.block(myIndex / 2);
+    aData[myDone]      = detail::toUnitDouble(myBlock[0]);
+    aData[myDone + 1]  = detail::toUnitDouble(myBlock[1]);
+  }
+
+  if (myDone < aSize) {
+    aData[myDone++] = detail::toUnitDouble(theGenerator.at(myIndex++));
+  }
+
+  theGenerator.seek(myIndex);
+  transform(aData, aSize);
+}
+
+double CounterRv::at(const std::uint64_t aIndex) const {
+  auto ret = detail::toUnitDouble(theGenerator.at(aIndex));
+  transform(&ret, 1);
+  return ret;
+}
+
+CounterUniformRv::CounterUniformRv(const double      aMin,
+                                   const double      aMax,
+                                   const std::size_t a,
+                                   const std::size_t b,
+                                   const std::size_t c)
+    : CounterRv(a, b, c)
+    , theMin(aMin)
+    , theSpan(aMax - aMin) {
+  if (aMin > aMax) {
+    throw std::runtime_error("Invalid range for CounterUniformRv: [" +
+                             std::to_string(aMin) + ":" + std::to_string(aMax) +
+                             "]");
+  }
+}
+
+void CounterUniformRv::transform(double*           aData,
+                                 const std::size_t aSize) const {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = theMin + theSpan * aData[i];
+  }
+}
+
+CounterExponentialRv::CounterExponentialRv(const double      aLambda,
+                                           const std::size_t a,
+                                           const std::size_t b,
+                                           const std::size_t c)
+    : CounterRv(a, b, c)
+    , theMean(1 / aLambda) {
+  if (not(aLambda > 0)) {
+    throw std::runtime_error("Invalid rate for CounterExponentialRv: " +
+                             std::to_string(aLambda));
+  }
+}
+
+void CounterExponentialRv::transform(double*           aData,
+                                     const std::size_t aSize) const {
+  // 1 - u is in (0, 1], hence the logarithm is always finite
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = -theMean * detail::fastLog(1.0 - aData[i]);
+  }
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,423 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/distributions.h"
+
+#include "Support/split.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace uiiit {
+namespace support {
+
+namespace detail {
+
+double inverseNormalCdf(const double aProb) {
+  static const double a[] = {-3.969683028665376e+01,
+                             2.209460984245205e+02,
+                             -2.759285104469687e+02,
+                             1.383577518672690e+02,
+                             -3.066479806614716e+01,
+                             2.506628277459239e+00};
+  static const double b[] = {-5.447609879822406e+01,
+                             1.615858368580409e+02,
+                             -1.556989798598866e+02,
+                             6.680131188771972e+01,
+                             -1.328068155288572e+01};
+  static const double c[] = {-7.784894002430293e-03,
+                             -3.223964580411365e-01,
+                             -2.400758277161838e+00,
+                             -2.549732539343734e+00,
+                             4.374664141464968e+00,
+                             2.938163982698783e+00};
+  static const double d[] = {7.784695709041462e-03,
+                             3.224671290700398e-01,
+                             2.445134137142996e+00,
+                             3.754408661907416e+00};
+  static const double myLow = 0.02425;
+
+  assert(aProb > 0 and aProb < 1);
+
+  double x;
+  if (aProb < myLow or aProb > (1 - myLow)) {
+    const auto q = std::sqrt(-2 * std::log(std::min(aProb, 1 - aProb)));
+    x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    if (aProb > myLow) {
+      x = -x;
+    }
+  } else {
+    const auto q = aProb - 0.5;
+    const auto r = q * q;
+    x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) *
+        q /
+        (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+  }
+
+  // refinement with Halley's rational method
+  const auto e = 0.5 * std::erfc(-x / std::sqrt(2.0)) - aProb;
+  const auto u = e * std::sqrt(2 * M_PI) * std::exp(x * x / 2);
+  return x - u / (1 + x * u / 2);
+}
+
+} // namespace detail
+
+AliasTable::AliasTable(const std::vector<double>& aWeights)
+    : theProbs(aWeights.size(), 0.0)
+    , theAliases(aWeights.size(), 0) {
+  if (aWeights.empty()) {
+    throw std::runtime_error("Cannot build an alias table without weights");
+  }
+  double mySum = 0;
+  for (const auto& myWeight : aWeights) {
+    if (not std::isfinite(myWeight) or myWeight < 0) {
+      throw std::runtime_error("Invalid weight in alias table: " +
+                               std::to_string(myWeight));
+    }
+    mySum += myWeight;
+  }
+  if (not(mySum > 0)) {
+    throw std::runtime_error("Invalid alias table with all zero weights");
+  }
+
+  const auto               N = aWeights.size();
+  std::vector<std::size_t> mySmall;
+  std::vector<std::size_t> myLarge;
+  for (std::size_t i = 0; i < N; i++) {
+    theProbs[i] = aWeights[i] * N / mySum;
+    (theProbs[i] < 1 ? mySmall : myLarge).emplace_back(i);
+  }
+  while (not mySmall.empty() and not myLarge.empty()) {
+    const auto s = mySmall.back();
+    const auto l = myLarge.back();
+    mySmall.pop_back();
+    theAliases[s] = l;
+    theProbs[l] -= 1 - theProbs[s];
+    if (theProbs[l] < 1) {
+      myLarge.pop_back();
+      mySmall.emplace_back(l);
+    }
+  }
+  // the remaining elements are full, up to rounding errors
+  for (const auto i : mySmall) {
+    theProbs[i] = 1;
+  }
+  for (const auto i : myLarge) {
+    theProbs[i] = 1;
+  }
+}
+
+std::size_t AliasTable::operator()(const double aUnit,
+                                   double&      aFrac) const noexcept {
+  const auto myPos = aUnit * theProbs.size();
+  const auto myNdx =
+      std::min(static_cast<std::size_t>(myPos), theProbs.size() - 1);
+  const auto myFrac = std::min(myPos - myNdx, 1.0);
+  const auto myProb = theProbs[myNdx];
+  if (myFrac < myProb) {
+    aFrac = myFrac / myProb;
+    return myNdx;
+  }
+  aFrac = (myFrac - myProb) / (1 - myProb);
+  return theAliases[myNdx];
+}
+
+QuantileTable::QuantileTable(const std::function<double(double)>& aLower,
+                             const std::function<double(double)>& aUpper)
+    : theLower(theOctaves * theStride)
+    , theUpper(theOctaves * theStride) {
+  fill(theLower, aLower);
+  fill(theUpper, aUpper);
+}
+
+std::shared_ptr<const QuantileTable>
+QuantileTable::shared(const std::string&                   aName,
+                      const std::vector<double>&           aParams,
+                      const std::function<double(double)>& aLower,
+                      const std::function<double(double)>& aUpper) {
+  using Key = std::pair<std::string, std::vector<double>>;
+  static std::mutex                                        myMutex;
+  static std::map<Key, std::weak_ptr<const QuantileTable>> myTables;
+
+  const std::lock_guard<std::mutex> myLock(myMutex);
+  const Key                         myKey(aName, aParams);
+  const auto                        it = myTables.find(myKey);
+  if (it != myTables.end()) {
+    if (auto ret = it->second.lock()) {
+      return ret;
+    }
+  }
+
+  // the tables are released with the last r.v. using them
+  for (auto jt = myTables.begin(); jt != myTables.end();) {
+    jt = jt->second.expired() ? myTables.erase(jt) : std::next(jt);
+  }
+  auto ret        = std::make_shared<const QuantileTable>(aLower, aUpper);
+  myTables[myKey] = ret;
+  return ret;
+}
+
+double QuantileTable::operator()(const double aUnit) const noexcept {
+  return aUnit < 0.5 ? lookup(theLower, aUnit) : lookup(theUpper, 1 - aUnit);
+}
+
+void QuantileTable::fill(std::vector<double>&                 aTable,
+                         const std::function<double(double)>& aQuantile) {
+  for (std::size_t o = 0; o < theOctaves; o++) {
+    const auto myBase = std::ldexp(1.0, -static_cast<int>(o) - 1);
+    for (std::size_t c = 0; c < theStride; c++) {
+      const auto myDistance =
+          std::min(0.5, myBase * (1 + static_cast<double>(c) / theCells));
+      aTable[o * theStride + c] = aQuantile(myDistance);
+    }
+  }
+}
+
+double QuantileTable::lookup(const std::vector<double>& aTable,
+                             const double aDistance) const noexcept {
+  assert(aDistance >= 0 and aDistance <= 0.5);
+
+  // the smallest cell also includes the values below it, down to zero
+  const auto myDistance =
+      std::max(aDistance, std::ldexp(1.0, -static_cast<int>(theOctaves)));
+  std::uint64_t myBits;
+  std::memcpy(&myBits, &myDistance, sizeof(myBits));
+  const auto myOctave = 1022 - static_cast<std::int64_t>(myBits >> 52);
+  assert(myOctave >= 0 and myOctave < static_cast<std::int64_t>(theOctaves));
+  const auto myCell = (myBits >> (52 - theCellBits)) & (theCells - 1);
+  const auto myFrac =
+      static_cast<double>(myBits & ((std::uint64_t(1) << (52 - theCellBits)) -
+                                    1)) *
+      std::ldexp(1.0, -static_cast<int>(52 - theCellBits));
+
+  const auto myNdx = myOctave * theStride + myCell;
+  return aTable[myNdx] + (aTable[myNdx + 1] - aTable[myNdx]) * myFrac;
+}
+
+ParetoRv::ParetoRv(const double      aScale,
+                   const double      aShape,
+                   const std::size_t a,
+                   const std::size_t b,
+                   const std::size_t c)
+    : BatchRv(a, b, c)
+    , theTable() {
+  if (not(aScale > 0) or not(aShape > 0)) {
+    throw std::runtime_error("Invalid parameters for ParetoRv: scale " +
+                             std::to_string(aScale) + ", shape " +
+                             std::to_string(aShape));
+  }
+  theTable = QuantileTable::shared(
+      "Par",
+      {aScale, aShape},
+      [aScale, aShape](const double u) {
+        return aScale * std::exp(-std::log1p(-u) / aShape);
+      },
+      [aScale, aShape](const double v) {
+        return aScale * std::pow(v, -1 / aShape);
+      });
+}
+
+void ParetoRv::transform(double* aData, const std::size_t aSize) const {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = (*theTable)(aData[i]);
+  }
+}
+
+LogNormalRv::LogNormalRv(const double      aMu,
+                         const double      aSigma,
+                         const std::size_t a,
+                         const std::size_t b,
+                         const std::size_t c)
+    : BatchRv(a, b, c)
+    , theTable() {
+  if (not std::isfinite(aMu)) {
+    throw std::runtime_error("Invalid mu for LogNormalRv: " +
+                             std::to_string(aMu));
+  }
+  if (not(aSigma > 0)) {
+    throw std::runtime_error("Invalid sigma for LogNormalRv: " +
+                             std::to_string(aSigma));
+  }
+  theTable = QuantileTable::shared(
+      "LogN",
+      {aMu, aSigma},
+      [aMu, aSigma](const double u) {
+        return std::exp(aMu + aSigma * detail::inverseNormalCdf(u));
+      },
+      [aMu, aSigma](const double v) {
+        return std::exp(aMu - aSigma * detail::inverseNormalCdf(v));
+      });
+}
+
+void LogNormalRv::transform(double* aData, const std::size_t aSize) const {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = (*theTable)(aData[i]);
+  }
+}
+
+WeibullRv::WeibullRv(const double      aShape,
+                     const double      aScale,
+                     const std::size_t a,
+                     const std::size_t b,
+                     const std::size_t c)
+    : BatchRv(a, b, c)
+    , theTable() {
+  if (not(aShape > 0) or not(aScale > 0)) {
+    throw std::runtime_error("Invalid parameters for WeibullRv: shape " +
+                             std::to_string(aShape) + ", scale " +
+                             std::to_string(aScale));
+  }
+  theTable = QuantileTable::shared(
+      "Weib",
+      {aShape, aScale},
+      [aShape, aScale](const double u) {
+        return aScale * std::pow(-std::log1p(-u), 1 / aShape);
+      },
+      [aShape, aScale](const double v) {
+        return aScale * std::pow(-std::log(v), 1 / aShape);
+      });
+}
+
+void WeibullRv::transform(double* aData, const std::size_t aSize) const {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = (*theTable)(aData[i]);
+  }
+}
+
+DiscreteRv::DiscreteRv(const std::vector<std::pair<double, double>>& aValues,
+                       const std::size_t                             a,
+                       const std::size_t                             b,
+                       const std::size_t                             c)
+    : BatchRv(a, b, c)
+    , theValues()
+    , theTable(weights(aValues)) {
+  for (const auto& myValue : aValues) {
+    theValues.emplace_back(myValue.first);
+  }
+}
+
+void DiscreteRv::transform(double* aData, const std::size_t aSize) const {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = theValues[theTable(aData[i])];
+  }
+}
+
+std::vector<double>
+DiscreteRv::weights(const std::vector<std::pair<double, double>>& aValues) {
+  std::vector<double> ret;
+  for (const auto& myValue : aValues) {
+    ret.emplace_back(myValue.second);
+  }
+  return ret;
+}
+
+EmpiricalRv::EmpiricalRv(const std::vector<std::pair<double, double>>& aCdf,
+                         const std::size_t                             a,
+                         const std::size_t                             b,
+                         const std::size_t                             c)
+    : BatchRv(a, b, c)
+    , theLower()
+    , theWidth()
+    , theTable(masses(aCdf)) {
+  // the first bin is the probability mass of the first value
+  theLower.emplace_back(aCdf.front().first);
+  theWidth.emplace_back(0);
+  for (std::size_t i = 1; i < aCdf.size(); i++) {
+    theLower.emplace_back(aCdf[i - 1].first);
+    theWidth.emplace_back(aCdf[i].first - aCdf[i - 1].first);
+  }
+}
+
+std::vector<std::pair<double, double>>
+EmpiricalRv::loadCdf(const std::string& aFilename) {
+  std::ifstream myFile(aFilename);
+  if (not myFile) {
+    throw std::runtime_error("Could not open CDF file for reading: " +
+                             aFilename);
+  }
+  std::vector<std::pair<double, double>> ret;
+  std::string                            myLine;
+  std::size_t                            myLineNo = 0;
+  while (std::getline(myFile, myLine)) {
+    ++myLineNo;
+    if (myLine.empty() or myLine[0] == '#') {
+      continue;
+    }
+    const auto myTokens = split<std::vector<std::string>>(myLine, ", \t\r");
+    if (myTokens.size() != 2) {
+      throw std::runtime_error("Invalid line " + std::to_string(myLineNo) +
+                               " in CDF file " + aFilename + ": " + myLine);
+    }
+    try {
+      ret.emplace_back(std::stod(myTokens[0]), std::stod(myTokens[1]));
+    } catch (const std::logic_error&) {
+      throw std::runtime_error("Invalid number at line " +
+                               std::to_string(myLineNo) + " in CDF file " +
+                               aFilename + ": " + myLine);
+    }
+  }
+  return ret;
+}
+
+void EmpiricalRv::transform(double* aData, const std::size_t aSize) const {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = value(aData[i]);
+  }
+}
+
+std::vector<double>
+EmpiricalRv::masses(const std::vector<std::pair<double, double>>& aCdf) {
+  if (aCdf.empty()) {
+    throw std::runtime_error("Invalid empty CDF");
+  }
+  std::vector<double> ret({aCdf.front().second});
+  for (std::size_t i = 1; i < aCdf.size(); i++) {
+    if (aCdf[i].first < aCdf[i - 1].first or
+        aCdf[i].second < aCdf[i - 1].second) {
+      throw std::runtime_error("Invalid CDF, decreasing at point #" +
+                               std::to_string(i));
+    }
+    ret.emplace_back(aCdf[i].second - aCdf[i - 1].second);
+  }
+  if (aCdf.front().second < 0) {
+    throw std::runtime_error("Invalid CDF, negative at first point");
+  }
+  return ret;
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,329 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Support/batchrandom.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace uiiit {
+namespace support {
+
+namespace detail {
+
+/**
+ * @brief Inverse of the standard normal cumulative distribution function.
+ *
+ * Uses P. J. Acklam's rational approximation followed by one step of
+ * Halley's method, which brings the relative error close to machine
+ * precision.
+ *
+ * @param aProb The probability, in (0, 1).
+ */
+double inverseNormalCdf(const double aProb);
+
+} // namespace detail
+
+/**
+ * @brief Walker's alias table to draw an index among n with given weights in
+ * O(1) from a single uniform value in [0, 1).
+ *
+ * The table is built with Vose's algorithm in O(n).
+ */
+class AliasTable final
+{
+ public:
+  /**
+   * @brief Build the table from the given weights, not necessarily
+   * normalized.
+   *
+   * @throw std::runtime_error if there are no weights, any of them is
+   * negative or not finite, or their sum is not positive.
+   */
+  explicit AliasTable(const std::vector<double>& aWeights);
+
+  //! @return the index drawn from a uniform value in [0, 1).
+  std::size_t operator()(const double aUnit) const noexcept {
+    double myFrac;
+    return (*this)(aUnit, myFrac);
+  }
+
+  /**
+   * @brief Draw an index and also return a residual value that is uniformly
+   * distributed in [0, 1) and independent of the index drawn, which can be
+   * used to draw a value within the corresponding bin.
+   */
+  std::size_t operator()(const double aUnit, double& aFrac) const noexcept;
+
+  //! @return the number of elements.
+  std::size_t size() const noexcept {
+    return theProbs.size();
+  }
+
+ private:
+  std::vector<double>      theProbs;
+  std::vector<std::size_t> theAliases;
+};
+
+/**
+ * @brief Tabulated quantile function of a continuous distribution, which
+ * avoids the evaluation of transcendental functions for every sample.
+ *
+ * The domain is split into the lower half (0, 1/2] and the upper half
+ * [1/2, 1), and each half is tabulated as a function of the distance v from
+ * the closer end, i.e., u for the lower half and 1 - u for the upper half.
+ * The cells are geometrically spaced: every octave [2^-(o+1), 2^-o) of v is
+ * split into 2^theCellBits cells of equal width, so that the cell and the
+ * position within it are obtained directly from the binary representation of
+ * v. The quantile is linearly interpolated within a cell, which for power
+ * laws (e.g., Pareto tails) yields a relative error in the order of 1e-5
+ * throughout the whole range, including the extreme tails.
+ *
+ * A table takes about 220 KB, hence the r.v.'s with the same distribution
+ * and parameters share an immutable one obtained from shared().
+ */
+class QuantileTable final
+{
+ public:
+  /**
+   * @brief Tabulate a quantile function.
+   *
+   * @param aLower Return the quantile of u, for u in (0, 1/2].
+   * @param aUpper Return the quantile of 1 - v, for v in (0, 1/2].
+   */
+  explicit QuantileTable(const std::function<double(double)>& aLower,
+                         const std::function<double(double)>& aUpper);
+
+  /**
+   * @brief Return the table of a distribution with given parameters, which
+   * is built only if there is not one already in use. Thread-safe.
+   *
+   * @param aName The name of the distribution.
+   * @param aParams Its parameters, which must not be NaN.
+   * @param aLower Same as the constructor, used only to build the table.
+   * @param aUpper Same as the constructor, used only to build the table.
+   */
+  static std::shared_ptr<const QuantileTable>
+  shared(const std::string&                   aName,
+         const std::vector<double>&           aParams,
+         const std::function<double(double)>& aLower,
+         const std::function<double(double)>& aUpper);
+
+  //! @return the approximate quantile of a value in [0, 1).
+  double operator()(const double aUnit) const noexcept;
+
+ private:
+  static constexpr std::size_t theCellBits = 8;
+  static constexpr std::size_t theCells    = std::size_t(1) << theCellBits;
+  static constexpr std::size_t theOctaves  = 54;
+  static constexpr std::size_t theStride   = theCells + 1;
+
+  static void fill(std::vector<double>&                 aTable,
+                   const std::function<double(double)>& aQuantile);
+
+  double lookup(const std::vector<double>& aTable,
+                const double               aDistance) const noexcept;
+
+ private:
+  std::vector<double> theLower;
+  std::vector<double> theUpper;
+};
+
+/**
+ * @brief Pareto r.v. with scale xm and shape alpha, drawn from a tabulated
+ * quantile function.
+ */
+class ParetoRv final : public BatchRv
+{
+ public:
+  /**
+   * @throw std::runtime_error if the scale or shape are not positive.
+   */
+  explicit ParetoRv(const double      aScale,
+                    const double      aShape,
+                    const std::size_t a,
+                    const std::size_t b,
+                    const std::size_t c);
+
+  //! @return the tabulated quantile function.
+  const QuantileTable& table() const noexcept {
+    return *theTable;
+  }
+
+ private:
+  void transform(double* aData, const std::size_t aSize) const override;
+
+ private:
+  std::shared_ptr<const QuantileTable> theTable;
+};
+
+/**
+ * @brief Log-normal r.v. whose logarithm has mean mu and standard deviation
+ * sigma, drawn from a tabulated quantile function.
+ */
+class LogNormalRv final : public BatchRv
+{
+ public:
+  /**
+   * @throw std::runtime_error if sigma is not positive.
+   */
+  explicit LogNormalRv(const double      aMu,
+                       const double      aSigma,
+                       const std::size_t a,
+                       const std::size_t b,
+                       const std::size_t c);
+
+  //! @return the tabulated quantile function.
+  const QuantileTable& table() const noexcept {
+    return *theTable;
+  }
+
+ private:
+  void transform(double* aData, const std::size_t aSize) const override;
+
+ private:
+  std::shared_ptr<const QuantileTable> theTable;
+};
+
+/**
+ * @brief Weibull r.v. with shape k and scale lambda, drawn from a tabulated
+ * quantile function.
+ */
+class WeibullRv final : public BatchRv
+{
+ public:
+  /**
+   * @throw std::runtime_error if the shape or scale are not positive.
+   */
+  explicit WeibullRv(const double      aShape,
+                     const double      aScale,
+                     const std::size_t a,
+                     const std::size_t b,
+                     const std::size_t c);
+
+  //! @return the tabulated quantile function.
+  const QuantileTable& table() const noexcept {
+    return *theTable;
+  }
+
+ private:
+  void transform(double* aData, const std::size_t aSize) const override;
+
+ private:
+  std::shared_ptr<const QuantileTable> theTable;
+};
+
+//! Discrete r.v. taking a finite set of values with given weights.
+class DiscreteRv final : public BatchRv
+{
+ public:
+  /**
+   * @param aValues The values and their weights, not necessarily normalized.
+   *
+   * @throw std::runtime_error if the weights are invalid.
+   */
+  explicit DiscreteRv(const std::vector<std::pair<double, double>>& aValues,
+                      const std::size_t                             a,
+                      const std::size_t                             b,
+                      const std::size_t                             c);
+
+ private:
+  void transform(double* aData, const std::size_t aSize) const override;
+
+  static std::vector<double>
+  weights(const std::vector<std::pair<double, double>>& aValues);
+
+ private:
+  std::vector<double> theValues;
+  const AliasTable    theTable;
+};
+
+/**
+ * @brief Continuous r.v. with a piecewise-linear empirical cumulative
+ * distribution function.
+ *
+ * The CDF is given as a sequence of points (x_i, F(x_i)), both non-decreasing
+ * in i: the first value has a probability mass F(x_0) and the others are
+ * uniformly distributed between consecutive points. The CDF is normalized so
+ * that the last point has F = 1.
+ */
+class EmpiricalRv final : public BatchRv
+{
+ public:
+  /**
+   * @throw std::runtime_error if the CDF is invalid.
+   */
+  explicit EmpiricalRv(const std::vector<std::pair<double, double>>& aCdf,
+                       const std::size_t                             a,
+                       const std::size_t                             b,
+                       const std::size_t                             c);
+
+  /**
+   * @brief Load the CDF from a file with one point per line, with the value
+   * and the cumulative probability separated by a comma or white spaces.
+   * Empty lines and lines beginning with # are skipped.
+   *
+   * @throw std::runtime_error if the file cannot be read or it is invalid.
+   */
+  static std::vector<std::pair<double, double>>
+  loadCdf(const std::string& aFilename);
+
+  /**
+   * @brief Return the value obtained from a uniform value in [0, 1), as done
+   * for the values returned by operator() and fill(), so that the same
+   * distribution can be drawn with uniform values from another generator.
+   */
+  double value(const double aUnit) const noexcept {
+    double     myFrac;
+    const auto myNdx = theTable(aUnit, myFrac);
+    return theLower[myNdx] + theWidth[myNdx] * myFrac;
+  }
+
+ private:
+  void transform(double* aData, const std::size_t aSize) const override;
+
+  static std::vector<double>
+  masses(const std::vector<std::pair<double, double>>& aCdf);
+
+ private:
+  std::vector<double> theLower;
+  std::vector<double> theWidth;
+  const AliasTable    theTable;
+};
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,117 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/fairness.h"
+
+namespace uiiit {
+namespace support {
+
+JainFairnessTracker::JainFairnessTracker(const std::size_t aSize)
+    : theValues(aSize, 0.0)
+    , theSum(0)
+    , theSumSquares(0) {
+  // noop
+}
+
+void JainFairnessTracker::update(const std::size_t aIndex,
+                                 const double      aValue) {
+  auto& myValue = theValues.at(aIndex);
+  theSum += aValue - myValue;
+  theSumSquares += aValue * aValue - myValue * myValue;
+  myValue = aValue;
+}
+
+double JainFairnessTracker::index() const {
+  if (theValues.empty()) {
+    throw std::runtime_error(
+        "cannot calculate fairness on vanishing population");
+  }
+  return theSum * theSum / (theValues.size() * theSumSquares);
+}
+
+void JainFairnessTracker::resync() noexcept {
+  theSum        = 0;
+  theSumSquares = 0;
+  for (const auto& myValue : theValues) {
+    theSum += myValue;
+    theSumSquares += myValue * myValue;
+  }
+}
+
+ProportionalFairnessTracker::ProportionalFairnessTracker(
+    const std::size_t aSize)
+    : ProportionalFairnessTracker(std::vector<double>(aSize, 1.0)) {
+  // noop
+}
+
+ProportionalFairnessTracker::ProportionalFairnessTracker(
+    std::vector<double>&& aWeights)
+    : theValues(aWeights.size(), 0.0)
+    , theWeights(std::move(aWeights))
+    , theSum(0)
+    , theInvalid(theValues.size()) {
+  // noop
+}
+
+void ProportionalFairnessTracker::update(const std::size_t aIndex,
+                                         const double      aValue) {
+  auto&      myValue  = theValues.at(aIndex);
+  const auto myWeight = theWeights[aIndex];
+  if (detail::validProportional(myValue)) {
+    theSum -= myWeight * std::log(myValue);
+  } else {
+    theInvalid--;
+  }
+  if (detail::validProportional(aValue)) {
+    theSum += myWeight * std::log(aValue);
+  } else {
+    theInvalid++;
+  }
+  myValue = aValue;
+}
+
+double ProportionalFairnessTracker::index() const noexcept {
+  return theInvalid > 0 ? 0 : theSum;
+}
+
+void ProportionalFairnessTracker::resync() noexcept {
+  theSum     = 0;
+  theInvalid = 0;
+  for (std::size_t i = 0; i < theValues.size(); i++) {
+    if (detail::validProportional(theValues[i])) {
+      theSum += theWeights[i] * std::log(theValues[i]);
+    } else {
+      theInvalid++;
+    }
+  }
+}
+
+} // namespace support
+} // namespace uiiit
@@ -29,46 +29,169 @@ SOFTWARE.
 
 #pragma once
 
-#include "Support/stat.h"
+#include "Support/Detail/parallelreduce.h"
 
 #include <cmath>
+#include <cstddef>
 #include <exception>
 #include <functional>
+#include <iterator>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace uiiit {
 namespace support {
 
+namespace detail {
+
+//! Default unary operator for fairness indices: convert to double.
+struct FairnessIdentity {
+  template <typename T>
+  double operator()(const T& aValue) const noexcept {
+    return static_cast<double>(aValue);
+  }
+};
+
+//! Sum of weights and squared weights.
+struct JainSums {
+  double theSum        = 0;
+  double theSumSquares = 0;
+  double theCount      = 0;
+
+  JainSums operator+(const JainSums& aOther) const noexcept {
+    return JainSums{theSum + aOther.theSum,
+                    theSumSquares + aOther.theSumSquares,
+                    theCount + aOther.theCount};
+  }
+};
+
+template <typename ITERATOR, typename UNARYOP>
+JainSums jainSums(ITERATOR aBegin, const ITERATOR aEnd, UNARYOP& aUnaryOp) {
+  JainSums ret;
+  for (; aBegin != aEnd; ++aBegin) {
+    const double myValue = aUnaryOp(*aBegin);
+    ret.theSum += myValue;
+    ret.theSumSquares += myValue * myValue;
+    ret.theCount += 1;
+  }
+  return ret;
+}
+
+//! Sum of the weighted logarithms and number of invalid values.
+struct ProportionalSums {
+  double      theSum     = 0;
+  std::size_t theInvalid = 0;
+
+  ProportionalSums operator+(const ProportionalSums& aOther) const noexcept {
+    return ProportionalSums{theSum + aOther.theSum,
+                            theInvalid + aOther.theInvalid};
+  }
+};
+
+inline bool validProportional(const double aValue) noexcept {
+  return std::isnormal(aValue) and aValue >= 0;
+}
+
+template <typename ITERATOR_SAM, typename ITERATOR_WGH, typename UNARYOP>
+ProportionalSums proportionalSums(ITERATOR_SAM       aBegin,
+                                  const ITERATOR_SAM aEnd,
+                                  ITERATOR_WGH       aWeight,
+                                  const bool         aWithWeights,
+                                  UNARYOP&           aUnaryOp) {
+  ProportionalSums ret;
+  for (; aBegin != aEnd; ++aBegin) {
+    const double myValue  = aUnaryOp(*aBegin);
+    double       myWeight = 1.0;
+    if (aWithWeights) {
+      myWeight = *aWeight;
+      ++aWeight;
+    }
+    if (validProportional(myValue)) {
+      ret.theSum += myWeight * std::log(myValue);
+    } else {
+      ret.theInvalid++;
+    }
+  }
+  return ret;
+}
+
+template <typename CONTAINER_SAM, typename CONTAINER_WGH>
+void checkProportionalSizes(const CONTAINER_SAM& aContainer,
+                            const CONTAINER_WGH& aWeights) {
+  if (not aWeights.empty() and aWeights.size() != aContainer.size()) {
+    throw std::runtime_error(
+        "inconsistent sizes when calculating proportional fairness index: " +
+        std::to_string(aContainer.size()) + " samples vs. " +
+        std::to_string(aWeights.size()) + " weights");
+  }
+}
+
+//! Minimum number of elements assigned to a thread in parallel indices.
+constexpr std::size_t theFairnessMinChunk = 1 << 16;
+
+} // namespace detail
+
 /**
  * @brief Compute Ray Jain's fairness index
  *
  * https://en.wikipedia.org/wiki/Fairness_measure
  *
  * @tparam CONTAINER the type of the container' elements
+ * @tparam UNARYOP the type of the unary operator
  * @param aContainer the population
  * @param aUnaryOp a unary operator to conver the elements to real values
  * @return double
  *
  * @throw std::runtime_error if the container is empty.
  */
-template <typename CONTAINER>
-double jainFairnessIndex(
-    const CONTAINER& aContainer,
-    const std::function<SummaryStat::Real(typename CONTAINER::value_type)>&
-        aUnaryOp = [](const auto& aValue) { return aValue; }) {
+template <typename CONTAINER, typename UNARYOP = detail::FairnessIdentity>
+double jainFairnessIndex(const CONTAINER& aContainer,
+                         UNARYOP          aUnaryOp = UNARYOP()) {
   if (aContainer.empty()) {
     throw std::runtime_error(
         "cannot calculate fairness on vanishing population");
   }
-  SummaryStat mySum;
-  SummaryStat mySSum;
-  for (const auto& elem : aContainer) {
-    const SummaryStat::Real myValue = aUnaryOp(elem);
-    mySum(myValue);
-    mySSum(myValue * myValue);
+  const auto mySums =
+      detail::jainSums(aContainer.begin(), aContainer.end(), aUnaryOp);
+  return mySums.theSum * mySums.theSum /
+         (mySums.theCount * mySums.theSumSquares);
+}
+
+/**
+ * @brief Compute Ray Jain's fairness index by splitting the population among
+ * multiple threads.
+ *
+ * Same as jainFairnessIndex(), which is used if the population is small.
+ *
+ * @param aNumThreads the maximum number of threads, 0 means as many as the
+ * hardware concurrency
+ *
+ * @throw std::runtime_error if the container is empty.
+ */
+template <typename CONTAINER, typename UNARYOP = detail::FairnessIdentity>
+double jainFairnessIndexParallel(const CONTAINER&  aContainer,
+                                 const std::size_t aNumThreads,
+                                 UNARYOP           aUnaryOp = UNARYOP()) {
+  if (aContainer.empty()) {
+    throw std::runtime_error(
+        "cannot calculate fairness on vanishing population");
   }
-  return mySum.mean() * mySum.mean() / mySSum.mean();
+  const auto mySums = detail::parallelReduce(
+      aContainer.size(),
+      aNumThreads,
+      detail::theFairnessMinChunk,
+      detail::JainSums(),
+      [&](const std::size_t aFrom, const std::size_t aTo) {
+        auto myUnaryOp = aUnaryOp;
+        return detail::jainSums(std::next(aContainer.begin(), aFrom),
+                                std::next(aContainer.begin(), aTo),
+                                myUnaryOp);
+      },
+      std::plus<detail::JainSums>());
+  return mySums.theSum * mySums.theSum /
+         (mySums.theCount * mySums.theSumSquares);
 }
 
 /**
@@ -81,6 +204,7 @@ double jainFairnessIndex(
  *
  * @tparam CONTAINER_SAM the type of the container' elements (samples)
  * @tparam CONTAINER_WGH the type of the container' weights
+ * @tparam UNARYOP the type of the unary operator
  * @param aContainer the population
  * @param aWeights the weights (or costs), one per element, ignore if empty
  * @param aUnaryOp a unary operator to conver the elements to real values
@@ -90,36 +214,152 @@ double jainFairnessIndex(
  * @throw std::runtime_error if there are weights and the samples and weights do
  * not have the same size.
  */
-template <typename CONTAINER_SAM, typename CONTAINER_WGH>
-double proportionalFairnessIndex(
-    const CONTAINER_SAM&                                             aContainer,
-    const CONTAINER_WGH&                                             aWeights,
-    const std::function<double(typename CONTAINER_SAM::value_type)>& aUnaryOp =
-        [](const auto& aValue) { return aValue; }) {
-  if (not aWeights.empty() and aWeights.size() != aContainer.size()) {
-    throw std::runtime_error(
-        "inconsistent sizes when calculating proportional fairness index: " +
-        std::to_string(aContainer.size()) + " samples vs. " +
-        std::to_string(aWeights.size()) + " weights");
+template <typename CONTAINER_SAM,
+          typename CONTAINER_WGH,
+          typename UNARYOP = detail::FairnessIdentity>
+double proportionalFairnessIndex(const CONTAINER_SAM& aContainer,
+                                 const CONTAINER_WGH& aWeights,
+                                 UNARYOP              aUnaryOp = UNARYOP()) {
+  detail::checkProportionalSizes(aContainer, aWeights);
+  const auto mySums = detail::proportionalSums(aContainer.begin(),
+                                               aContainer.end(),
+                                               aWeights.begin(),
+                                               not aWeights.empty(),
+                                               aUnaryOp);
+  return mySums.theInvalid > 0 ? 0 : mySums.theSum;
+}
+
+/**
+ * @brief Compute weighted proportional fairness index by splitting the
+ * population among multiple threads.
+ *
+ * Same as proportionalFairnessIndex(), which is used if the population is
+ * small.
+ *
+ * @param aNumThreads the maximum number of threads, 0 means as many as the
+ * hardware concurrency
+ *
+ * @throw std::runtime_error if there are weights and the samples and weights do
+ * not have the same size.
+ */
+template <typename CONTAINER_SAM,
+          typename CONTAINER_WGH,
+          typename UNARYOP = detail::FairnessIdentity>
+double proportionalFairnessIndexParallel(const CONTAINER_SAM& aContainer,
+                                         const CONTAINER_WGH& aWeights,
+                                         const std::size_t    aNumThreads,
+                                         UNARYOP aUnaryOp = UNARYOP()) {
+  detail::checkProportionalSizes(aContainer, aWeights);
+  const auto myWithWeights = not aWeights.empty();
+  const auto mySums        = detail::parallelReduce(
+      aContainer.size(),
+      aNumThreads,
+      detail::theFairnessMinChunk,
+      detail::ProportionalSums(),
+      [&](const std::size_t aFrom, const std::size_t aTo) {
+        auto myUnaryOp = aUnaryOp;
+        return detail::proportionalSums(
+            std::next(aContainer.begin(), aFrom),
+            std::next(aContainer.begin(), aTo),
+            std::next(aWeights.begin(), myWithWeights ? aFrom : 0),
+            myWithWeights,
+            myUnaryOp);
+      },
+      std::plus<detail::ProportionalSums>());
+  return mySums.theInvalid > 0 ? 0 : mySums.theSum;
+}
+
+/**
+ * @brief Keep Ray Jain's fairness index of a population of fixed size whose
+ * values change over time, with O(1) cost per update.
+ *
+ * The sums are updated incrementally, hence rounding errors may accumulate
+ * over a very long sequence of updates: call resync() to recompute them.
+ */
+class JainFairnessTracker final
+{
+ public:
+  //! Create a population of given size with all values equal to zero.
+  explicit JainFairnessTracker(const std::size_t aSize);
+
+  /**
+   * @brief Change the value of one element of the population.
+   *
+   * @throw std::out_of_range if the index is invalid.
+   */
+  void update(const std::size_t aIndex, const double aValue);
+
+  /**
+   * @return the current fairness index.
+   *
+   * @throw std::runtime_error if the population is empty.
+   */
+  double index() const;
+
+  //! Recompute the sums from the current values.
+  void resync() noexcept;
+
+  //! @return the current value of an element.
+  double value(const std::size_t aIndex) const {
+    return theValues.at(aIndex);
   }
-  double ret = 0;
-  auto   it  = aContainer.begin();
-  auto   jt  = aWeights.begin();
-  while (it != aContainer.end()) {
-    auto myWeight = 1.0;
-    if (jt != aWeights.end()) {
-      myWeight = *jt;
-      ++jt;
-    }
-    const auto myValue = aUnaryOp(*it);
-    if (not std::isnormal(myValue) or myValue < 0) {
-      return 0;
-    }
-    ret += myWeight * std::log(myValue);
-    ++it;
+
+  //! @return the size of the population.
+  std::size_t size() const noexcept {
+    return theValues.size();
   }
-  return ret;
-} // namespace support
+
+ private:
+  std::vector<double> theValues;
+  double              theSum;
+  double              theSumSquares;
+};
+
+/**
+ * @brief Keep the (weighted) proportional fairness index of a population of
+ * fixed size whose values change over time, with O(1) cost per update.
+ *
+ * Initially all the values are zero, hence the index is zero until all of
+ * them are updated with positive values.
+ */
+class ProportionalFairnessTracker final
+{
+ public:
+  //! Create a population of given size with unit weights.
+  explicit ProportionalFairnessTracker(const std::size_t aSize);
+
+  //! Create a population with the given weights, one per element.
+  explicit ProportionalFairnessTracker(std::vector<double>&& aWeights);
+
+  /**
+   * @brief Change the value of one element of the population.
+   *
+   * @throw std::out_of_range if the index is invalid.
+   */
+  void update(const std::size_t aIndex, const double aValue);
+
+  //! @return the current index, or 0 if at least one value is non-positive.
+  double index() const noexcept;
+
+  //! Recompute the sum from the current values.
+  void resync() noexcept;
+
+  //! @return the current value of an element.
+  double value(const std::size_t aIndex) const {
+    return theValues.at(aIndex);
+  }
+
+  //! @return the size of the population.
+  std::size_t size() const noexcept {
+    return theValues.size();
+  }
+
+ private:
+  std::vector<double> theValues;
+  std::vector<double> theWeights;
+  double              theSum;
+  std::size_t         theInvalid;
+};
 
 } // namespace support
 } // namespace uiiit
@@ -0,0 +1,339 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/filewriter.h"
+
+#include <glog/logging.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace uiiit {
+namespace support {
+
+namespace {
+
+//! Tag at the beginning and the end of an archive.
+constexpr char theMagic[] = "UIIITARC";
+
+//! Size of the tag and of each integer in an archive, in bytes.
+constexpr std::size_t theWordSize = 8;
+
+void appendLittleEndian(std::uint64_t aValue, std::string& aOut) {
+  for (std::size_t i = 0; i < theWordSize; i++) {
+    aOut.push_back(static_cast<char>(aValue & 0xff));
+    aValue >>= 8;
+  }
+}
+
+std::uint64_t loadLittleEndian(const char* aData) noexcept {
+  std::uint64_t ret = 0;
+  for (std::size_t i = 0; i < theWordSize; i++) {
+    ret |= static_cast<std::uint64_t>(static_cast<unsigned char>(aData[i]))
+           << (8 * i);
+  }
+  return ret;
+}
+
+//! Write a whole buffer at the given position of a file.
+void writeAll(const int          aFd,
+              const char*        aData,
+              std::size_t        aSize,
+              std::uint64_t      aOffset,
+              const std::string& aName) {
+  while (aSize > 0) {
+    const auto myWritten = ::pwrite(aFd, aData, aSize, aOffset);
+    if (myWritten < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error("Could not write to file " + aName + ": " +
+                               std::strerror(errno));
+    }
+    aData += myWritten;
+    aSize -= static_cast<std::size_t>(myWritten);
+    aOffset += static_cast<std::uint64_t>(myWritten);
+  }
+}
+
+} // namespace
+
+FileWriter::FileWriter(const std::string& aPath,
+                       const Mode         aMode,
+                       const std::size_t  aNumThreads,
+                       const std::size_t  aMaxPending)
+    : thePath(aPath)
+    , theMode(aMode)
+    , theMaxPending(aMaxPending)
+    , theMutex()
+    , theTaskCv()
+    , theSpaceCv()
+    , theTasks()
+    , thePending(0)
+    , theClosed(false)
+    , theError()
+    , theFd(-1)
+    , theArchiveSize(0)
+    , theIndex()
+    , theThreads() {
+  if (aNumThreads == 0) {
+    throw std::runtime_error("Invalid number of threads of the file writer");
+  }
+  if (theMode == Mode::Archive) {
+    theFd = ::open(thePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (theFd < 0) {
+      throw std::runtime_error("Could not open file for writing: " + thePath +
+                               ": " + std::strerror(errno));
+    }
+    try {
+      writeAll(theFd, theMagic, theWordSize, 0, thePath);
+    } catch (...) {
+      ::close(theFd);
+      throw;
+    }
+    theArchiveSize = theWordSize;
+  }
+  for (std::size_t i = 0; i < aNumThreads; i++) {
+    theThreads.emplace_back([this]() { worker(); });
+  }
+}
+
+FileWriter::~FileWriter() {
+  try {
+    close();
+  } catch (const std::exception& aErr) {
+    LOG(ERROR) << aErr.what();
+  }
+}
+
+void FileWriter::write(const std::string& aName, std::string&& aContent) {
+  std::unique_lock<std::mutex> myLock(theMutex);
+
+  // a buffer larger than the limit is accepted when nothing else is pending
+  theSpaceCv.wait(myLock, [this, &aContent]() {
+    return not theError.empty() or thePending == 0 or
+           thePending + aContent.size() <= theMaxPending;
+  });
+  if (not theError.empty()) {
+    throw std::runtime_error(theError);
+  }
+  if (theClosed) {
+    throw std::runtime_error("Cannot write " + aName +
+                             ": the file writer is closed");
+  }
+
+  // the position in the archive is assigned in order of writing
+  std::uint64_t myOffset = 0;
+  if (theMode == Mode::Archive) {
+    myOffset = theArchiveSize;
+    theArchiveSize += aContent.size();
+    theIndex.emplace_back(Entry{aName, myOffset, aContent.size()});
+  }
+  thePending += aContent.size();
+  theTasks.emplace_back(Task{aName, std::move(aContent), myOffset});
+  theTaskCv.notify_one();
+}
+
+void FileWriter::close() {
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    if (theClosed) {
+      return;
+    }
+    theClosed = true;
+    theTaskCv.notify_all();
+  }
+  for (auto& myThread : theThreads) {
+    myThread.join();
+  }
+  theThreads.clear();
+
+  // the threads are terminated, hence no lock is needed
+  if (theMode == Mode::Archive) {
+    if (theError.empty()) {
+      try {
+        writeIndex();
+      } catch (const std::exception& aErr) {
+        theError = aErr.what();
+      }
+    }
+    ::close(theFd);
+    theFd = -1;
+  }
+  if (not theError.empty()) {
+    throw std::runtime_error(theError);
+  }
+}
+
+void FileWriter::worker() {
+  while (true) {
+    Task myTask;
+    {
+      std::unique_lock<std::mutex> myLock(theMutex);
+      theTaskCv.wait(myLock,
+                     [this]() { return theClosed or not theTasks.empty(); });
+      if (theTasks.empty()) {
+        // closed and nothing left to write
+        return;
+      }
+      myTask = std::move(theTasks.front());
+      theTasks.pop_front();
+    }
+
+    std::string myError;
+    try {
+      writeFile(myTask);
+    } catch (const std::exception& aErr) {
+      myError = aErr.what();
+    }
+
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    if (theError.empty()) {
+      theError = std::move(myError);
+    }
+    thePending -= myTask.theContent.size();
+    theSpaceCv.notify_all();
+  }
+}
+
+void FileWriter::writeFile(const Task& aTask) {
+  if (theMode == Mode::Archive) {
+    writeAll(theFd,
+             aTask.theContent.data(),
+             aTask.theContent.size(),
+             aTask.theOffset,
+             thePath);
+    return;
+  }
+
+  const auto myFilename = thePath + "/" + aTask.theName;
+  const auto myFd =
+      ::open(myFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (myFd < 0) {
+    throw std::runtime_error("Could not open file for writing: " +
+                             myFilename + ": " + std::strerror(errno));
+  }
+  try {
+    writeAll(
+        myFd, aTask.theContent.data(), aTask.theContent.size(), 0, myFilename);
+  } catch (...) {
+    ::close(myFd);
+    throw;
+  }
+  if (::close(myFd) != 0) {
+    throw std::runtime_error("Could not close file " + myFilename + ": " +
+                             std::strerror(errno));
+  }
+}
+
+void FileWriter::writeIndex() {
+  // index: for each file the size of the name, the name, offset, and size
+  // footer: the offset of the index, the number of files, and the tag
+  std::string myIndex;
+  for (const auto& myEntry : theIndex) {
+    appendLittleEndian(myEntry.theName.size(), myIndex);
+    myIndex.append(myEntry.theName);
+    appendLittleEndian(myEntry.theOffset, myIndex);
+    appendLittleEndian(myEntry.theSize, myIndex);
+  }
+  appendLittleEndian(theArchiveSize, myIndex);
+  appendLittleEndian(theIndex.size(), myIndex);
+  myIndex.append(theMagic, theWordSize);
+  writeAll(theFd, myIndex.data(), myIndex.size(), theArchiveSize, thePath);
+}
+
+ArchiveReader::ArchiveReader(const std::string& aFilename)
+    : theFile(aFilename)
+    , theNames()
+    , theContents() {
+  const auto myData    = theFile.view();
+  const auto myInvalid = [&aFilename](const std::string& aWhat) {
+    return std::runtime_error("Invalid archive " + aFilename + ": " + aWhat);
+  };
+  if (myData.size() < 4 * theWordSize or
+      myData.substr(0, theWordSize) != theMagic or
+      myData.substr(myData.size() - theWordSize) != theMagic) {
+    throw myInvalid("missing tag");
+  }
+
+  const auto* myFooter  = myData.data() + myData.size() - 3 * theWordSize;
+  const auto  myIndex   = loadLittleEndian(myFooter);
+  const auto  myEntries = loadLittleEndian(myFooter + theWordSize);
+  const auto  myEnd     = myData.size() - 3 * theWordSize;
+  if (myIndex < theWordSize or myIndex > myEnd) {
+    throw myInvalid("wrong index position");
+  }
+
+  // read an integer from the index, checking that it is within bounds
+  std::size_t myCur  = myIndex;
+  const auto  myRead = [&]() {
+    if (myEnd - myCur < theWordSize) {
+      throw myInvalid("truncated index");
+    }
+    const auto ret = loadLittleEndian(myData.data() + myCur);
+    myCur += theWordSize;
+    return ret;
+  };
+  for (std::uint64_t i = 0; i < myEntries; i++) {
+    const auto myNameSize = myRead();
+    if (myEnd - myCur < myNameSize) {
+      throw myInvalid("truncated index");
+    }
+    std::string myName(myData.substr(myCur, myNameSize));
+    myCur += myNameSize;
+    const auto myOffset = myRead();
+    const auto mySize   = myRead();
+    if (myOffset < theWordSize or myOffset > myIndex or
+        mySize > myIndex - myOffset) {
+      throw myInvalid("file out of bounds: " + myName);
+    }
+    if (not theContents.emplace(myName, myData.substr(myOffset, mySize))
+                .second) {
+      throw myInvalid("duplicate file: " + myName);
+    }
+    theNames.emplace_back(std::move(myName));
+  }
+}
+
+std::string_view ArchiveReader::content(const std::string& aName) const {
+  const auto it = theContents.find(aName);
+  if (it == theContents.end()) {
+    throw std::runtime_error("File not found in archive: " + aName);
+  }
+  return it->second;
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,185 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Support/macros.h"
+#include "Support/mappedfile.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace uiiit {
+namespace support {
+
+/**
+ * @brief Write whole files from a bounded pool of threads.
+ *
+ * The content of each file is formatted by the caller into a single buffer,
+ * which is handed over to the writer and written by one of its threads with
+ * as few system calls as possible. The caller blocks when the buffers not yet
+ * written exceed a given size.
+ *
+ * In directory mode every file is created in a directory. In archive mode all
+ * the files are stored in a single container file, which ends with an index
+ * of the files, to be read with ArchiveReader.
+ */
+class FileWriter final
+{
+  NONCOPYABLE_NONMOVABLE(FileWriter);
+
+ public:
+  enum class Mode : unsigned int {
+    Directory = 0,
+    Archive   = 1,
+  };
+
+  /**
+   * @brief Start the threads of the writer.
+   *
+   * @param aPath The directory where the files are written, which must exist,
+   * or the name of the archive file, depending on aMode.
+   * @param aMode The output mode.
+   * @param aNumThreads The number of writing threads, at least one.
+   * @param aMaxPending The maximum size of the buffers not yet written, in
+   * bytes, after which write() blocks.
+   *
+   * @throw std::runtime_error if the archive cannot be created.
+   */
+  explicit FileWriter(const std::string& aPath,
+                      const Mode         aMode,
+                      const std::size_t  aNumThreads,
+                      const std::size_t  aMaxPending = 64 << 20);
+
+  //! Wait for all the files to be written, errors are only logged.
+  ~FileWriter();
+
+  /**
+   * @brief Write a file, possibly asynchronously.
+   *
+   * @param aName The name of the file, relative to the directory or archive.
+   * @param aContent The full content of the file.
+   *
+   * @throw std::runtime_error if a previous write failed or the writer is
+   * closed.
+   */
+  void write(const std::string& aName, std::string&& aContent);
+
+  /**
+   * @brief Wait for all the files to be written, then write the index of the
+   * archive, if any. Nothing can be written afterwards.
+   *
+   * @throw std::runtime_error if writing any file failed.
+   */
+  void close();
+
+ private:
+  struct Task {
+    std::string   theName;
+    std::string   theContent;
+    std::uint64_t theOffset; // position in the archive
+  };
+
+  struct Entry {
+    std::string   theName;
+    std::uint64_t theOffset; // position in the archive
+    std::uint64_t theSize;   // in bytes
+  };
+
+  void worker();
+  void writeFile(const Task& aTask);
+  void writeIndex();
+
+  const std::string thePath;
+  const Mode        theMode;
+  const std::size_t theMaxPending;
+
+  std::mutex              theMutex;
+  std::condition_variable theTaskCv;  // new task or closing
+  std::condition_variable theSpaceCv; // buffer space released
+  std::deque<Task>        theTasks;
+  std::size_t             thePending; // bytes queued or being written
+  bool                    theClosed;
+  std::string             theError; // first error occurred, if any
+
+  // archive mode only
+  int                theFd;
+  std::uint64_t      theArchiveSize;
+  std::vector<Entry> theIndex;
+
+  std::vector<std::thread> theThreads;
+};
+
+/**
+ * @brief Read the files stored in an archive by FileWriter, which is mapped
+ * in memory.
+ */
+class ArchiveReader final
+{
+  NONCOPYABLE_NONMOVABLE(ArchiveReader);
+
+ public:
+  /**
+   * @brief Map an archive and load its index.
+   *
+   * @param aFilename The name of the archive file.
+   *
+   * @throw std::runtime_error if the file cannot be read or it is invalid.
+   */
+  explicit ArchiveReader(const std::string& aFilename);
+
+  //! @return the names of the files, in the order they were written.
+  const std::vector<std::string>& names() const noexcept {
+    return theNames;
+  }
+
+  /**
+   * @return the content of a file, valid as long as this object exists.
+   *
+   * @throw std::runtime_error if there is no file with the given name.
+   */
+  std::string_view content(const std::string& aName) const;
+
+ private:
+  const MappedFile                                  theFile;
+  std::vector<std::string>                          theNames;
+  std::unordered_map<std::string, std::string_view> theContents;
+};
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,113 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/mappedfile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace uiiit {
+namespace support {
+
+MappedFile::MappedFile(const std::string& aFilename)
+    : theData(nullptr)
+    , theSize(0) {
+  const auto myFd = ::open(aFilename.c_str(), O_RDONLY);
+  if (myFd < 0) {
+    throw std::runtime_error("Could not open file for reading: " + aFilename +
+                             ": " + std::strerror(errno));
+  }
+
+  struct stat myStat;
+  if (::fstat(myFd, &myStat) != 0) {
+    const auto myErr = errno;
+    ::close(myFd);
+    throw std::runtime_error("Could not stat file " + aFilename + ": " +
+                             std::strerror(myErr));
+  }
+  theSize = static_cast<std::size_t>(myStat.st_size);
+
+  // mmap() does not accept zero-length mappings
+  if (theSize > 0) {
+    const auto myData =
+        ::mmap(nullptr, theSize, PROT_READ, MAP_PRIVATE, myFd, 0);
+    if (myData == MAP_FAILED) {
+      const auto myErr = errno;
+      ::close(myFd);
+      throw std::runtime_error("Could not map file " + aFilename + ": " +
+                               std::strerror(myErr));
+    }
+    // the file is typically scanned once from the beginning to the end
+    ::madvise(myData, theSize, MADV_SEQUENTIAL);
+    theData = static_cast<const char*>(myData);
+  }
+
+  // the mapping remains valid after the descriptor is closed
+  ::close(myFd);
+}
+
+MappedFile::MappedFile(MappedFile&& aOther) noexcept
+    : theData(aOther.theData)
+    , theSize(aOther.theSize) {
+  aOther.theData = nullptr;
+  aOther.theSize = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& aOther) noexcept {
+  if (this != &aOther) {
+    release();
+    theData        = aOther.theData;
+    theSize        = aOther.theSize;
+    aOther.theData = nullptr;
+    aOther.theSize = 0;
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  release();
+}
+
+void MappedFile::release() noexcept {
+  if (theData != nullptr) {
+    ::munmap(const_cast<char*>(theData), theSize);
+    theData = nullptr;
+    theSize = 0;
+  }
+}
+
+} // namespace support
+} // namespace uiiit
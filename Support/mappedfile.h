@@ -0,0 +1,94 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Support/macros.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace uiiit {
+namespace support {
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * The content is loaded lazily by the operating system as it is accessed,
+ * without copies into user-space buffers. The mapping is released upon
+ * destruction, hence pointers to the content must not outlive the object,
+ * but they remain valid if the object is moved. The file must not be
+ * truncated or modified while it is mapped, though it can be removed.
+ */
+class MappedFile final
+{
+  NONCOPYABLE_NONMOVABLE(MappedFile);
+
+ public:
+  /**
+   * @brief Map a file in memory.
+   *
+   * @param aFilename The name of the file to map.
+   *
+   * @throw std::runtime_error if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const std::string& aFilename);
+
+  MappedFile(MappedFile&& aOther) noexcept;
+  MappedFile& operator=(MappedFile&& aOther) noexcept;
+
+  ~MappedFile();
+
+  //! @return the content of the file, nullptr if the file is empty.
+  const char* data() const noexcept {
+    return theData;
+  }
+
+  //! @return the size of the file, in bytes.
+  std::size_t size() const noexcept {
+    return theSize;
+  }
+
+  //! @return the content of the file as a string view.
+  std::string_view view() const noexcept {
+    return std::string_view(theData, theSize);
+  }
+
+ private:
+  void release() noexcept;
+
+ private:
+  const char* theData;
+  std::size_t theSize;
+};
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,79 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/radixsort.h"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace uiiit {
+namespace support {
+
+void radixSort(std::vector<std::uint64_t>& aValues) {
+  if (aValues.size() < 2) {
+    return;
+  }
+
+  constexpr std::size_t myNumBytes   = sizeof(std::uint64_t);
+  constexpr std::size_t myNumBuckets = 256;
+
+  // count the occurrences of all the bytes in a single pass
+  std::array<std::array<std::size_t, myNumBuckets>, myNumBytes> myCounts{};
+  for (const auto myValue : aValues) {
+    for (std::size_t b = 0; b < myNumBytes; b++) {
+      myCounts[b][(myValue >> (8 * b)) & 0xff]++;
+    }
+  }
+
+  std::vector<std::uint64_t> myBuffer;
+  for (std::size_t b = 0; b < myNumBytes; b++) {
+    auto& myCount = myCounts[b];
+
+    // skip the byte if it is the same in all the values
+    if (myCount[(aValues.front() >> (8 * b)) & 0xff] == aValues.size()) {
+      continue;
+    }
+
+    std::size_t myOffset = 0;
+    for (auto& elem : myCount) {
+      myOffset += std::exchange(elem, myOffset);
+    }
+
+    myBuffer.resize(aValues.size());
+    for (const auto myValue : aValues) {
+      myBuffer[myCount[(myValue >> (8 * b)) & 0xff]++] = myValue;
+    }
+    aValues.swap(myBuffer);
+  }
+}
+
+} // namespace support
+} // namespace uiiit
@@ -29,19 +29,19 @@ SOFTWARE.
 
 #include "Support/random.h"
 
+#include "Support/distributions.h"
 #include "Support/split.h"
+#include "Support/threadrandom.h"
 
-#include <chrono>
+#include <algorithm>
 #include <stdexcept>
 
 namespace uiiit {
 namespace support {
 
 float random() {
-  static std::default_random_engine myGenerator(
-      std::chrono::system_clock::now().time_since_epoch().count());
-  static std::uniform_real_distribution<float> myDistribution(0.0f, 1.0f);
-  return myDistribution(myGenerator);
+  // the 24 most significant bits fill exactly the mantissa of a float
+  return static_cast<float>(threadGenerator()() >> 40) * 0x1.0p-24f;
 }
 
 GenericRv::GenericRv(const size_t a, const size_t b, const size_t c)
@@ -50,6 +50,12 @@ GenericRv::GenericRv(const size_t a, const size_t b, const size_t c)
   // noop
 }
 
+void RealRvInterface::fill(double* aData, const std::size_t aSize) {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = (*this)();
+  }
+}
+
 std::unique_ptr<RealRvInterface>
 RealRvInterface::fromString(const std::string& aDescription,
                             const size_t       a,
@@ -59,6 +65,17 @@ RealRvInterface::fromString(const std::string& aDescription,
     throw std::runtime_error("empty description");
   }
 
+  // the file name is taken verbatim, since it may contain commas
+  if (aDescription.size() > 5 and aDescription.find("Emp(") == 0 and
+      aDescription.back() == ')') {
+    return std::make_unique<EmpiricalRv>(
+        EmpiricalRv::loadCdf(
+            aDescription.substr(4, aDescription.size() - 5)),
+        a,
+        b,
+        c);
+  }
+
   if (aDescription.size() >= 6) {
     const auto myTokens =
         support::split<std::vector<std::string>>(aDescription, "(,)");
@@ -69,6 +86,26 @@ RealRvInterface::fromString(const std::string& aDescription,
     } else if (myTokens.size() == 2 and myTokens[0] == "Exp") {
       const auto L = std::stod(myTokens[1]);
       return std::make_unique<ExponentialRv>(L, a, b, c);
+    } else if (myTokens.size() == 3 and myTokens[0] == "Par") {
+      const auto XM    = std::stod(myTokens[1]);
+      const auto ALPHA = std::stod(myTokens[2]);
+      return std::make_unique<ParetoRv>(XM, ALPHA, a, b, c);
+    } else if (myTokens.size() == 3 and myTokens[0] == "LogN") {
+      const auto MU    = std::stod(myTokens[1]);
+      const auto SIGMA = std::stod(myTokens[2]);
+      return std::make_unique<LogNormalRv>(MU, SIGMA, a, b, c);
+    } else if (myTokens.size() == 3 and myTokens[0] == "Weib") {
+      const auto K      = std::stod(myTokens[1]);
+      const auto LAMBDA = std::stod(myTokens[2]);
+      return std::make_unique<WeibullRv>(K, LAMBDA, a, b, c);
+    } else if (myTokens.size() >= 3 and (myTokens.size() % 2) == 1 and
+               myTokens[0] == "D") {
+      std::vector<std::pair<double, double>> myValues;
+      for (std::size_t i = 1; i < myTokens.size(); i += 2) {
+        myValues.emplace_back(std::stod(myTokens[i]),
+                              std::stod(myTokens[i + 1]));
+      }
+      return std::make_unique<DiscreteRv>(myValues, a, b, c);
     }
   }
 
@@ -86,6 +123,10 @@ double ConstantRv::operator()() {
   return theValue;
 }
 
+void ConstantRv::fill(double* aData, const std::size_t aSize) {
+  std::fill(aData, aData + aSize, theValue);
+}
+
 UniformRv::UniformRv(const double aMin,
                      const double aMax,
                      const size_t a,
@@ -104,6 +145,12 @@ double UniformRv::operator()() {
   return theRv(theGenerator);
 }
 
+void UniformRv::fill(double* aData, const std::size_t aSize) {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = theRv(theGenerator);
+  }
+}
+
 ExponentialRv::ExponentialRv(const double aLambda,
                              const size_t a,
                              const size_t b,
@@ -117,6 +164,12 @@ double ExponentialRv::operator()() {
   return theRv(theGenerator);
 }
 
+void ExponentialRv::fill(double* aData, const std::size_t aSize) {
+  for (std::size_t i = 0; i < aSize; i++) {
+    aData[i] = theRv(theGenerator);
+  }
+}
+
 PoissonRv::PoissonRv(const double aMu,
                      const size_t a,
                      const size_t b,
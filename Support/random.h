@@ -41,7 +41,11 @@ SOFTWARE.
 namespace uiiit {
 namespace support {
 
-//! \return a random number in [0, 1].
+/**
+ * \return a random number in [0, 1) from the generator of the calling
+ * thread, which is thread-safe and can be seeded for reproducibility, see
+ * seedThreadRandom() and setThreadRandomStream() in threadrandom.h
+ */
 float random();
 
 //! Generic r.v.
@@ -66,6 +70,18 @@ class RealRvInterface
 
   virtual double operator()() = 0;
 
+  /**
+   * @brief Draw multiple values at once.
+   *
+   * The default implementation calls operator() once per value, derived
+   * classes may override it to avoid the virtual call per sample. In all cases
+   * the values are the same as those returned by as many calls to operator().
+   *
+   * @param aData The output buffer.
+   * @param aSize The number of values to draw.
+   */
+  virtual void fill(double* aData, const std::size_t aSize);
+
   /**
    * @brief Return a new r.v. based on the description given using the passed
    * seed number initializers.
@@ -75,6 +91,14 @@ class RealRvInterface
    * - c -> return a constant value
    * - U(a,b) -> return a uniformly distributed r.v. between a and b
    * - Exp(l) -> return an exponentially distributed r.v. with mean 1/l
+   * - Par(xm,alpha) -> return a Pareto r.v. with scale xm and shape alpha
+   * - LogN(mu,sigma) -> return a log-normal r.v. whose logarithm has mean mu
+   *   and standard deviation sigma
+   * - Weib(k,lambda) -> return a Weibull r.v. with shape k and scale lambda
+   * - D(v1,w1,v2,w2,...) -> return a discrete r.v. taking value vi with a
+   *   probability proportional to wi
+   * - Emp(file) -> return a r.v. with the piecewise-linear empirical CDF
+   *   loaded from the given file, see EmpiricalRv::loadCdf()
    *
    * @throw std::runtime_error if the description is not valid
    *
@@ -111,6 +135,7 @@ class ConstantRv : public RealRvInterface
   explicit ConstantRv(const double aValue);
 
   double operator()() override;
+  void   fill(double* aData, const std::size_t aSize) override;
 
  private:
   const double theValue;
@@ -128,6 +153,7 @@ class UniformRv : public GenericRv, public RealRvInterface
                      const size_t c);
 
   double operator()() override;
+  void   fill(double* aData, const std::size_t aSize) override;
 
  private:
   std::uniform_real_distribution<double> theRv;
@@ -144,6 +170,7 @@ class ExponentialRv : public GenericRv, public RealRvInterface
                          const size_t c);
 
   double operator()() override;
+  void   fill(double* aData, const std::size_t aSize) override;
 
  private:
   std::exponential_distribution<double> theRv;
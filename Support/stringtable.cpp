@@ -0,0 +1,69 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/stringtable.h"
+
+#include <stdexcept>
+
+namespace uiiit {
+namespace support {
+
+StringTable::StringTable()
+    : theStrings()
+    , theIds() {
+  // noop
+}
+
+std::uint32_t StringTable::intern(const std::string_view aString) {
+  const auto it = theIds.find(aString);
+  if (it != theIds.end()) {
+    return it->second;
+  }
+  if (theStrings.size() > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("Too many strings in table: " +
+                             std::to_string(theStrings.size()));
+  }
+  const auto ret = static_cast<std::uint32_t>(theStrings.size());
+  theStrings.emplace_back(aString);
+  theIds.emplace(theStrings.back(), ret);
+  return ret;
+}
+
+std::optional<std::uint32_t>
+StringTable::find(const std::string_view aString) const {
+  const auto it = theIds.find(aString);
+  if (it == theIds.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,94 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Support/macros.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace uiiit {
+namespace support {
+
+/**
+ * @brief Dictionary of strings, each identified by a dense 32-bit code
+ * assigned in order of insertion.
+ *
+ * Every string is stored once, which saves memory when the same strings
+ * are repeated many times, e.g., identifiers in a dataset, and identifiers
+ * can be compared and hashed much faster than strings.
+ *
+ * Not thread-safe.
+ */
+class StringTable final
+{
+ public:
+  MOVEONLY(StringTable);
+
+  StringTable();
+
+  /**
+   * @brief Add a string, if not already present.
+   *
+   * @return the identifier of the string.
+   *
+   * @throw std::runtime_error if there are no more identifiers available.
+   */
+  std::uint32_t intern(const std::string_view aString);
+
+  //! @return the identifier of a string, if present.
+  std::optional<std::uint32_t> find(const std::string_view aString) const;
+
+  //! @return the string with the given identifier, which must be valid.
+  const std::string& operator[](const std::uint32_t aId) const noexcept {
+    return theStrings[aId];
+  }
+
+  //! @return the number of strings.
+  std::size_t size() const noexcept {
+    return theStrings.size();
+  }
+
+ private:
+  // std::deque does not move its elements when growing, hence the views in
+  // theIds remain valid
+  std::deque<std::string>                             theStrings;
+  std::unordered_map<std::string_view, std::uint32_t> theIds;
+};
+
+} // namespace support
+} // namespace uiiit
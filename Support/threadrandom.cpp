@@ -0,0 +1,104 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/threadrandom.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace uiiit {
+namespace support {
+
+namespace {
+
+std::atomic<std::uint64_t> theGlobalSeed(
+    std::chrono::system_clock::now().time_since_epoch().count());
+
+//! Incremented at every change of the global seed.
+std::atomic<std::size_t> theGlobalEpoch(0);
+
+//! Next stream index assigned to a thread by default.
+std::atomic<std::size_t> theNextStream(0);
+
+struct ThreadState {
+  ThreadState()
+      : theStream(theNextStream.fetch_add(1, std::memory_order_relaxed))
+      , theEpoch(theGlobalEpoch.load(std::memory_order_acquire))
+      , theGenerator(
+            theGlobalSeed.load(std::memory_order_relaxed), theStream, 0) {
+    // noop
+  }
+
+  void reseed() noexcept {
+    theEpoch     = theGlobalEpoch.load(std::memory_order_acquire);
+    theGenerator = Xoshiro256pp(
+        theGlobalSeed.load(std::memory_order_relaxed), theStream, 0);
+  }
+
+  std::size_t  theStream;
+  std::size_t  theEpoch;
+  Xoshiro256pp theGenerator;
+};
+
+ThreadState& threadState() {
+  thread_local ThreadState myState;
+  if (myState.theEpoch != theGlobalEpoch.load(std::memory_order_acquire)) {
+    myState.reseed();
+  }
+  return myState;
+}
+
+} // namespace
+
+void seedThreadRandom(const std::uint64_t aSeed) {
+  theGlobalSeed.store(aSeed, std::memory_order_relaxed);
+  theGlobalEpoch.fetch_add(1, std::memory_order_release);
+}
+
+void setThreadRandomStream(const std::size_t aStream) {
+  auto& myState     = threadState();
+  myState.theStream = aStream;
+  myState.reseed();
+}
+
+std::size_t threadRandomStream() {
+  return threadState().theStream;
+}
+
+void jumpThreadRandom() {
+  threadState().theGenerator.jump();
+}
+
+Xoshiro256pp& threadGenerator() {
+  return threadState().theGenerator;
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,101 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Support/batchrandom.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace uiiit {
+namespace support {
+
+/**
+ * Per-thread pseudo-random number generators.
+ *
+ * Every thread owns a xoshiro256++ generator, created on first use, which is
+ * never shared with other threads, hence there is neither locking nor false
+ * sharing. The generator of a thread is identified by a stream index and
+ * its state only depends on the global seed and the stream index.
+ *
+ * By default, each thread is assigned the next free stream index on first
+ * use, which does not make the sequence reproducible when multiple threads
+ * are involved. For reproducible results, e.g., with ParallelBatch, a worker
+ * should bind itself explicitly to a stream, typically identified by the
+ * experiment rather than the thread since experiments are dispatched to
+ * threads in a non-deterministic order:
+ *
+ * @code
+ * seedThreadRandom(42);
+ * ParallelBatch<Parameter> myBatch(N, myQueue, [](Parameter&& aParameter) {
+ *   setThreadRandomStream(aParameter.theId);
+ *   // random() now returns the same sequence for the same experiment
+ * });
+ * @endcode
+ */
+
+/**
+ * @brief Set the global seed of the per-thread generators.
+ *
+ * All the threads, including those that already used their generator,
+ * re-seed on their next draw with the same stream index. If never called,
+ * the global seed is taken from the system clock.
+ *
+ * Must not be called concurrently with itself.
+ */
+void seedThreadRandom(const std::uint64_t aSeed);
+
+/**
+ * @brief Re-seed the generator of the calling thread with the given stream
+ * index.
+ *
+ * Different streams are seeded independently, like GenericRv with different
+ * seed initializers. Use jumpThreadRandom() to obtain sub-streams which are
+ * guaranteed not to overlap.
+ */
+void setThreadRandomStream(const std::size_t aStream);
+
+//! @return the stream index of the calling thread.
+std::size_t threadRandomStream();
+
+/**
+ * @brief Advance the generator of the calling thread by 2^128 steps.
+ *
+ * A stream can be split into 2^64 non-overlapping sub-streams, e.g., one
+ * per replication, by jumping after each of them.
+ */
+void jumpThreadRandom();
+
+//! @return the generator of the calling thread.
+Xoshiro256pp& threadGenerator();
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,417 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace uiiit {
+namespace support {
+
+/**
+ * @brief Time-weighted statistics of a piecewise-constant signal, e.g., the
+ * length of a queue or the utilization of a server.
+ *
+ * Each value added holds until the next one, and it is weighted by the time
+ * it has been held. Samples before the warm-up time are discarded, while an
+ * interval that straddles the warm-up is truncated.
+ *
+ * The mean and variance are computed from the weighted sums of the values
+ * shifted by the first one, which avoids both a division per sample and the
+ * catastrophic cancellation of the naive sum of squares. The object does not
+ * allocate memory and two objects can be merged, e.g., when collected by
+ * different threads.
+ *
+ * If BINS is positive then the weights are also collected in a histogram with
+ * fixed bins plus an underflow and an overflow bin, which is used to
+ * approximate the percentiles.
+ *
+ * @tparam BINS The number of regular bins in the histogram.
+ */
+template <std::size_t BINS = 0>
+class TimeWeightedStat final
+{
+ public:
+  /**
+   * @brief Create an object with no values.
+   *
+   * @param aWarmUp The initial warm-up period in which samples are discarded.
+   * @param aLower The lower bound of the histogram domain.
+   * @param aBinSpan The width of the histogram bins.
+   *
+   * @throw std::runtime_error if there are bins and the bin span is not
+   * positive.
+   */
+  explicit TimeWeightedStat(const double aWarmUp  = 0,
+                            const double aLower   = 0,
+                            const double aBinSpan = 1);
+
+  /**
+   * @brief Change the value of the signal at a given time.
+   *
+   * The previous value, if any, is added with a weight equal to the time
+   * elapsed since it was set, excluding the warm-up period.
+   *
+   * @param aTime The current time, must not be smaller than the previous one.
+   * @param aValue The new value of the signal.
+   */
+  void operator()(const double aTime, const double aValue) noexcept;
+
+  /**
+   * @brief Change the value of the signal multiple times.
+   *
+   * @param aTimes The times of the changes, in non-decreasing order.
+   * @param aValues The new values, one per time.
+   * @param aSize The number of changes.
+   */
+  void observe(const double*     aTimes,
+               const double*     aValues,
+               const std::size_t aSize) noexcept;
+
+  /**
+   * @brief Add the current value until the given time, without changing it.
+   *
+   * Typically called at the end of the simulation, so that the last interval
+   * is also accounted for.
+   *
+   * @param aTime The current time.
+   */
+  void close(const double aTime) noexcept;
+
+  /**
+   * @brief Add a value with an explicit weight, i.e., the time it was held,
+   * without checking against the internal clock or warm-up.
+   *
+   * @param aValue The value.
+   * @param aWeight The weight, must be non-negative.
+   */
+  void add(const double aValue, const double aWeight) noexcept;
+
+  /**
+   * @brief Add multiple values with their weights.
+   *
+   * @param aValues The values.
+   * @param aWeights The weights, one per value.
+   * @param aSize The number of values.
+   */
+  void add(const double*     aValues,
+           const double*     aWeights,
+           const std::size_t aSize) noexcept;
+
+  /**
+   * @brief Merge the statistics collected by another object into this one.
+   *
+   * The last value and time of the other object are ignored.
+   *
+   * @throw std::runtime_error if the histograms have different domains.
+   */
+  void merge(const TimeWeightedStat& aOther);
+
+  //! Reset this object to its initial state, keeping the configuration.
+  void reset() noexcept;
+
+  //! @return the weighted mean, or NaN if the total weight is zero.
+  double mean() const noexcept {
+    return theShift + theSum / theWeight;
+  }
+
+  //! @return the weighted (population) variance, or NaN if no weight.
+  double variance() const noexcept {
+    if (theWeight <= 0) {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    const auto myMean = theSum / theWeight;
+    return std::max(0.0, theSumSquares / theWeight - myMean * myMean);
+  }
+
+  //! @return the weighted standard deviation, or NaN if no weight.
+  double stddev() const noexcept {
+    return std::sqrt(variance());
+  }
+
+  //! @return the minimum value held for a positive time.
+  double min() const noexcept {
+    return theMin;
+  }
+
+  //! @return the maximum value held for a positive time.
+  double max() const noexcept {
+    return theMax;
+  }
+
+  //! @return the total weight, i.e., the observation time after warm-up.
+  double weight() const noexcept {
+    return theWeight;
+  }
+
+  //! @return the number of samples added.
+  std::size_t count() const noexcept {
+    return theCount;
+  }
+
+  //! @return true if no samples were added.
+  bool empty() const noexcept {
+    return theCount == 0;
+  }
+
+  /**
+   * @brief Approximate a percentile from the histogram, by linear
+   * interpolation within the bin. The values in the underflow (overflow) bin
+   * are assumed to be equal to the minimum (maximum).
+   *
+   * @param aPercentile The percentile, in [0, 1].
+   * @return the value, or NaN if there is no weight.
+   *
+   * @throw std::runtime_error if BINS is zero or the percentile is invalid.
+   */
+  double percentile(const double aPercentile) const;
+
+ private:
+  static constexpr std::size_t theNumBins = BINS + 2;
+
+  //! Add the value to the histogram, if any.
+  void addToBins(const double aValue, const double aWeight) noexcept;
+
+ private:
+  // configuration
+  double theWarmUp;
+  double theLower;
+  double theBinSpan;
+
+  // state of the signal
+  double theLastTime;
+  double theLastValue;
+  bool   theInitialized;
+
+  // statistics
+  double                                         theShift;
+  double                                         theWeight;
+  double                                         theSum;
+  double                                         theSumSquares;
+  double                                         theMin;
+  double                                         theMax;
+  std::size_t                                    theCount;
+  std::array<double, BINS == 0 ? 0 : theNumBins> theBins;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <std::size_t BINS>
+TimeWeightedStat<BINS>::TimeWeightedStat(const double aWarmUp,
+                                         const double aLower,
+                                         const double aBinSpan)
+    : theWarmUp(aWarmUp)
+    , theLower(aLower)
+    , theBinSpan(aBinSpan)
+    , theLastTime(0)
+    , theLastValue(0)
+    , theInitialized(false)
+    , theShift(std::numeric_limits<double>::quiet_NaN())
+    , theWeight(0)
+    , theSum(0)
+    , theSumSquares(0)
+    , theMin(std::numeric_limits<double>::max())
+    , theMax(std::numeric_limits<double>::lowest())
+    , theCount(0)
+    , theBins() {
+  if (BINS > 0 and not(aBinSpan > 0)) {
+    throw std::runtime_error("Invalid bin span for TimeWeightedStat: " +
+                             std::to_string(aBinSpan));
+  }
+}
+
+template <std::size_t BINS>
+void TimeWeightedStat<BINS>::operator()(const double aTime,
+                                        const double aValue) noexcept {
+  close(aTime);
+  theInitialized = true;
+  theLastValue   = aValue;
+}
+
+template <std::size_t BINS>
+void TimeWeightedStat<BINS>::observe(const double*     aTimes,
+                                     const double*     aValues,
+                                     const std::size_t aSize) noexcept {
+  if (aSize == 0) {
+    return;
+  }
+
+  // only the first interval can straddle the warm-up period
+  (*this)(aTimes[0], aValues[0]);
+  std::size_t i = 1;
+  for (; i < aSize and aTimes[i] < theWarmUp; i++) {
+    // noop
+  }
+  if (i > 1) {
+    theLastTime  = aTimes[i - 1];
+    theLastValue = aValues[i - 1];
+  }
+  if (i < aSize) {
+    (*this)(aTimes[i], aValues[i]);
+    for (++i; i < aSize; i++) {
+      assert(aTimes[i] >= aTimes[i - 1]);
+      add(aValues[i - 1], aTimes[i] - aTimes[i - 1]);
+    }
+    theLastTime  = aTimes[aSize - 1];
+    theLastValue = aValues[aSize - 1];
+  }
+}
+
+template <std::size_t BINS>
+void TimeWeightedStat<BINS>::close(const double aTime) noexcept {
+  if (theInitialized and aTime >= theWarmUp) {
+    const auto myFrom = std::max(theLastTime, theWarmUp);
+    assert(aTime >= myFrom);
+    add(theLastValue, aTime - myFrom);
+  }
+  theLastTime = aTime;
+}
+
+template <std::size_t BINS>
+void TimeWeightedStat<BINS>::add(const double aValue,
+                                 const double aWeight) noexcept {
+  assert(aWeight >= 0);
+  theCount++;
+  if (aWeight <= 0) {
+    return;
+  }
+  if (theWeight == 0) {
+    theShift = aValue;
+  }
+  const auto myDelta = aValue - theShift;
+  theWeight += aWeight;
+  theSum += aWeight * myDelta;
+  theSumSquares += aWeight * myDelta * myDelta;
+  theMin = std::min(theMin, aValue);
+  theMax = std::max(theMax, aValue);
+  addToBins(aValue, aWeight);
+}
+
+template <std::size_t BINS>
+void TimeWeightedStat<BINS>::add(const double*     aValues,
+                                 const double*     aWeights,
+                                 const std::size_t aSize) noexcept {
+  for (std::size_t i = 0; i < aSize; i++) {
+    add(aValues[i], aWeights[i]);
+  }
+}
+
+template <std::size_t BINS>
+void TimeWeightedStat<BINS>::merge(const TimeWeightedStat& aOther) {
+  if (BINS > 0 and
+      (theLower != aOther.theLower or theBinSpan != aOther.theBinSpan)) {
+    throw std::runtime_error(
+        "Cannot merge TimeWeightedStat objects with different histograms");
+  }
+  theCount += aOther.theCount;
+  if (aOther.theWeight <= 0) {
+    return;
+  }
+  if (theWeight == 0) {
+    theShift = aOther.theShift;
+  }
+  // move the sums of the other object to our shift
+  const auto myDelta = aOther.theShift - theShift;
+  theSumSquares += aOther.theSumSquares + 2 * myDelta * aOther.theSum +
+                   myDelta * myDelta * aOther.theWeight;
+  theSum += aOther.theSum + myDelta * aOther.theWeight;
+  theWeight += aOther.theWeight;
+  theMin = std::min(theMin, aOther.theMin);
+  theMax = std::max(theMax, aOther.theMax);
+  for (std::size_t i = 0; i < theBins.size(); i++) {
+    theBins[i] += aOther.theBins[i];
+  }
+}
+
+template <std::size_t BINS>
+void TimeWeightedStat<BINS>::reset() noexcept {
+  *this = TimeWeightedStat(theWarmUp, theLower, theBinSpan);
+}
+
+template <std::size_t BINS>
+double TimeWeightedStat<BINS>::percentile(const double aPercentile) const {
+  if (BINS == 0) {
+    throw std::runtime_error(
+        "Cannot compute percentiles of TimeWeightedStat without bins");
+  }
+  if (aPercentile < 0 or aPercentile > 1) {
+    throw std::runtime_error("Invalid percentile: " +
+                             std::to_string(aPercentile));
+  }
+  if (theWeight <= 0) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+
+  const auto myTarget = aPercentile * theWeight;
+  auto       myCum    = 0.0;
+  for (std::size_t i = 0; i < theBins.size(); i++) {
+    if (theBins[i] <= 0 or (myCum + theBins[i]) < myTarget) {
+      myCum += theBins[i];
+      continue;
+    }
+    if (i == 0) {
+      return theMin;
+    } else if (i == theBins.size() - 1) {
+      return theMax;
+    }
+    const auto myBinLower = theLower + (i - 1) * theBinSpan;
+    const auto myRet =
+        myBinLower + theBinSpan * (myTarget - myCum) / theBins[i];
+    return std::min(theMax, std::max(theMin, myRet));
+  }
+  return theMax;
+}
+
+template <std::size_t BINS>
+void TimeWeightedStat<BINS>::addToBins(const double aValue,
+                                       const double aWeight) noexcept {
+  if constexpr (BINS > 0) {
+    const auto  myPos = (aValue - theLower) / theBinSpan;
+    std::size_t myNdx;
+    if (myPos < 0) {
+      myNdx = 0;
+    } else if (myPos >= BINS) {
+      myNdx = theNumBins - 1;
+    } else {
+      myNdx = 1 + static_cast<std::size_t>(myPos);
+    }
+    theBins[myNdx] += aWeight;
+  }
+}
+
+} // namespace support
+} // namespace uiiit
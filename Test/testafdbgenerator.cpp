@@ -0,0 +1,182 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Dataset/afdb-generator.h"
+
+#include "gtest/gtest.h"
+
+#include <boost/filesystem.hpp>
+
+#include <sys/resource.h>
+
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace uiiit {
+namespace dataset {
+
+struct TestAfdbGenerator : public ::testing::Test {
+  TestAfdbGenerator()
+      : theFilename("TO_REMOVE_afdbgenerator.dat") {
+    // noop
+  }
+
+  void SetUp() override {
+    std::remove(theFilename.c_str());
+  }
+
+  void TearDown() override {
+    std::remove(theFilename.c_str());
+  }
+
+  //! @return a dataset with random inter-arrival times and flags.
+  static TimestampDataset randomDataset(const std::size_t aNumKeys) {
+    std::mt19937                          myRng(42);
+    std::uniform_int_distribution<size_t> myNumEventsRv(1, 100);
+    std::exponential_distribution<double> myGapRv(0.01);
+    std::bernoulli_distribution           myWriteRv(0.3);
+    TimestampDataset                      ret;
+    for (std::size_t k = 0; k < aNumKeys; k++) {
+      auto&      myEvents    = ret["u" + std::to_string(k) + ",a"];
+      const auto myNumEvents = myNumEventsRv(myRng);
+      double     myTimestamp = 1577836800000;
+      for (std::size_t i = 0; i < myNumEvents; i++) {
+        myTimestamp += myGapRv(myRng);
+        myEvents.emplace_back(myTimestamp, myWriteRv(myRng));
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * @brief Limit the size of the files written by the process, so that the
+   * writes beyond the limit fail, until destruction.
+   */
+  class FileSizeLimit final
+  {
+   public:
+    explicit FileSizeLimit(const rlim_t aSize)
+        : theOldLimit()
+        , theOldHandler(std::signal(SIGXFSZ, SIG_IGN)) {
+      getrlimit(RLIMIT_FSIZE, &theOldLimit);
+      auto myLimit     = theOldLimit;
+      myLimit.rlim_cur = aSize;
+      setrlimit(RLIMIT_FSIZE, &myLimit);
+    }
+
+    ~FileSizeLimit() {
+      setrlimit(RLIMIT_FSIZE, &theOldLimit);
+      std::signal(SIGXFSZ, theOldHandler);
+    }
+
+   private:
+    rlimit theOldLimit;
+    void (*theOldHandler)(int);
+  };
+
+  std::string read() const {
+    std::ifstream myFile(theFilename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(myFile),
+                       std::istreambuf_iterator<char>());
+  }
+
+  const std::string theFilename;
+};
+
+TEST_F(TestAfdbGenerator, test_save_num_threads) {
+  // more keys than a batch, so that the threads write in turn
+  const TraceGenerator myGenerator(randomDataset(300));
+  for (const auto myVersion : {2, 3}) {
+    myGenerator.save(theFilename, myVersion, 2, 0, 1, 1);
+    const auto myExpected = read();
+    for (const std::size_t myNumThreads : {2, 3, 8}) {
+      myGenerator.save(theFilename, myVersion, 2, 0, 1, myNumThreads);
+      ASSERT_TRUE(myExpected == read())
+          << "version " << myVersion << ", threads " << myNumThreads;
+    }
+    myGenerator.save(theFilename, myVersion, 2, 0, 2, 1);
+    ASSERT_FALSE(myExpected == read()) << "version " << myVersion;
+  }
+}
+
+TEST_F(TestAfdbGenerator, test_generate_num_copies) {
+  const TraceGenerator myGenerator(randomDataset(100));
+  const auto           myNumModels = myGenerator.models().size();
+  const auto           myDuration  = 2 * myGenerator.duration();
+
+  // every copy in the file is the same as generated alone, whatever the
+  // number of copies
+  for (const std::size_t myNumCopies : {1, 3}) {
+    const auto myNumEvents =
+        myGenerator.save(theFilename, 2, myNumCopies, myDuration, 5, 2);
+    const auto myDataset = loadTimestampDataset(theFilename);
+    ASSERT_EQ(myNumModels * myNumCopies, myDataset.size());
+    std::size_t myTotal = 0;
+    for (std::size_t m = 0; m < myNumModels; m++) {
+      for (std::size_t c = 0; c < myNumCopies; c++) {
+        const auto myEvents = myGenerator.generate(m, c, myDuration, 5);
+        ASSERT_EQ(myEvents, myDataset.at(myGenerator.key(m, c)))
+            << "model " << m << ", copy " << c << " of " << myNumCopies;
+        myTotal += myEvents.size();
+      }
+    }
+    ASSERT_EQ(myNumEvents, myTotal);
+  }
+
+  // the copies of a model differ from one another
+  ASSERT_NE(myGenerator.generate(0, 0, myDuration, 5),
+            myGenerator.generate(0, 1, myDuration, 5));
+}
+
+TEST_F(TestAfdbGenerator, test_save_failed) {
+  const TraceGenerator myGenerator(randomDataset(100));
+  const rlim_t         myLimit = 65536;
+  for (const auto myVersion : {2, 3}) {
+    ASSERT_LT(0u, myGenerator.save(theFilename, myVersion, 10, 0, 1, 4));
+    ASSERT_LT(myLimit, boost::filesystem::file_size(theFilename));
+
+    {
+      const FileSizeLimit myFileSizeLimit(myLimit);
+      ASSERT_THROW(myGenerator.save(theFilename, myVersion, 10, 0, 1, 4),
+                   std::runtime_error);
+    }
+    ASSERT_TRUE(boost::filesystem::exists(theFilename));
+    ASSERT_THROW(loadTimestampDataset(theFilename), std::runtime_error)
+        << "version " << myVersion;
+  }
+}
+
+} // namespace dataset
+} // namespace uiiit
@@ -0,0 +1,225 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Dataset/afdb-replayer.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace uiiit {
+namespace dataset {
+
+struct TestAfdbReplayer : public ::testing::Test {
+  //! An event as (timestamp, key, write flag), which can be compared.
+  using Tuple = std::tuple<double, std::uint32_t, bool>;
+
+  static Tuple toTuple(const Replayer::Event& aEvent) {
+    return Tuple(aEvent.theTimestamp, aEvent.theKey, aEvent.theWrite);
+  }
+
+  //! @return the events replayed by calling a callback.
+  static std::vector<Tuple> replay(Replayer& aReplayer) {
+    std::vector<Tuple> ret;
+    const auto         myStats = aReplayer.run(
+        [&ret](const Replayer::Event& aEvent) {
+          ret.emplace_back(toTuple(aEvent));
+        });
+    EXPECT_EQ(ret.size(), myStats.theNumEvents);
+    return ret;
+  }
+
+  //! @return the batches of events replayed into a queue.
+  static std::vector<std::vector<Tuple>> replay(Replayer&         aReplayer,
+                                                const std::size_t aBatchSize) {
+    support::Queue<std::vector<Replayer::Event>> myQueue;
+    const auto myStats = aReplayer.run(myQueue, aBatchSize);
+
+    std::vector<std::vector<Tuple>> ret;
+    std::size_t                     myNumEvents = 0;
+    while (myQueue.size() > 0) {
+      ret.emplace_back();
+      for (const auto& myEvent : myQueue.pop()) {
+        ret.back().emplace_back(toTuple(myEvent));
+      }
+      myNumEvents += ret.back().size();
+    }
+    EXPECT_EQ(myNumEvents, myStats.theNumEvents);
+    return ret;
+  }
+
+  //! @return the batches concatenated, checking that only the last is empty.
+  static std::vector<Tuple>
+  concat(const std::vector<std::vector<Tuple>>& aBatches) {
+    std::vector<Tuple> ret;
+    EXPECT_FALSE(aBatches.empty());
+    for (std::size_t i = 0; i < aBatches.size(); i++) {
+      EXPECT_EQ(i + 1 == aBatches.size(), aBatches[i].empty()) << "batch " << i;
+      ret.insert(ret.end(), aBatches[i].begin(), aBatches[i].end());
+    }
+    return ret;
+  }
+};
+
+TEST_F(TestAfdbReplayer, test_order) {
+  TimestampDataset myDataset;
+  myDataset["b"]  = {{1, true}, {3, false}, {3, true}, {5, false}};
+  myDataset["a"]  = {{3, false}, {4, true}};
+  myDataset["c"]  = {{-2, false}, {3, true}};
+  myDataset["d"]  = {};
+  myDataset["aa"] = {{5, true}};
+
+  Replayer myReplayer(myDataset, 0);
+  ASSERT_EQ(5u, myReplayer.size());
+  ASSERT_EQ(std::vector<std::string>({"a", "aa", "b", "c", "d"}),
+            std::vector<std::string>({myReplayer.key(0),
+                                      myReplayer.key(1),
+                                      myReplayer.key(2),
+                                      myReplayer.key(3),
+                                      myReplayer.key(4)}));
+
+  // equal timestamps are dispatched in the order of the keys, and the
+  // events of the same key in the order of the dataset
+  const std::vector<Tuple> myExpected({
+      {-2, 3, false},
+      {1, 2, true},
+      {3, 0, false},
+      {3, 2, false},
+      {3, 2, true},
+      {3, 3, true},
+      {4, 0, true},
+      {5, 1, true},
+      {5, 2, false},
+  });
+  ASSERT_EQ(myExpected, replay(myReplayer));
+  ASSERT_EQ(myExpected, replay(myReplayer));
+  for (const std::size_t myBatchSize : {1, 2, 4, 1024}) {
+    const auto myBatches = replay(myReplayer, myBatchSize);
+    ASSERT_EQ(myExpected, concat(myBatches));
+    for (const auto& myBatch : myBatches) {
+      ASSERT_GE(myBatchSize, myBatch.size());
+    }
+  }
+
+  Replayer myEmptyReplayer(TimestampDataset(), 0);
+  ASSERT_EQ(0u, myEmptyReplayer.size());
+  ASSERT_TRUE(replay(myEmptyReplayer).empty());
+  ASSERT_EQ(std::vector<std::vector<Tuple>>(1), replay(myEmptyReplayer, 1));
+
+  ASSERT_THROW(Replayer(myDataset, -1), std::runtime_error);
+  ASSERT_THROW(Replayer(myDataset, 0, -1), std::runtime_error);
+  support::Queue<std::vector<Replayer::Event>> myQueue;
+  ASSERT_THROW(myReplayer.run(myQueue, std::size_t(0)), std::runtime_error);
+}
+
+TEST_F(TestAfdbReplayer, test_random) {
+  // integer timestamps, so that many events have the same timestamp
+  std::mt19937                                myRng(42);
+  std::uniform_int_distribution<std::size_t>  myNumEventsRv(0, 200);
+  std::uniform_int_distribution<unsigned int> myGapRv(0, 3);
+  std::bernoulli_distribution                 myWriteRv(0.5);
+  TimestampDataset                            myDataset;
+  for (auto k = 0; k < 50; k++) {
+    auto&      myEvents    = myDataset["u" + std::to_string(k) + ",a"];
+    const auto myNumEvents = myNumEventsRv(myRng);
+    double     myTimestamp = 1577836800000;
+    for (std::size_t i = 0; i < myNumEvents; i++) {
+      myTimestamp += myGapRv(myRng);
+      myEvents.emplace_back(myTimestamp, myWriteRv(myRng));
+    }
+  }
+
+  Replayer myReplayer(myDataset, 0);
+  ASSERT_EQ(myDataset.size(), myReplayer.size());
+
+  // every event exactly once, sorted by timestamp then key then position
+  std::vector<std::tuple<double, std::uint32_t, std::size_t, bool>> mySorted;
+  for (std::uint32_t k = 0; k < myReplayer.size(); k++) {
+    const auto& myEvents = myDataset.at(myReplayer.key(k));
+    for (std::size_t i = 0; i < myEvents.size(); i++) {
+      mySorted.emplace_back(
+          std::get<0>(myEvents[i]), k, i, std::get<1>(myEvents[i]));
+    }
+  }
+  std::sort(mySorted.begin(), mySorted.end());
+  std::vector<Tuple> myExpected;
+  for (const auto& elem : mySorted) {
+    myExpected.emplace_back(
+        std::get<0>(elem), std::get<1>(elem), std::get<3>(elem));
+  }
+
+  const auto myEvents = replay(myReplayer);
+  ASSERT_EQ(myExpected, myEvents);
+  ASSERT_EQ(myEvents, replay(myReplayer));
+  for (const std::size_t myBatchSize : {1, 7, 1024}) {
+    const auto myBatches = replay(myReplayer, myBatchSize);
+    ASSERT_EQ(myExpected, concat(myBatches));
+    for (std::size_t i = 0; (i + 1) < myBatches.size(); i++) {
+      ASSERT_EQ(std::min(myBatchSize, myExpected.size() - i * myBatchSize),
+                myBatches[i].size());
+    }
+  }
+}
+
+TEST_F(TestAfdbReplayer, test_paced) {
+  // at 10x the replayer waits 100 ms between the timestamps
+  TimestampDataset myDataset;
+  myDataset["a"] = {{1000, false}, {1000, true}, {2000, false}};
+  myDataset["b"] = {{1000, true}, {2000, true}, {3000, false}};
+  Replayer myReplayer(myDataset, 10);
+
+  // the events are pushed to the queue before waiting
+  const auto myBatches = replay(myReplayer, 1024);
+  ASSERT_EQ(4u, myBatches.size());
+  ASSERT_EQ(3u, myBatches[0].size());
+  ASSERT_EQ(2u, myBatches[1].size());
+  ASSERT_EQ(1u, myBatches[2].size());
+  ASSERT_TRUE(myBatches[3].empty());
+
+  std::size_t myNumIdle   = 0;
+  std::size_t myNumEvents = 0;
+  const auto  myStats     = myReplayer.run(
+      [&myNumEvents](const Replayer::Event&) { myNumEvents++; },
+      [&myNumIdle]() { myNumIdle++; });
+  ASSERT_EQ(6u, myNumEvents);
+  ASSERT_EQ(6u, myStats.theNumEvents);
+  ASSERT_EQ(3u, myNumIdle);
+  ASSERT_DOUBLE_EQ(0.2, myStats.theTarget);
+  ASSERT_LE(0.2, myStats.theElapsed);
+}
+
+} // namespace dataset
+} // namespace uiiit
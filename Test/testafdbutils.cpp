@@ -0,0 +1,1130 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Dataset/afdb-policies.h"
+#include "Dataset/afdb-utils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace uiiit {
+namespace dataset {
+
+struct TestAfdbUtils : public ::testing::Test {
+  //! The fields of a row of the Azure function dataset.
+  using Fields = std::tuple<double,
+                            std::string,
+                            std::string,
+                            std::string,
+                            std::string,
+                            std::string,
+                            std::string,
+                            std::string,
+                            std::size_t,
+                            bool>;
+
+  TestAfdbUtils()
+      : theFilename("TO_REMOVE_afdbutils.dat")
+      , theCsvFilename("TO_REMOVE_afdbutils.csv") {
+    // noop
+  }
+
+  void SetUp() override {
+    std::remove(theFilename.c_str());
+    std::remove(theCsvFilename.c_str());
+  }
+
+  void TearDown() override {
+    std::remove(theFilename.c_str());
+    std::remove(theCsvFilename.c_str());
+  }
+
+  //! A dataset exercising the corner cases of all the formats.
+  static TimestampDataset exampleDataset() {
+    TimestampDataset ret;
+
+    // more events than the bits of a word in the bitmap of the write flags
+    auto& myMany = ret["u1,a1"];
+    for (auto i = 0; i < 150; i++) {
+      myMany.emplace_back(1577836800000.0 + i * 0.5, i % 3 == 0);
+    }
+
+    // negative timestamps and timestamps with too many decimal digits
+    ret["u2,a1"] = {{-1e9, true},
+                    {-3.25, false},
+                    {-0.1, true},
+                    {0, false},
+                    {1.0 / 3, true},
+                    {0.1 + 0.2, false},
+                    {1e300, true}};
+
+    // six decimal digits and differences needing many bytes
+    ret["u3,a2"] = {{-123.456789, false}, {0.000001, true}, {1e12 + 0.5, true}};
+
+    ret["u4,a2"] = {{42, true}};
+
+    // key without events
+    ret["a-user-with-a-longer-name,a3"];
+
+    return ret;
+  }
+
+  std::string read() const {
+    std::ifstream myFile(theFilename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(myFile),
+                       std::istreambuf_iterator<char>());
+  }
+
+  void write(const std::string& aContent) const {
+    std::ofstream myFile(theFilename, std::ios::binary | std::ios::trunc);
+    myFile << aContent;
+  }
+
+  static std::uint64_t load(const std::string& aContent,
+                            const std::size_t  aPos) {
+    return detail::loadLittleEndian(aContent.data() + aPos);
+  }
+
+  static void store(std::string&        aContent,
+                    const std::size_t   aPos,
+                    const std::uint64_t aValue) {
+    for (std::size_t i = 0; i < 8; i++) {
+      aContent[aPos + i] = static_cast<char>((aValue >> (8 * i)) & 0xff);
+    }
+  }
+
+  /**
+   * @brief Compute best-next with the cost of the look-ahead window summed
+   * one invocation at a time, as done before the prefix sums.
+   */
+  static CostOutput bestNextReference(
+      const TimestampDataset::mapped_type& aEvents,
+      const CostModel&                     aModel,
+      const std::size_t                    aLookAhead) {
+    CostOutput ret{};
+    double     myPeriod = 0;
+    for (std::size_t i = 0; (i + 1) < aEvents.size(); i++) {
+      const auto myGap = std::get<0>(aEvents[i + 1]) - std::get<0>(aEvents[i]);
+      const auto myLambda =
+          aModel.theCostExecLambda + (std::get<1>(aEvents[i]) ?
+                                          aModel.theCostWriteLambda :
+                                          aModel.theCostReadLambda);
+      auto myNextType = ret.theBestNextLastType;
+      if (ret.theBestNextLastType == CostOutput::Type::Microservice) {
+        if ((aModel.theCostWarmMu * myGap) >
+            (aModel.theCostMigrateLambda + aModel.theCostWarmLambda * myGap)) {
+          myNextType = CostOutput::Type::Stateless;
+        }
+      } else {
+        auto       myCostMu     = aModel.theCostMigrateMu + aModel.theCostExecMu;
+        auto       myCostLambda = myLambda;
+        const auto myEnd        = aLookAhead == 0 ?
+                                      aEvents.size() - 1 :
+                                      std::min(aEvents.size() - 1, i + aLookAhead);
+        for (auto j = i; j < myEnd; ++j) {
+          const auto myDuration =
+              std::get<0>(aEvents[j + 1]) - std::get<0>(aEvents[j]);
+          myCostMu +=
+              aModel.theCostExecMu + aModel.theCostWarmMu * myDuration;
+          myCostLambda += aModel.theCostExecLambda +
+                          (std::get<1>(aEvents[j + 1]) ?
+                               aModel.theCostWriteLambda :
+                               aModel.theCostReadLambda) +
+                          aModel.theCostWarmLambda * myDuration;
+          if (myCostMu < myCostLambda) {
+            break;
+          }
+        }
+        if (myCostMu < myCostLambda) {
+          myNextType = CostOutput::Type::Microservice;
+        }
+      }
+
+      auto& myCost = ret.theCosts[static_cast<unsigned int>(ExecMode::BestNext)];
+      if (myNextType != ret.theBestNextLastType) {
+        ret.theBestNextPeriods.emplace_back(myPeriod);
+        myPeriod = 0;
+      }
+      myPeriod += myGap;
+      if (ret.theBestNextLastType == CostOutput::Type::Microservice) {
+        myCost += aModel.theCostExecMu;
+        ret.theBestNextNumMu++;
+        if (myNextType == CostOutput::Type::Stateless) {
+          ret.theBestNextDurLambda += myGap;
+          myCost +=
+              aModel.theCostMigrateLambda + aModel.theCostWarmLambda * myGap;
+        } else {
+          ret.theBestNextDurMu += myGap;
+          myCost += aModel.theCostWarmMu * myGap;
+        }
+      } else if (myNextType == CostOutput::Type::Microservice) {
+        ret.theBestNextNumMu++;
+        ret.theBestNextDurMu += myGap;
+        myCost += aModel.theCostMigrateMu + aModel.theCostExecMu +
+                  aModel.theCostWarmMu * myGap;
+      } else {
+        ret.theBestNextNumLambda++;
+        ret.theBestNextDurLambda += myGap;
+        myCost += myLambda + aModel.theCostWarmLambda * myGap;
+      }
+      ret.theBestNextLastType = myNextType;
+    }
+    return ret;
+  }
+
+  /**
+   * @brief Compute the minimum cost of an app by enumerating all the
+   * schedules, starting as a stateless function.
+   */
+  static double optimalReference(const TimestampDataset::mapped_type& aEvents,
+                                 const CostModel&                     aModel) {
+    assert(aEvents.size() <= 20);
+    const std::size_t myNumSteps = aEvents.empty() ? 0 : aEvents.size() - 1;
+    auto              ret        = std::numeric_limits<double>::infinity();
+    // the bit i of the schedule is set if the app waits as microservice
+    // after the invocation i, which is served in the cheapest way between
+    // the states before and after it
+    for (std::size_t mySchedule = 0; mySchedule < (1u << myNumSteps);
+         mySchedule++) {
+      double myCost = 0;
+      bool   myMu   = false;
+      for (std::size_t i = 0; i < myNumSteps; i++) {
+        const auto myGap = std::get<0>(aEvents[i + 1]) - std::get<0>(aEvents[i]);
+        const bool myNextMu = (mySchedule >> i) & 1u;
+        const auto myServedByMu =
+            (myMu ? 0 : aModel.theCostMigrateMu) + aModel.theCostExecMu +
+            (myNextMu ? 0 : aModel.theCostMigrateLambda);
+        const auto myServedByLambda =
+            (myMu ? aModel.theCostMigrateLambda : 0) +
+            aModel.theCostExecLambda +
+            (std::get<1>(aEvents[i]) ? aModel.theCostWriteLambda :
+                                       aModel.theCostReadLambda) +
+            (myNextMu ? aModel.theCostMigrateMu : 0);
+        myCost += std::min(myServedByMu, myServedByLambda) +
+                  (myNextMu ? aModel.theCostWarmMu : aModel.theCostWarmLambda) *
+                      myGap;
+        myMu = myNextMu;
+      }
+      ret = std::min(ret, myCost);
+    }
+    return ret;
+  }
+
+  /**
+   * @brief Return the sample cost model, some corner cases, and random cost
+   * models, some of whose costs are zero, including the migrations.
+   */
+  static std::vector<CostModel> randomCostModels(const std::size_t aNumRandom,
+                                                 const unsigned    aSeed) {
+    std::mt19937                           myRng(aSeed);
+    std::uniform_real_distribution<double> myCostRv(0, 1);
+    std::bernoulli_distribution            myZeroRv(0.2);
+
+    std::vector<CostModel> ret({
+        {0, 0.6, 0.4, 5, 6.3e-3, 0, 12, 12},
+        {1, 1, 1, 2, 1, 0, 2, 1},
+        {0, 0, 0, 0, 0, 0, 0, 0},
+    });
+    const auto myCost = [&]() { return myZeroRv(myRng) ? 0 : myCostRv(myRng); };
+    for (std::size_t i = 0; i < aNumRandom; i++) {
+      ret.emplace_back(CostModel{myCost(),
+                                 myCost(),
+                                 myCost(),
+                                 myCost(),
+                                 myCost() / 10,
+                                 myCost() / 10,
+                                 10 * myCost(),
+                                 10 * myCost()});
+    }
+    return ret;
+  }
+
+  /**
+   * @brief Generate random apps whose timestamps are spaced by multiples of
+   * a given step, so that with suitable costs there are many ties.
+   */
+  static TimestampDataset randomDataset(const std::size_t aNumApps,
+                                        const std::size_t aMaxEvents,
+                                        const double      aStep,
+                                        const unsigned    aSeed) {
+    std::mt19937                          myRng(aSeed);
+    std::uniform_int_distribution<size_t> myNumEventsRv(1, aMaxEvents);
+    std::uniform_int_distribution<int>    myGapRv(0, 12);
+    std::bernoulli_distribution           myWriteRv(0.3);
+    TimestampDataset                      ret;
+    for (std::size_t a = 0; a < aNumApps; a++) {
+      auto&      myEvents    = ret["u" + std::to_string(a) + ",a"];
+      const auto myNumEvents = myNumEventsRv(myRng);
+      double     myTimestamp = 1e6;
+      for (std::size_t i = 0; i < myNumEvents; i++) {
+        // small gaps are more frequent
+        const auto myGap = myGapRv(myRng);
+        myTimestamp += aStep * (myGap > 8 ? myGap * myGap : myGap / 2);
+        myEvents.emplace_back(myTimestamp, myWriteRv(myRng));
+      }
+    }
+    return ret;
+  }
+
+  static Fields fields(const RowView& aRow) {
+    return Fields(aRow.theTimestamp,
+                  std::string(aRow.theRegion),
+                  std::string(aRow.theUser),
+                  std::string(aRow.theApp),
+                  std::string(aRow.theFunction),
+                  std::string(aRow.theBlob),
+                  std::string(aRow.theBlobType),
+                  std::string(aRow.theBlobVersion),
+                  aRow.theBlobSize,
+                  aRow.theWrite);
+  }
+
+  static Fields fields(const Row& aRow, const Dictionary& aDictionary) {
+    return Fields(aRow.theTimestamp,
+                  aDictionary[Column::Region][aRow.theRegion],
+                  aDictionary[Column::User][aRow.theUser],
+                  aDictionary[Column::App][aRow.theApp],
+                  aDictionary[Column::Function][aRow.theFunction],
+                  aDictionary[Column::Blob][aRow.theBlob],
+                  aDictionary[Column::BlobType][aRow.theBlobType],
+                  aDictionary[Column::BlobVersion][aRow.theBlobVersion],
+                  aRow.theBlobSize,
+                  aRow.theWrite);
+  }
+
+  //! @return all the rows read from the CSV file.
+  std::vector<Fields> readRows(const RowFilter& aFilter) const {
+    std::vector<Fields> ret;
+    RowReader           myReader(theCsvFilename, true, aFilter);
+    while (myReader.next()) {
+      ret.emplace_back(fields(myReader.row()));
+    }
+    return ret;
+  }
+
+  const std::string theFilename;
+  const std::string theCsvFilename;
+};
+
+TEST_F(TestAfdbUtils, test_key_index) {
+  // many users share the same app, a few users have many apps, and some
+  // codes use the high bits, with the keys repeated in random order
+  std::vector<Key> myKeys;
+  for (std::uint32_t u = 0; u < 5000; u++) {
+    myKeys.emplace_back(u, 7);
+  }
+  for (std::uint32_t a = 0; a < 1000; a++) {
+    myKeys.emplace_back(3, a);
+    myKeys.emplace_back(UINT32_MAX - a, UINT32_MAX);
+  }
+  myKeys.emplace_back(0, 0);
+  std::mt19937                               myRng(5);
+  std::uniform_int_distribution<std::size_t> myKeyRv(0, myKeys.size() - 1);
+  std::vector<Key>                           mySequence;
+  for (std::size_t i = 0; i < 3 * myKeys.size(); i++) {
+    mySequence.emplace_back(myKeys[myKeyRv(myRng)]);
+  }
+
+  // the IDs are assigned in order of first appearance
+  KeyIndex                     myIndex;
+  std::map<Key, std::uint32_t> myExpected;
+  for (const auto& myKey : mySequence) {
+    const auto myId =
+        myExpected.emplace(myKey, static_cast<std::uint32_t>(myExpected.size()))
+            .first->second;
+    ASSERT_EQ(myId, myIndex.intern(myKey));
+    ASSERT_EQ(myExpected.size(), myIndex.size());
+  }
+  ASSERT_GT(myExpected.size(), 4000u);
+
+  // the IDs do not change with the rehashes, and they are dense
+  std::vector<bool> myFound(myIndex.size(), false);
+  for (const auto& elem : myExpected) {
+    ASSERT_EQ(elem.second, myIndex.intern(elem.first));
+    ASSERT_EQ(elem.first, myIndex.key(elem.second));
+    myFound[elem.second] = true;
+  }
+  ASSERT_EQ(myExpected.size(), myIndex.size());
+  ASSERT_EQ(myFound.size(),
+            static_cast<std::size_t>(
+                std::count(myFound.begin(), myFound.end(), true)));
+}
+
+TEST_F(TestAfdbUtils, test_timestamp_dataset_round_trip) {
+  const auto myDataset = exampleDataset();
+
+  for (const auto myVersion : {1, 2, 3}) {
+    saveTimestampDataset(myDataset, theFilename, myVersion);
+    ASSERT_EQ(myDataset, loadTimestampDataset(theFilename))
+        << "version " << myVersion;
+  }
+
+  for (const auto myVersion : {2, 3}) {
+    TimestampDatasetWriter myWriter(theFilename, myVersion);
+    for (const auto& elem : myDataset) {
+      myWriter.add(elem.first, elem.second);
+    }
+    myWriter.close();
+    ASSERT_EQ(myDataset, loadTimestampDataset(theFilename))
+        << "version " << myVersion;
+  }
+
+  saveTimestampDataset(TimestampDataset(), theFilename, 3);
+  ASSERT_TRUE(loadTimestampDataset(theFilename).empty());
+
+  ASSERT_THROW(saveTimestampDataset(myDataset, theFilename, 4),
+               std::runtime_error);
+  ASSERT_THROW(TimestampDatasetWriter(theFilename, 1), std::runtime_error);
+}
+
+TEST_F(TestAfdbUtils, test_timestamp_dataset_writer_not_closed) {
+  const auto myDataset = exampleDataset();
+  for (const auto myVersion : {2, 3}) {
+    {
+      // destroyed without close(), as it happens with exceptions
+      TimestampDatasetWriter myWriter(theFilename, myVersion);
+      for (const auto& elem : myDataset) {
+        myWriter.add(elem.first, elem.second);
+      }
+    }
+    ASSERT_LT(8u, read().size());
+    ASSERT_THROW(loadTimestampDataset(theFilename), std::runtime_error)
+        << "version " << myVersion;
+    ASSERT_THROW(MappedTimestampDataset{theFilename}, std::runtime_error)
+        << "version " << myVersion;
+  }
+}
+
+TEST_F(TestAfdbUtils, test_mapped_timestamp_dataset) {
+  const auto myDataset = exampleDataset();
+  saveTimestampDataset(myDataset, theFilename, 2);
+
+  MappedTimestampDataset myMapped(theFilename);
+  ASSERT_EQ(myDataset.size(), myMapped.size());
+
+  TimestampDataset myCopy;
+  for (std::size_t i = 0; i < myMapped.size(); i++) {
+    auto&       myEvents = myCopy[std::string(myMapped.key(i))];
+    const auto& myMappedEvents = myMapped.events(i);
+    for (std::size_t j = 0; j < myMappedEvents.size(); j++) {
+      myEvents.emplace_back(myMappedEvents.timestamp(j),
+                            myMappedEvents.write(j));
+    }
+    ASSERT_EQ(&myMappedEvents, myMapped.find(myMapped.key(i)));
+  }
+  ASSERT_EQ(loadTimestampDataset(theFilename), myCopy);
+  ASSERT_EQ(nullptr, myMapped.find("u1,a2"));
+
+  for (const auto myVersion : {1, 3}) {
+    saveTimestampDataset(myDataset, theFilename, myVersion);
+    ASSERT_THROW(MappedTimestampDataset{theFilename}, std::runtime_error)
+        << "version " << myVersion;
+  }
+}
+
+TEST_F(TestAfdbUtils, test_timestamp_dataset_truncated) {
+  // version 1 has no directory: truncating it at the end of a key is valid
+  saveTimestampDataset(exampleDataset(), theFilename, 1);
+  auto myContent = read();
+  for (const std::size_t mySize : {std::size_t(1),
+                                   std::size_t(9),
+                                   std::size_t(20),
+                                   myContent.size() - 1}) {
+    write(myContent.substr(0, mySize));
+    ASSERT_THROW(loadTimestampDataset(theFilename), std::runtime_error)
+        << "version 1, size " << mySize;
+  }
+
+  for (const auto myVersion : {2, 3}) {
+    saveTimestampDataset(exampleDataset(), theFilename, myVersion);
+    myContent = read();
+    for (std::size_t mySize = 0; mySize < myContent.size(); mySize++) {
+      write(myContent.substr(0, mySize));
+      ASSERT_THROW(loadTimestampDataset(theFilename), std::runtime_error)
+          << "version " << myVersion << ", size " << mySize;
+      if (myVersion == 2) {
+        ASSERT_THROW(MappedTimestampDataset{theFilename}, std::runtime_error)
+            << "size " << mySize;
+      }
+    }
+  }
+}
+
+TEST_F(TestAfdbUtils, test_timestamp_dataset_corrupted) {
+  for (const auto myVersion : {2, 3}) {
+    saveTimestampDataset(exampleDataset(), theFilename, myVersion);
+    const auto myContent   = read();
+    const auto myTrailer   = myContent.size() - 16;
+    const auto myDirectory = load(myContent, myTrailer);
+    const auto myNumKeys   = load(myContent, myTrailer + 8);
+    ASSERT_EQ(5u, myNumKeys);
+
+    // corrupt one 64-bit word of the file and check that it is rejected
+    const auto myCheck = [&](const std::size_t   aPos,
+                             const std::uint64_t aValue) {
+      auto myCorrupted = myContent;
+      store(myCorrupted, aPos, aValue);
+      write(myCorrupted);
+      ASSERT_THROW(loadTimestampDataset(theFilename), std::runtime_error)
+          << "version " << myVersion << ", pos " << aPos << ", value "
+          << aValue;
+    };
+
+    // version number
+    myCheck(0, 1);
+    myCheck(0, myVersion == 2 ? 3 : 2);
+
+    // offset of the directory and number of keys
+    for (const auto myValue :
+         {std::uint64_t(0), std::uint64_t(7), myDirectory + 8, myTrailer + 8}) {
+      myCheck(myTrailer, myValue);
+    }
+    for (const auto myValue : {std::uint64_t(0),
+                               myNumKeys - 1,
+                               myNumKeys + 1,
+                               std::uint64_t(1) << 60,
+                               UINT64_MAX}) {
+      myCheck(myTrailer + 8, myValue);
+    }
+
+    // offset, number of events, and size of the name of the first entry
+    for (const auto myValue :
+         {std::uint64_t(0), std::uint64_t(7), myDirectory, UINT64_MAX}) {
+      myCheck(myDirectory, myValue);
+    }
+    for (const auto myValue : {myDirectory, UINT64_MAX}) {
+      myCheck(myDirectory + 8, myValue);
+    }
+    for (const auto myValue : {myTrailer, UINT64_MAX}) {
+      myCheck(myDirectory + 16, myValue);
+    }
+  }
+}
+
+TEST_F(TestAfdbUtils, test_timestamp_dataset_corrupted_v3) {
+  TimestampDataset myDataset;
+  myDataset["u1,a1"] = {{1, true}, {2, false}, {3.5, true}};
+  saveTimestampDataset(myDataset, theFilename, 3);
+  const auto myContent   = read();
+  const auto myDirectory = load(myContent, myContent.size() - 16);
+  ASSERT_EQ(8u, load(myContent, myDirectory));
+
+  // the block starts with the number of decimal digits, then the varints
+  auto myCorrupted = myContent;
+  myCorrupted[8]   = 7;
+  write(myCorrupted);
+  ASSERT_THROW(loadTimestampDataset(theFilename), std::runtime_error);
+
+  // varint not terminated before the directory
+  myCorrupted = myContent;
+  for (auto i = 9u; i < myDirectory; i++) {
+    myCorrupted[i] = '\xff';
+  }
+  write(myCorrupted);
+  ASSERT_THROW(loadTimestampDataset(theFilename), std::runtime_error);
+
+  // fewer varints than events
+  myCorrupted = myContent;
+  store(myCorrupted, myDirectory + 8, 4);
+  write(myCorrupted);
+  ASSERT_THROW(loadTimestampDataset(theFilename), std::runtime_error);
+}
+
+TEST_F(TestAfdbUtils, test_cost_best_next_look_ahead) {
+  // exec mu, exec/read/write lambda, warm mu/lambda, migrate mu/lambda
+  const std::vector<CostModel> myCostModels({
+      {1, 1, 1, 2, 1, 0, 2, 1},
+      {0.3, 0.1, 0.2, 0.4, 0.1, 0, 0.6, 0.3},
+      {0.1, 0.2, 0.1, 0.3, 0.3, 0.1, 0.7, 0.2},
+      // the same cost per invocation while reading, up to rounding errors
+      {0.3, 0.1, 0.2, 0.2, 0.1, 0.1, 0, 0.3},
+      {0.3, 0.1, 0.2, 0.5, 0.1, 0.1, 0, 0.3},
+      {0, 0.6, 0.4, 5, 6.3e-3, 0, 12, 12},
+      {0, 0, 0, 0, 0, 0, 0, 0},
+  });
+
+  // integer and decimal steps make ties likely, with exact or rounded sums
+  std::vector<TimestampDataset> myDatasets;
+  myDatasets.emplace_back(randomDataset(50, 300, 1, 1));
+  myDatasets.emplace_back(randomDataset(50, 300, 0.1, 2));
+  myDatasets.emplace_back(randomDataset(5, 1500, 1, 3));
+  myDatasets.emplace_back(randomDataset(5, 1500, 0.1, 4));
+  myDatasets.emplace_back(randomDataset(20, 300, 123.456, 5));
+
+  for (const std::size_t myLookAhead : {1, 3, 500, 0}) {
+    for (const auto& myDataset : myDatasets) {
+      const auto myOutputs = cost(myDataset, myCostModels, true, 2, myLookAhead);
+      ASSERT_EQ(myDataset.size(), myOutputs.size());
+      for (const auto& elem : myDataset) {
+        const auto& myEvents = elem.second;
+        for (std::size_t m = 0; m < myCostModels.size(); m++) {
+          const auto& myOut = myOutputs.at(elem.first)[m];
+          const auto  myExpected =
+              bestNextReference(myEvents, myCostModels[m], myLookAhead);
+          std::stringstream myMsg;
+          myMsg << "look-ahead " << myLookAhead << ", app " << elem.first
+                << ", cost model " << m;
+          ASSERT_EQ(myExpected.theBestNextNumMu, myOut.theBestNextNumMu)
+              << myMsg.str();
+          ASSERT_EQ(myExpected.theBestNextNumLambda,
+                    myOut.theBestNextNumLambda)
+              << myMsg.str();
+          ASSERT_EQ(myExpected.theBestNextDurMu, myOut.theBestNextDurMu)
+              << myMsg.str();
+          ASSERT_EQ(myExpected.theBestNextDurLambda,
+                    myOut.theBestNextDurLambda)
+              << myMsg.str();
+          ASSERT_EQ(myExpected.theBestNextLastType, myOut.theBestNextLastType)
+              << myMsg.str();
+          ASSERT_EQ(myExpected.theBestNextPeriods, myOut.theBestNextPeriods)
+              << myMsg.str();
+          ASSERT_EQ(
+              myExpected.theCosts[static_cast<unsigned int>(ExecMode::BestNext)],
+              myOut.theCosts[static_cast<unsigned int>(ExecMode::BestNext)])
+              << myMsg.str();
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TestAfdbUtils, test_cost_optimal) {
+  const auto myCostModels = randomCostModels(50, 42);
+  const auto myDataset  = randomDataset(200, 12, 0.7, 6);
+  const auto myOutputs  = cost(myDataset, myCostModels, false, 2);
+  const auto myCostOf   = [](const CostOutput& aOut, const ExecMode aMode) {
+    return aOut.theCosts[static_cast<unsigned int>(aMode)];
+  };
+  for (const auto& elem : myDataset) {
+    for (std::size_t m = 0; m < myCostModels.size(); m++) {
+      const auto& myModel    = myCostModels[m];
+      const auto& myOut      = myOutputs.at(elem.first)[m];
+      const auto  myOptimal  = myCostOf(myOut, ExecMode::Optimal);
+      const auto  myExpected = optimalReference(elem.second, myModel);
+      // the sums are done in a different order
+      const auto myTolerance = 1e-9 * (1 + std::abs(myExpected));
+      std::stringstream myMsg;
+      myMsg << "app " << elem.first << ", cost model " << m;
+
+      ASSERT_NEAR(myExpected, myOptimal, myTolerance) << myMsg.str();
+      ASSERT_LE(myOptimal, myCostOf(myOut, ExecMode::BestNext) + myTolerance)
+          << myMsg.str();
+      ASSERT_LE(myOptimal,
+                myCostOf(myOut, ExecMode::AlwaysLambda) + myTolerance)
+          << myMsg.str();
+      // always-mu does not pay the initial migration to microservice
+      ASSERT_LE(myOptimal,
+                myCostOf(myOut, ExecMode::AlwaysMu) + myModel.theCostMigrateMu +
+                    myTolerance)
+          << myMsg.str();
+      ASSERT_NEAR(myCostOf(myOut, ExecMode::BestNext) - myOptimal,
+                  myOut.bestNextGap(),
+                  myTolerance)
+          << myMsg.str();
+    }
+  }
+}
+
+TEST_F(TestAfdbUtils, test_load_cost_models) {
+  ASSERT_THROW(loadCostModels(theFilename), std::runtime_error);
+
+  write("# exec-mu,exec-lambda,read,write,warm-mu,warm-lambda,migrate\n"
+        "1:2,0.6,0.4,5,0.1:0.2:0.3,0,12,12\n"
+        "\n"
+        "0,0,0,0,0,0,0,0\n");
+  std::vector<std::string> myModels;
+  for (const auto& myModel : loadCostModels(theFilename)) {
+    myModels.emplace_back(myModel.toString());
+  }
+  // the values of the first fields change first
+  ASSERT_EQ(std::vector<std::string>({
+                "1,0.6,0.4,5,0.1,0,12,12",
+                "2,0.6,0.4,5,0.1,0,12,12",
+                "1,0.6,0.4,5,0.2,0,12,12",
+                "2,0.6,0.4,5,0.2,0,12,12",
+                "1,0.6,0.4,5,0.3,0,12,12",
+                "2,0.6,0.4,5,0.3,0,12,12",
+                "0,0,0,0,0,0,0,0",
+            }),
+            myModels);
+
+  for (const std::string myMalformed : {"1,0.6,0.4,5,0.1,0,12",
+                                        "1,0.6,0.4,5,0.1,0,12,12,1",
+                                        "1,0.6,0.4,5,abc,0,12,12",
+                                        "1:x,0.6,0.4,5,0.1,0,12,12",
+                                        " # not a comment"}) {
+    write("0,0,0,0,0,0,0,0\n" + myMalformed + "\n");
+    ASSERT_THROW(loadCostModels(theFilename), std::runtime_error)
+        << myMalformed;
+  }
+}
+
+TEST_F(TestAfdbUtils, test_policy_ski_rental) {
+  const auto myCostModels = randomCostModels(50, 43);
+  const auto myCostOf     = [](const CostOutput& aOut, const ExecMode aMode) {
+    return aOut.theCosts[static_cast<unsigned int>(aMode)];
+  };
+
+  // short apps, compared with the brute force, and long apps
+  for (const auto& myDataset : {randomDataset(200, 12, 0.7, 7),
+                                randomDataset(50, 500, 3.1, 8)}) {
+    const auto myOutputs =
+        cost(myDataset, myCostModels, false, 2, 500, {"ski-rental"});
+    for (const auto& elem : myDataset) {
+      for (std::size_t m = 0; m < myCostModels.size(); m++) {
+        const auto& myModel   = myCostModels[m];
+        const auto& myOut     = myOutputs.at(elem.first)[m];
+        const auto  myOptimal = elem.second.size() <= 12 ?
+                                    optimalReference(elem.second, myModel) :
+                                    myCostOf(myOut, ExecMode::Optimal);
+
+        const auto        myTolerance = 1e-9 * (1 + myOptimal);
+        std::stringstream myMsg;
+        myMsg << "app " << elem.first << ", cost model " << m;
+
+        ASSERT_EQ(1u, myOut.thePolicyCosts.size());
+        ASSERT_GE(myOut.thePolicyCosts[0], myOptimal - myTolerance)
+            << myMsg.str();
+        // a stateless function cannot migrate while waiting, hence there is
+        // no bound if waiting as microservice is cheaper
+        if (myModel.theCostWarmMu >= myModel.theCostWarmLambda) {
+          ASSERT_LE(myOut.thePolicyCosts[0],
+                    2 * myOptimal + myModel.theCostMigrateMu +
+                        myModel.theCostMigrateLambda + myTolerance)
+              << myMsg.str();
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TestAfdbUtils, test_policy_randomized_ski_rental) {
+  // every invocation migrates to microservice, whose timeout is the threshold
+  const CostModel myCostModel{0, 1, 0, 0, 1, 0, 0, 1};
+
+  const auto myThresholds = [&myCostModel](const std::string& aDescription,
+                                           const std::size_t  aApp) {
+    auto                myPolicy = Policy::fromString(aDescription,
+                                                      myCostModel,
+                                                      aApp);
+    std::vector<double> ret;
+    for (auto i = 0; i < 10000; i++) {
+      const auto myDecision = myPolicy->decide(false, false);
+      EXPECT_TRUE(myDecision.theMicroservice);
+      ret.emplace_back(myDecision.theTimeout);
+      myPolicy->observe(2);
+    }
+    return ret;
+  };
+
+  const auto myExpected = myThresholds("randomized-ski-rental(7)", 1);
+  ASSERT_EQ(myExpected, myThresholds("randomized-ski-rental(7)", 1));
+  ASSERT_NE(myExpected, myThresholds("randomized-ski-rental(7)", 2));
+  ASSERT_NE(myExpected, myThresholds("randomized-ski-rental(8)", 1));
+  ASSERT_EQ(myThresholds("randomized-ski-rental", 1),
+            myThresholds("randomized-ski-rental(0)", 1));
+  ASSERT_EQ(std::vector<double>(10000, 1), myThresholds("ski-rental", 1));
+
+  // the density is proportional to exp(x) in [0, 1], hence the mean is
+  // 1 / (e - 1)
+  double mySum = 0;
+  for (const auto myThreshold : myExpected) {
+    ASSERT_LE(0, myThreshold);
+    ASSERT_GE(1, myThreshold);
+    mySum += myThreshold;
+  }
+  ASSERT_NEAR(1 / (std::exp(1.0) - 1), mySum / myExpected.size(), 0.01);
+}
+
+TEST_F(TestAfdbUtils, test_policy_ewma) {
+  // as a microservice a write is cheaper if the gap is smaller than 10,
+  // while a read is never cheaper
+  const CostModel myCostModel{1, 0, 0.5, 2, 0.1, 0, 5, 3};
+
+  EwmaPolicy myPolicy(myCostModel, 0.5);
+  for (const auto myWrite : {false, true}) {
+    const auto myDecision = myPolicy.decide(false, myWrite);
+    ASSERT_FALSE(myDecision.theMicroservice);
+  }
+
+  // prediction 5
+  myPolicy.observe(5);
+  ASSERT_FALSE(myPolicy.decide(false, false).theMicroservice);
+  auto myDecision = myPolicy.decide(false, true);
+  ASSERT_TRUE(myDecision.theMicroservice);
+  ASSERT_DOUBLE_EQ(30, myDecision.theTimeout);
+
+  // prediction 0.5 * 25 + 0.5 * 5 = 15
+  myPolicy.observe(25);
+  ASSERT_FALSE(myPolicy.decide(true, true).theMicroservice);
+
+  // prediction 0.5 * 1 + 0.5 * 15 = 8
+  myPolicy.observe(1);
+  ASSERT_TRUE(myPolicy.decide(true, true).theMicroservice);
+
+  // only the last gap counts with alpha = 1
+  EwmaPolicy myLastPolicy(myCostModel, 1);
+  myLastPolicy.observe(100);
+  myLastPolicy.observe(9);
+  ASSERT_TRUE(myLastPolicy.decide(false, true).theMicroservice);
+
+  ASSERT_THROW(EwmaPolicy(myCostModel, 0), std::runtime_error);
+  ASSERT_THROW(EwmaPolicy(myCostModel, 1.5), std::runtime_error);
+}
+
+TEST_F(TestAfdbUtils, test_policy_from_string) {
+  const CostModel myCostModel;
+  for (const auto& myDescription : {"ski-rental",
+                                    "randomized-ski-rental",
+                                    "randomized-ski-rental(7)",
+                                    "ewma",
+                                    "ewma(0.3)",
+                                    "ewma(1)"}) {
+    ASSERT_NE(nullptr, Policy::fromString(myDescription, myCostModel, 0))
+        << myDescription;
+  }
+  ASSERT_NE(nullptr,
+            dynamic_cast<EwmaPolicy*>(
+                Policy::fromString("ewma(0.3)", myCostModel, 0).get()));
+  ASSERT_NE(nullptr,
+            dynamic_cast<RandomizedSkiRentalPolicy*>(
+                Policy::fromString("randomized-ski-rental(7)", myCostModel, 0)
+                    .get()));
+
+  for (const auto& myDescription : {"",
+                                    "foo",
+                                    "ski-rental(3)",
+                                    "ski-rental()",
+                                    "ewma(0)",
+                                    "ewma(1.5)",
+                                    "ewma(x)",
+                                    "ewma(0.5x)",
+                                    "ewma()",
+                                    "ewma(",
+                                    "ewma(0.3)x",
+                                    "randomized-ski-rental(abc)",
+                                    "randomized-ski-rental(-1)",
+                                    "randomized-ski-rental(1e3)",
+                                    "randomized-ski-rental(99999999999999999999)"}) {
+    ASSERT_THROW(Policy::fromString(myDescription, myCostModel, 0),
+                 std::runtime_error)
+        << myDescription;
+  }
+  ASSERT_THROW(cost(TimestampDataset(), CostModel(), false, 1, 500, {"foo"}),
+               std::runtime_error);
+}
+
+TEST_F(TestAfdbUtils, test_mapped_dataset_chunks) {
+  const std::string myHeader =
+      "timestamp,region,user,app,function,blob,blobtype,blobversion,"
+      "blobsize,read,write\n";
+  std::vector<std::string> myLines;
+  std::vector<bool>        myValid;
+  for (auto i = 0; i < 40; i++) {
+    const auto myTimestamp = std::to_string(1577836800000 + i);
+    if (i % 7 == 3) {
+      myLines.emplace_back(myTimestamp + ",r0,u0,a0\n");
+    } else if (i % 7 == 5) {
+      myLines.emplace_back(myTimestamp + ",r0,u0,a0,f,b,t,v,1,True,True\n");
+    } else if (i % 11 == 6) {
+      myLines.emplace_back("x,r0,u0,a0,f,b,t,v,1,True,False\n");
+    } else {
+      myLines.emplace_back(myTimestamp + ",r" + std::to_string(i % 2) +
+                           ",u0,a" + std::to_string(i % 3) + ",f,b,t,v," +
+                           std::to_string(i) + ",False,True\n");
+    }
+    myValid.emplace_back(i % 7 != 3 and i % 7 != 5 and i % 11 != 6);
+  }
+
+  // the invalid rows are not matching, but only those with the wrong
+  // number of fields or an invalid timestamp are detected
+  RowFilter myFilter;
+  myFilter.theApps = {"a1", "a2"};
+
+  // the empty line is moved through the whole file, hence it ends up on
+  // either side of every boundary between chunks
+  for (std::size_t e = 0; e <= myLines.size(); e++) {
+    {
+      std::ofstream myFile(theCsvFilename);
+      myFile << myHeader;
+      for (std::size_t i = 0; i < myLines.size(); i++) {
+        myFile << (i == e ? "\n" : "") << myLines[i];
+      }
+    }
+
+    const auto               myExpected         = readRows(RowFilter());
+    const auto               myExpectedFiltered = readRows(myFilter);
+    std::vector<std::size_t> myExpectedErrors;
+    std::vector<std::size_t> myExpectedFilteredErrors;
+    for (std::size_t i = 0; i < e; i++) {
+      if (not myValid[i]) {
+        myExpectedErrors.emplace_back(i + 1);
+        if (i % 7 != 5) {
+          myExpectedFilteredErrors.emplace_back(i + 1);
+        }
+      }
+    }
+    ASSERT_EQ(static_cast<std::size_t>(std::count(
+                  myValid.begin(), myValid.begin() + e, true)),
+              myExpected.size());
+
+    for (const auto myNumThreads : {1u, 3u, 8u}) {
+      std::stringstream myMsg;
+      myMsg << "empty line " << e << ", threads " << myNumThreads;
+
+      MappedDataset myDataset(
+          theCsvFilename, true, myNumThreads, RowFilter(), 1);
+      std::vector<Fields> myRows;
+      for (const auto& myRow : myDataset.rows()) {
+        myRows.emplace_back(fields(myRow));
+      }
+      ASSERT_EQ(myExpected, myRows) << myMsg.str();
+
+      std::vector<std::size_t> myErrors;
+      for (const auto& myError : myDataset.errors()) {
+        myErrors.emplace_back(myError.first);
+      }
+      ASSERT_EQ(myExpectedErrors, myErrors) << myMsg.str();
+
+      MappedDataset myFiltered(theCsvFilename, true, myNumThreads, myFilter, 1);
+      myRows.clear();
+      for (const auto& myRow : myFiltered.rows()) {
+        myRows.emplace_back(fields(myRow));
+      }
+      ASSERT_EQ(myExpectedFiltered, myRows) << myMsg.str();
+
+      myErrors.clear();
+      for (const auto& myError : myFiltered.errors()) {
+        myErrors.emplace_back(myError.first);
+      }
+      ASSERT_EQ(myExpectedFilteredErrors, myErrors) << myMsg.str();
+    }
+  }
+}
+
+TEST_F(TestAfdbUtils, test_count_intervals) {
+  using Series = std::vector<std::pair<std::uint64_t, std::size_t>>;
+
+  std::vector<std::uint64_t> myBegins;
+  std::vector<std::uint64_t> myEnds;
+  Series                     mySeries;
+  countIntervals(myBegins, myEnds, 0, mySeries);
+  countIntervals(myBegins, myEnds, 10, mySeries);
+  ASSERT_TRUE(mySeries.empty());
+
+  ASSERT_THROW(countIntervals({1, 2}, {3}, 0, mySeries), std::runtime_error);
+  ASSERT_THROW(countIntervals({5}, {3}, 0, mySeries), std::runtime_error);
+
+  // the timestamps are multiples of 5, with many ties and singletons
+  std::mt19937                                 myRng(11);
+  std::uniform_int_distribution<std::uint64_t> myBeginRv(200, 400);
+  std::uniform_int_distribution<std::uint64_t> myLengthRv(0, 20);
+  for (const auto mySingletons : {0.0, 0.3, 1.0}) {
+    std::bernoulli_distribution mySingletonRv(mySingletons);
+    myBegins.clear();
+    myEnds.clear();
+    for (auto i = 0; i < 300; i++) {
+      myBegins.emplace_back(myBeginRv(myRng) * 5);
+      myEnds.emplace_back(myBegins.back() +
+                          (mySingletonRv(myRng) ? 0 : myLengthRv(myRng) * 5));
+    }
+    const auto myMinBegin = *std::min_element(myBegins.begin(), myBegins.end());
+    const auto myMaxEnd   = *std::max_element(myEnds.begin(), myEnds.end());
+    const auto myCount    = [&](const std::uint64_t aTimestamp) {
+      std::size_t ret = 0;
+      for (std::size_t i = 0; i < myBegins.size(); i++) {
+        ret += myBegins[i] <= aTimestamp and aTimestamp < myEnds[i] ? 1 : 0;
+      }
+      return ret;
+    };
+
+    // one sample at every timestamp with events
+    std::set<std::uint64_t> myTimestamps(myBegins.begin(), myBegins.end());
+    myTimestamps.insert(myEnds.begin(), myEnds.end());
+    Series myExpected;
+    for (const auto myTimestamp : myTimestamps) {
+      myExpected.emplace_back(myTimestamp, myCount(myTimestamp));
+    }
+    mySeries.clear();
+    countIntervals(myBegins, myEnds, 0, mySeries);
+    ASSERT_EQ(myExpected, mySeries) << "singletons " << mySingletons;
+
+    // some resolutions hit the events, the last one only has two samples
+    for (const std::uint64_t myResolution : {1, 5, 7, 10, 100, 10000}) {
+      myExpected.clear();
+      for (auto t = myMinBegin / myResolution * myResolution;;
+           t += myResolution) {
+        myExpected.emplace_back(t, myCount(t));
+        if (t >= myMaxEnd) {
+          break;
+        }
+      }
+      ASSERT_EQ(0u, myExpected.back().second);
+      mySeries.clear();
+      countIntervals(myBegins, myEnds, myResolution, mySeries);
+      ASSERT_EQ(myExpected, mySeries)
+          << "singletons " << mySingletons << ", resolution " << myResolution;
+    }
+  }
+}
+
+TEST_F(TestAfdbUtils, test_filters) {
+  // some users are named as apps, and some apps are prefixes of others, so
+  // that the app of a key must be matched after the comma
+  const std::vector<std::string> myRegions({"r0", "r1", "r2"});
+  const std::vector<std::string> myUsers({"u0", "u1", "a1", "a10"});
+  const std::vector<std::string> myApps({"a0", "a1", "a10", "u1"});
+
+  std::mt19937                                myRng(7);
+  std::uniform_int_distribution<std::size_t>  myIndexRv(0, 3);
+  std::uniform_int_distribution<unsigned int> myGapRv(0, 2);
+  std::bernoulli_distribution                 myWriteRv(0.5);
+  std::vector<double>                         myTimestamps;
+  {
+    std::ofstream myFile(theCsvFilename);
+    myFile << "timestamp,region,user,app,function,blob,blobtype,blobversion,"
+              "blobsize,read,write\n";
+    // the timestamps are increasing, with duplicates
+    double myTimestamp = 1577836800000;
+    for (auto i = 0; i < 2000; i++) {
+      myTimestamp += myGapRv(myRng) * 0.5;
+      myTimestamps.emplace_back(myTimestamp);
+      myFile << std::to_string(myTimestamp) << ','
+             << myRegions[myIndexRv(myRng) % myRegions.size()] << ','
+             << myUsers[myIndexRv(myRng)] << ',' << myApps[myIndexRv(myRng)]
+             << ",f" << (i % 7) << ",b" << (i % 11) << ",type" << (i % 2)
+             << ",v" << (i % 3) << ',' << (i * 10) << ','
+             << (myWriteRv(myRng) ? "False,True" : "True,False") << '\n';
+    }
+  }
+
+  // @return a timestamp from aIndex onwards that appears more than once
+  const auto myDuplicate = [&myTimestamps](std::size_t aIndex) {
+    while (myTimestamps[aIndex] != myTimestamps[aIndex + 1]) {
+      aIndex++;
+    }
+    return myTimestamps[aIndex];
+  };
+
+  std::vector<RowFilter> myFilters(7);
+  myFilters[1].theRegions = {"r1"};
+  myFilters[2].theApps    = {"a1"};
+  myFilters[3].theApps    = {"a0", "u1"};
+  myFilters[4].theBegin   = myDuplicate(400);
+  myFilters[4].theEnd     = myDuplicate(1400);
+  myFilters[5].theRegions = {"r0", "r2"};
+  myFilters[5].theApps    = {"a10"};
+  myFilters[5].theBegin   = myDuplicate(100);
+  myFilters[5].theEnd     = myDuplicate(1900);
+  myFilters[6].theBegin   = myTimestamps[1000];
+  myFilters[6].theEnd     = myTimestamps[1000];
+
+  const auto myMatch = [](const RowFilter& aFilter, const Fields& aRow) {
+    return std::get<0>(aRow) >= aFilter.theBegin and
+           std::get<0>(aRow) < aFilter.theEnd and
+           (aFilter.theRegions.empty() or
+            aFilter.theRegions.count(std::get<1>(aRow)) > 0) and
+           (aFilter.theApps.empty() or
+            aFilter.theApps.count(std::get<3>(aRow)) > 0);
+  };
+
+  const auto myRows = readRows(RowFilter());
+  ASSERT_EQ(myTimestamps.size(), myRows.size());
+
+  // the whole dataset in all the versions of the timestamp dataset format
+  Dictionary myFullDictionary;
+  RowReader  myFullReader(theCsvFilename, true);
+  const auto myFullDataset = toTimestampDataset(myFullReader, myFullDictionary);
+  std::vector<std::string> myTimestampFilenames;
+  for (const auto myVersion : {1, 2, 3}) {
+    myTimestampFilenames.emplace_back(theFilename + std::to_string(myVersion));
+    saveTimestampDataset(
+        myFullDataset, myTimestampFilenames.back(), myVersion);
+  }
+
+  for (std::size_t f = 0; f < myFilters.size(); f++) {
+    const auto&         myFilter = myFilters[f];
+    std::vector<Fields> myExpected;
+    TimestampDataset    myExpectedDataset;
+    for (const auto& myRow : myRows) {
+      if (myMatch(myFilter, myRow)) {
+        myExpected.emplace_back(myRow);
+        myExpectedDataset[std::get<2>(myRow) + "," + std::get<3>(myRow)]
+            .emplace_back(std::get<0>(myRow), std::get<9>(myRow));
+      }
+    }
+    ASSERT_EQ(f == 6, myExpected.empty()) << "filter " << f;
+
+    ASSERT_EQ(myExpected, readRows(myFilter)) << "filter " << f;
+
+    Dictionary          myDictionary;
+    const auto          myColumns =
+        loadColumns(theCsvFilename, true, myDictionary, 2, myFilter);
+    std::vector<Fields> myColumnRows;
+    for (std::size_t i = 0; i < myColumns.size(); i++) {
+      myColumnRows.emplace_back(fields(myColumns.row(i), myDictionary));
+    }
+    ASSERT_EQ(myExpected, myColumnRows) << "filter " << f;
+
+    for (const auto& myTimestampFilename : myTimestampFilenames) {
+      if (myFilter.theRegions.empty()) {
+        ASSERT_EQ(myExpectedDataset,
+                  loadTimestampDataset(myTimestampFilename, myFilter))
+            << "filter " << f << ", file " << myTimestampFilename;
+      } else {
+        ASSERT_THROW(loadTimestampDataset(myTimestampFilename, myFilter),
+                     std::runtime_error);
+      }
+    }
+  }
+
+  for (const auto& myTimestampFilename : myTimestampFilenames) {
+    std::remove(myTimestampFilename.c_str());
+  }
+}
+
+} // namespace dataset
+} // namespace uiiit
@@ -0,0 +1,168 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/batchrandom.h"
+#include "Support/random.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace uiiit {
+namespace support {
+
+struct TestBatchRandom : public ::testing::Test {
+  //! Draw aSize values alternating single draws and batches of various sizes.
+  static std::vector<double> mixed(RealRvInterface& aRv,
+                                   const std::size_t aSize) {
+    std::vector<double> ret(aSize);
+    std::size_t         myDone  = 0;
+    std::size_t         myBatch = 0;
+    while (myDone < aSize) {
+      if (myBatch % 2 == 0) {
+        ret[myDone++] = aRv();
+      } else {
+        const auto myLen = std::min(aSize - myDone, myBatch);
+        aRv.fill(ret.data() + myDone, myLen);
+        myDone += myLen;
+      }
+      myBatch++;
+    }
+    return ret;
+  }
+
+  static double mean(const std::vector<double>& aValues) {
+    return std::accumulate(aValues.begin(), aValues.end(), 0.0) /
+           aValues.size();
+  }
+};
+
+TEST_F(TestBatchRandom, test_xoshiro_seed) {
+  std::set<std::uint64_t> myFirst;
+  for (std::size_t a = 0; a < 3; a++) {
+    for (std::size_t b = 0; b < 3; b++) {
+      for (std::size_t c = 0; c < 3; c++) {
+        Xoshiro256pp myGenerator(a, b, c);
+        myFirst.emplace(myGenerator());
+      }
+    }
+  }
+  ASSERT_EQ(27, myFirst.size());
+
+  Xoshiro256pp myGenerator1(1, 2, 3);
+  Xoshiro256pp myGenerator2(1, 2, 3);
+  for (auto i = 0; i < 100; i++) {
+    ASSERT_EQ(myGenerator1(), myGenerator2());
+  }
+
+  myGenerator2.jump();
+  ASSERT_NE(myGenerator1.state(), myGenerator2.state());
+  myGenerator1.jump();
+  ASSERT_EQ(myGenerator1.state(), myGenerator2.state());
+  myGenerator1.longJump();
+  ASSERT_NE(myGenerator1.state(), myGenerator2.state());
+}
+
+TEST_F(TestBatchRandom, test_fast_log) {
+  for (auto x = 1e-300; x < 1e300; x *= 1.37) {
+    ASSERT_NEAR(std::log(x), detail::fastLog(x), 1e-14 * std::abs(std::log(x)))
+        << x;
+  }
+  for (auto x = 0.5; x < 2; x += 1e-4) {
+    ASSERT_NEAR(std::log(x), detail::fastLog(x), 1e-15) << x;
+  }
+  ASSERT_EQ(0, detail::fastLog(1));
+  ASSERT_NEAR(-36.7368005696771, detail::fastLog(0x1.0p-53), 1e-13);
+}
+
+TEST_F(TestBatchRandom, test_fill_same_as_single_draws) {
+  UniformRv myRv1(0, 1, 1, 2, 3);
+  UniformRv myRv2(0, 1, 1, 2, 3);
+  ASSERT_EQ(mixed(myRv1, 1000), mixed(myRv2, 1000));
+
+  std::vector<double> myExpected(1000);
+  std::vector<double> myActual(1000);
+  for (auto& elem : myExpected) {
+    elem = myRv1();
+  }
+  myRv2.fill(myActual.data(), myActual.size());
+  ASSERT_EQ(myExpected, myActual);
+
+  ConstantRv myConstant(42);
+  myConstant.fill(myActual.data(), myActual.size());
+  ASSERT_EQ(std::vector<double>(1000, 42), myActual);
+}
+
+TEST_F(TestBatchRandom, test_batch_uniform) {
+  ASSERT_THROW(BatchUniformRv(1, 0, 0, 0, 0), std::runtime_error);
+
+  BatchUniformRv myRv(-10, 10, 0, 0, 0);
+  const auto     myValues = mixed(myRv, 100000);
+  ASSERT_NEAR(0, mean(myValues), 0.1);
+  for (const auto& myValue : myValues) {
+    ASSERT_GE(myValue, -10);
+    ASSERT_LT(myValue, 10);
+  }
+
+  // the sequence only depends on the seed, not on how it is drawn
+  BatchUniformRv      myRv1(-10, 10, 1, 2, 3);
+  BatchUniformRv      myRv2(-10, 10, 1, 2, 3);
+  BatchUniformRv      myRv3(-10, 10, 1, 2, 4);
+  std::vector<double> myExpected(1001);
+  myRv1.fill(myExpected.data(), myExpected.size());
+  ASSERT_EQ(myExpected, mixed(myRv2, myExpected.size()));
+  ASSERT_NE(myExpected, mixed(myRv3, myExpected.size()));
+}
+
+TEST_F(TestBatchRandom, test_batch_exponential) {
+  ASSERT_THROW(BatchExponentialRv(0, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(BatchExponentialRv(-1, 0, 0, 0), std::runtime_error);
+
+  BatchExponentialRv  myRv(0.1, 0, 0, 0);
+  std::vector<double> myValues(100000);
+  myRv.fill(myValues.data(), myValues.size());
+  ASSERT_NEAR(10, mean(myValues), 0.2);
+  for (const auto& myValue : myValues) {
+    ASSERT_GE(myValue, 0);
+    ASSERT_TRUE(std::isfinite(myValue));
+  }
+
+  BatchExponentialRv myRv1(2, 1, 2, 3);
+  BatchExponentialRv myRv2(2, 1, 2, 3);
+  ASSERT_EQ(mixed(myRv1, 777), mixed(myRv2, 777));
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,160 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/counterrandom.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace uiiit {
+namespace support {
+
+struct TestCounterRandom : public ::testing::Test {};
+
+TEST_F(TestCounterRandom, test_philox_known_answers) {
+  // from the Random123 distribution
+  using A4 = std::array<std::uint32_t, 4>;
+  using A2 = std::array<std::uint32_t, 2>;
+  EXPECT_EQ(A4({0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}),
+            detail::philox4x32(A4({0, 0, 0, 0}), A2({0, 0})));
+  EXPECT_EQ(A4({0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}),
+            detail::philox4x32(
+                A4({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}),
+                A2({0xffffffff, 0xffffffff})));
+  EXPECT_EQ(A4({0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}),
+            detail::philox4x32(
+                A4({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}),
+                A2({0xa4093822, 0x299f31d0})));
+}
+
+TEST_F(TestCounterRandom, test_philox_generator) {
+  static_assert(sizeof(Philox4x32) == 24, "unexpected Philox4x32 size");
+
+  Philox4x32                 myGenerator(1, 2, 3);
+  std::vector<std::uint64_t> mySequence;
+  for (std::size_t i = 0; i < 100; i++) {
+    mySequence.emplace_back(myGenerator());
+  }
+  ASSERT_EQ(100u, myGenerator.index());
+  ASSERT_EQ(100u, std::set<std::uint64_t>(mySequence.begin(),
+                                          mySequence.end())
+                      .size());
+
+  // random access
+  for (std::size_t i = 0; i < mySequence.size(); i++) {
+    ASSERT_EQ(mySequence[i], myGenerator.at(i));
+  }
+  myGenerator.seek(37);
+  ASSERT_EQ(mySequence[37], myGenerator());
+  myGenerator.discard(10);
+  ASSERT_EQ(mySequence[48], myGenerator());
+
+  // different seeds yield different streams
+  std::set<std::uint64_t> myFirst;
+  for (std::size_t a = 0; a < 3; a++) {
+    for (std::size_t b = 0; b < 3; b++) {
+      for (std::size_t c = 0; c < 3; c++) {
+        myFirst.emplace(Philox4x32(a, b, c)());
+      }
+    }
+  }
+  ASSERT_EQ(27u, myFirst.size());
+
+  // usable with the standard distributions
+  Philox4x32                       myOther(1, 2, 3);
+  std::uniform_int_distribution<> myDist(1, 6);
+  for (std::size_t i = 0; i < 100; i++) {
+    const auto myValue = myDist(myOther);
+    ASSERT_GE(myValue, 1);
+    ASSERT_LE(myValue, 6);
+  }
+}
+
+TEST_F(TestCounterRandom, test_rvs) {
+  ASSERT_THROW(CounterUniformRv(1, 0, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(CounterExponentialRv(0, 0, 0, 0), std::runtime_error);
+
+  const std::size_t    N = 1000000;
+  std::vector<double>  myValues(N);
+  CounterUniformRv     myUniform(-1, 3, 1, 2, 3);
+  CounterExponentialRv myExponential(4, 1, 2, 3);
+
+  myUniform.fill(myValues.data(), N);
+  for (const auto& myValue : myValues) {
+    ASSERT_GE(myValue, -1);
+    ASSERT_LT(myValue, 3);
+  }
+  EXPECT_NEAR(1, std::accumulate(myValues.begin(), myValues.end(), 0.0) / N,
+              0.01);
+
+  myExponential.fill(myValues.data(), N);
+  EXPECT_NEAR(0.25,
+              std::accumulate(myValues.begin(), myValues.end(), 0.0) / N,
+              0.001);
+}
+
+TEST_F(TestCounterRandom, test_random_access) {
+  CounterExponentialRv myRv(1, 4, 5, 6);
+
+  // single draws and batches of any size and alignment give the same values
+  std::vector<double> myExpected;
+  for (std::size_t i = 0; i < 100; i++) {
+    myExpected.emplace_back(myRv());
+  }
+  for (std::size_t i = 0; i < myExpected.size(); i++) {
+    ASSERT_EQ(myExpected[i], myRv.at(i));
+  }
+
+  myRv.seek(0);
+  std::vector<double> myValues(myExpected.size());
+  std::size_t         myDone = 0;
+  for (std::size_t myLen = 0; myDone < myValues.size(); myLen++) {
+    const auto mySize = std::min(myLen, myValues.size() - myDone);
+    myRv.fill(myValues.data() + myDone, mySize);
+    myDone += mySize;
+    ASSERT_EQ(myDone, myRv.index());
+  }
+  ASSERT_EQ(myExpected, myValues);
+
+  // disjoint sub-sequences can be drawn independently
+  myRv.seek(51);
+  myRv.fill(myValues.data(), 7);
+  ASSERT_TRUE(std::equal(
+      myExpected.begin() + 51, myExpected.begin() + 58, myValues.begin()));
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,300 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/distributions.h"
+#include "Support/random.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace uiiit {
+namespace support {
+
+struct TestDistributions : public ::testing::Test {
+  TestDistributions()
+      : theCdfFile("TO_REMOVE_cdf.dat") {
+    // noop
+  }
+
+  void SetUp() override {
+    std::remove(theCdfFile.c_str());
+  }
+
+  void TearDown() override {
+    std::remove(theCdfFile.c_str());
+  }
+
+  static double mean(RealRvInterface& aRv, const std::size_t aSize) {
+    std::vector<double> myValues(aSize);
+    aRv.fill(myValues.data(), aSize);
+    return std::accumulate(myValues.begin(), myValues.end(), 0.0) / aSize;
+  }
+
+  const std::string theCdfFile;
+};
+
+TEST_F(TestDistributions, test_inverse_normal_cdf) {
+  EXPECT_NEAR(0, detail::inverseNormalCdf(0.5), 1e-15);
+  EXPECT_NEAR(1.959963984540054, detail::inverseNormalCdf(0.975), 1e-13);
+  EXPECT_NEAR(-1.959963984540054, detail::inverseNormalCdf(0.025), 1e-13);
+  EXPECT_NEAR(-6.361340902404056, detail::inverseNormalCdf(1e-10), 1e-11);
+  EXPECT_NEAR(-2.326347874040841, detail::inverseNormalCdf(0.01), 1e-13);
+}
+
+TEST_F(TestDistributions, test_alias_table) {
+  ASSERT_THROW(AliasTable({}), std::runtime_error);
+  ASSERT_THROW(AliasTable({1, -1}), std::runtime_error);
+  ASSERT_THROW(AliasTable({0, 0}), std::runtime_error);
+
+  const std::vector<double> myWeights({1, 0, 3, 6});
+  const AliasTable          myTable(myWeights);
+  ASSERT_EQ(4u, myTable.size());
+
+  // sweep uniformly [0, 1) to obtain the exact distribution
+  const std::size_t        N = 1000000;
+  std::vector<std::size_t> myCounts(myWeights.size(), 0);
+  double                   myFracSum = 0;
+  for (std::size_t i = 0; i < N; i++) {
+    double     myFrac;
+    const auto myNdx = myTable((i + 0.5) / N, myFrac);
+    ASSERT_LT(myNdx, myWeights.size());
+    ASSERT_GE(myFrac, 0);
+    ASSERT_LE(myFrac, 1);
+    myCounts[myNdx]++;
+    myFracSum += myFrac;
+  }
+  EXPECT_NEAR(0.1, myCounts[0] / double(N), 1e-5);
+  EXPECT_EQ(0u, myCounts[1]);
+  EXPECT_NEAR(0.3, myCounts[2] / double(N), 1e-5);
+  EXPECT_NEAR(0.6, myCounts[3] / double(N), 1e-5);
+  EXPECT_NEAR(0.5, myFracSum / N, 1e-3);
+}
+
+TEST_F(TestDistributions, test_quantile_table) {
+  const auto myLower = [](const double u) { return 2 * std::pow(1 - u, -0.5); };
+  const auto myUpper = [](const double v) { return 2 * std::pow(v, -0.5); };
+  const QuantileTable myTable(myLower, myUpper);
+
+  for (const auto u : {0.0,
+                       1e-300,
+                       1e-12,
+                       0.001,
+                       0.1,
+                       0.3333,
+                       0.5,
+                       0.75,
+                       0.9,
+                       0.999,
+                       1 - 1e-9,
+                       1 - 1e-15}) {
+    const auto myExact = u < 0.5 ? myLower(u) : myUpper(1 - u);
+    EXPECT_NEAR(1, myTable(u) / myExact, 1e-4) << u;
+  }
+
+  // the sample just below one is beyond the last cell
+  EXPECT_LT(myTable(std::nextafter(1.0, 0.0)), myUpper(1e-17));
+}
+
+TEST_F(TestDistributions, test_continuous_rvs) {
+  const std::size_t N = 1000000;
+
+  ASSERT_THROW(ParetoRv(0, 1, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(ParetoRv(1, -1, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(LogNormalRv(0, 0, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(LogNormalRv(std::nan(""), 1, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(WeibullRv(0, 1, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(WeibullRv(1, 0, 0, 0, 0), std::runtime_error);
+
+  ParetoRv myPareto(1, 3, 1, 2, 3);
+  EXPECT_NEAR(1.5, mean(myPareto, N), 0.01);
+  for (std::size_t i = 0; i < 1000; i++) {
+    ASSERT_GE(myPareto(), 1);
+  }
+
+  LogNormalRv myLogNormal(0.5, 0.4, 1, 2, 3);
+  EXPECT_NEAR(std::exp(0.5 + 0.4 * 0.4 / 2), mean(myLogNormal, N), 0.01);
+
+  WeibullRv myWeibull(2, 3, 1, 2, 3);
+  EXPECT_NEAR(3 * std::tgamma(1.5), mean(myWeibull, N), 0.01);
+
+  // Weibull with shape 1 is an exponential
+  WeibullRv myExponential(1, 0.5, 1, 2, 3);
+  EXPECT_NEAR(0.5, mean(myExponential, N), 0.01);
+}
+
+TEST_F(TestDistributions, test_shared_quantile_tables) {
+  ParetoRv myPareto(1, 3, 1, 2, 3);
+  ParetoRv myOther(1, 3, 4, 5, 6);
+  EXPECT_EQ(&myPareto.table(), &myOther.table());
+  EXPECT_NE(&myPareto.table(), &ParetoRv(1, 2, 1, 2, 3).table());
+  EXPECT_NE(&myPareto.table(), &WeibullRv(1, 3, 1, 2, 3).table());
+  EXPECT_EQ(&LogNormalRv(0.5, 0.4, 0, 0, 0).table(),
+            &LogNormalRv(0.5, 0.4, 1, 1, 1).table());
+
+  // the streams are still different
+  EXPECT_NE(myPareto(), myOther());
+
+  // a table is released with the last r.v. using it
+  const auto myQuantile = [](const double u) { return u; };
+
+  auto myTable = QuantileTable::shared("Test", {1, 2}, myQuantile, myQuantile);
+
+  const std::weak_ptr<const QuantileTable> myWeak = myTable;
+  EXPECT_EQ(myTable,
+            QuantileTable::shared("Test", {1, 2}, myQuantile, myQuantile));
+  EXPECT_NE(myTable,
+            QuantileTable::shared("Test", {1, 3}, myQuantile, myQuantile));
+  myTable.reset();
+  EXPECT_TRUE(myWeak.expired());
+}
+
+TEST_F(TestDistributions, test_discrete_rv) {
+  ASSERT_THROW(DiscreteRv({}, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(DiscreteRv({{1, -1}}, 0, 0, 0), std::runtime_error);
+
+  DiscreteRv myRv({{10, 1}, {20, 2}, {40, 1}}, 1, 2, 3);
+  const std::size_t        N = 100000;
+  std::vector<std::size_t> myCounts(3, 0);
+  for (std::size_t i = 0; i < N; i++) {
+    const auto myValue = myRv();
+    if (myValue == 10) {
+      myCounts[0]++;
+    } else if (myValue == 20) {
+      myCounts[1]++;
+    } else {
+      ASSERT_EQ(40, myValue);
+      myCounts[2]++;
+    }
+  }
+  EXPECT_NEAR(0.25, myCounts[0] / double(N), 0.01);
+  EXPECT_NEAR(0.50, myCounts[1] / double(N), 0.01);
+  EXPECT_NEAR(0.25, myCounts[2] / double(N), 0.01);
+}
+
+TEST_F(TestDistributions, test_empirical_rv) {
+  ASSERT_THROW(EmpiricalRv({}, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(EmpiricalRv({{1, 0.5}, {0, 1}}, 0, 0, 0), std::runtime_error);
+  ASSERT_THROW(EmpiricalRv({{0, 0.5}, {1, 0.4}}, 0, 0, 0), std::runtime_error);
+
+  // point mass 0.2 at 1, then uniform in [1, 2] with 0.4 and [2, 4] with 0.4
+  EmpiricalRv myRv({{1, 0.2}, {2, 0.6}, {4, 1}}, 1, 2, 3);
+  const std::size_t N       = 1000000;
+  std::size_t       myAtOne = 0;
+  double            mySum   = 0;
+  for (std::size_t i = 0; i < N; i++) {
+    const auto myValue = myRv();
+    ASSERT_GE(myValue, 1);
+    ASSERT_LE(myValue, 4);
+    myAtOne += myValue == 1 ? 1 : 0;
+    mySum += myValue;
+  }
+  EXPECT_NEAR(0.2, myAtOne / double(N), 0.01);
+  EXPECT_NEAR(0.2 * 1 + 0.4 * 1.5 + 0.4 * 3, mySum / N, 0.01);
+
+  // same distribution from evenly spaced uniform values
+  myAtOne = 0;
+  mySum   = 0;
+  for (std::size_t i = 0; i < N; i++) {
+    const auto myValue = myRv.value((i + 0.5) / N);
+    ASSERT_GE(myValue, 1);
+    ASSERT_LE(myValue, 4);
+    myAtOne += myValue == 1 ? 1 : 0;
+    mySum += myValue;
+  }
+  EXPECT_NEAR(0.2, myAtOne / double(N), 0.001);
+  EXPECT_NEAR(0.2 * 1 + 0.4 * 1.5 + 0.4 * 3, mySum / N, 0.001);
+}
+
+TEST_F(TestDistributions, test_load_cdf) {
+  ASSERT_THROW(EmpiricalRv::loadCdf(theCdfFile), std::runtime_error);
+
+  {
+    std::ofstream myFile(theCdfFile);
+    myFile << "# value, cdf\n\n0,0\n1 0.5\n3\t1\n";
+  }
+  const auto myCdf = EmpiricalRv::loadCdf(theCdfFile);
+  ASSERT_EQ(3u, myCdf.size());
+  EXPECT_EQ(std::make_pair(0.0, 0.0), myCdf[0]);
+  EXPECT_EQ(std::make_pair(1.0, 0.5), myCdf[1]);
+  EXPECT_EQ(std::make_pair(3.0, 1.0), myCdf[2]);
+
+  {
+    std::ofstream myFile(theCdfFile);
+    myFile << "0,0\n1,0.5,2\n";
+  }
+  ASSERT_THROW(EmpiricalRv::loadCdf(theCdfFile), std::runtime_error);
+
+  {
+    std::ofstream myFile(theCdfFile);
+    myFile << "0,0\nx,1\n";
+  }
+  ASSERT_THROW(EmpiricalRv::loadCdf(theCdfFile), std::runtime_error);
+}
+
+TEST_F(TestDistributions, test_from_string) {
+  const std::size_t N = 100000;
+
+  auto myPareto = RealRvInterface::fromString("Par(2,3)", 1, 2, 3);
+  EXPECT_NEAR(3, mean(*myPareto, N), 0.05);
+
+  auto myLogNormal = RealRvInterface::fromString("LogN(0,0.5)", 1, 2, 3);
+  EXPECT_NEAR(std::exp(0.125), mean(*myLogNormal, N), 0.02);
+
+  auto myWeibull = RealRvInterface::fromString("Weib(1,2)", 1, 2, 3);
+  EXPECT_NEAR(2, mean(*myWeibull, N), 0.05);
+
+  auto myDiscrete = RealRvInterface::fromString("D(1,1,3,1)", 1, 2, 3);
+  EXPECT_NEAR(2, mean(*myDiscrete, N), 0.02);
+
+  {
+    std::ofstream myFile(theCdfFile);
+    myFile << "0,0\n2,1\n";
+  }
+  auto myEmpirical =
+      RealRvInterface::fromString("Emp(" + theCdfFile + ")", 1, 2, 3);
+  EXPECT_NEAR(1, mean(*myEmpirical, N), 0.02);
+
+  ASSERT_THROW(RealRvInterface::fromString("Par(0,3)", 1, 2, 3),
+               std::runtime_error);
+  ASSERT_THROW(RealRvInterface::fromString("D(1,1,3)", 1, 2, 3),
+               std::exception);
+  ASSERT_THROW(RealRvInterface::fromString("Emp(non-existing-file)", 1, 2, 3),
+               std::runtime_error);
+}
+
+} // namespace support
+} // namespace uiiit
@@ -35,6 +35,8 @@ SOFTWARE.
 #include <cmath>
 #include <iterator>
 #include <limits>
+#include <list>
+#include <vector>
 #include <stdexcept>
 
 namespace uiiit {
@@ -118,5 +120,95 @@ TEST_F(TestFairness, test_proportional_fairness_invalid) {
                std::runtime_error);
 }
 
+TEST_F(TestFairness, test_parallel) {
+  std::vector<double> myPopulation;
+  std::vector<double> myWeights;
+  for (std::size_t i = 0; i < 300000; i++) {
+    myPopulation.emplace_back(1 + (i * 7919) % 1000);
+    myWeights.emplace_back(1 + i % 3);
+  }
+  const std::list<double> myList(myPopulation.begin(), myPopulation.end());
+
+  for (const auto myNumThreads : std::vector<std::size_t>({0, 1, 2, 4})) {
+    ASSERT_FLOAT_EQ(jain(myPopulation),
+                    jainFairnessIndexParallel(myPopulation, myNumThreads));
+    ASSERT_FLOAT_EQ(jain(myPopulation),
+                    jainFairnessIndexParallel(myList, myNumThreads));
+    ASSERT_FLOAT_EQ(
+        proportionalFairnessIndex(myPopulation, myWeights),
+        proportionalFairnessIndexParallel(
+            myPopulation, myWeights, myNumThreads));
+    ASSERT_FLOAT_EQ(proportionalFairnessIndex(myList, std::vector<double>()),
+                    proportionalFairnessIndexParallel(
+                        myList, std::vector<double>(), myNumThreads));
+  }
+
+  myPopulation[200000] = 0;
+  ASSERT_FLOAT_EQ(0,
+                  proportionalFairnessIndexParallel(
+                      myPopulation, std::vector<double>(), 4));
+
+  ASSERT_THROW(jainFairnessIndexParallel(std::vector<double>(), 4),
+               std::runtime_error);
+  ASSERT_THROW(proportionalFairnessIndexParallel(
+                   myPopulation, std::vector<double>({1, 2}), 4),
+               std::runtime_error);
+}
+
+TEST_F(TestFairness, test_jain_tracker) {
+  ASSERT_THROW(JainFairnessTracker(0).index(), std::runtime_error);
+
+  JainFairnessTracker myTracker(5);
+  ASSERT_EQ(5, myTracker.size());
+  ASSERT_TRUE(std::isnan(myTracker.index()));
+
+  std::vector<double> myPopulation({1, 0.9, 0.8, 1, 1});
+  for (std::size_t i = 0; i < myPopulation.size(); i++) {
+    myTracker.update(i, myPopulation[i]);
+  }
+  ASSERT_FLOAT_EQ(jain(myPopulation), myTracker.index());
+
+  myPopulation[2] = 3;
+  myTracker.update(2, 3);
+  ASSERT_FLOAT_EQ(3, myTracker.value(2));
+  ASSERT_FLOAT_EQ(jain(myPopulation), myTracker.index());
+
+  myTracker.resync();
+  ASSERT_FLOAT_EQ(jain(myPopulation), myTracker.index());
+
+  ASSERT_THROW(myTracker.update(5, 1), std::out_of_range);
+}
+
+TEST_F(TestFairness, test_proportional_tracker) {
+  std::vector<double>         myPopulation({1, 2, 2, 4, 4});
+  std::vector<double>         myWeights({1, 2, 3, 4, 5});
+  ProportionalFairnessTracker myTracker(5);
+  ProportionalFairnessTracker myWeightedTracker{
+      std::vector<double>(myWeights)};
+
+  for (std::size_t i = 0; i < myPopulation.size(); i++) {
+    ASSERT_FLOAT_EQ(0, myTracker.index());
+    myTracker.update(i, myPopulation[i]);
+    myWeightedTracker.update(i, myPopulation[i]);
+  }
+  ASSERT_FLOAT_EQ(4.1588831, myTracker.index());
+  ASSERT_FLOAT_EQ(15.942385152878742, myWeightedTracker.index());
+
+  myTracker.update(3, 0);
+  ASSERT_FLOAT_EQ(0, myTracker.index());
+  myTracker.update(3, 8);
+  myPopulation[3] = 8;
+  ASSERT_FLOAT_EQ(
+      proportionalFairnessIndex(myPopulation, std::vector<double>()),
+      myTracker.index());
+
+  myTracker.resync();
+  ASSERT_FLOAT_EQ(
+      proportionalFairnessIndex(myPopulation, std::vector<double>()),
+      myTracker.index());
+
+  ASSERT_THROW(myTracker.update(5, 1), std::out_of_range);
+}
+
 } // namespace support
 } // namespace uiiit
@@ -0,0 +1,145 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/filewriter.h"
+
+#include "gtest/gtest.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace uiiit {
+namespace support {
+
+struct TestFileWriter : public ::testing::Test {
+  TestFileWriter()
+      : theDir("TO_REMOVE_filewriter")
+      , theArchive("TO_REMOVE_filewriter.arc") {
+    // noop
+  }
+
+  void SetUp() override {
+    boost::filesystem::remove_all(theDir);
+    boost::filesystem::create_directory(theDir);
+    std::remove(theArchive.c_str());
+  }
+
+  void TearDown() override {
+    boost::filesystem::remove_all(theDir);
+    std::remove(theArchive.c_str());
+  }
+
+  std::string read(const std::string& aFilename) {
+    std::ifstream     myFile(aFilename, std::ios::binary);
+    std::stringstream ret;
+    ret << myFile.rdbuf();
+    return ret.str();
+  }
+
+  //! @return the content of the i-th file written in the tests.
+  static std::string content(const std::size_t i) {
+    return std::string(i * 7, static_cast<char>('a' + i % 26));
+  }
+
+  const std::string theDir;
+  const std::string theArchive;
+};
+
+TEST_F(TestFileWriter, test_directory) {
+  {
+    // small limit of pending buffers, so that write() blocks
+    FileWriter myWriter(theDir, FileWriter::Mode::Directory, 3, 100);
+    for (std::size_t i = 0; i < 100; i++) {
+      myWriter.write("file-" + std::to_string(i), content(i));
+    }
+    myWriter.write("empty", std::string());
+    myWriter.close();
+    ASSERT_THROW(myWriter.write("other", std::string("x")),
+                 std::runtime_error);
+  }
+  for (std::size_t i = 0; i < 100; i++) {
+    ASSERT_EQ(content(i), read(theDir + "/file-" + std::to_string(i)));
+  }
+  ASSERT_TRUE(boost::filesystem::exists(theDir + "/empty"));
+  ASSERT_EQ("", read(theDir + "/empty"));
+}
+
+TEST_F(TestFileWriter, test_directory_error) {
+  FileWriter myWriter(theDir, FileWriter::Mode::Directory, 2);
+  myWriter.write("not-existing/file", std::string("x"));
+  ASSERT_THROW(myWriter.close(), std::runtime_error);
+}
+
+TEST_F(TestFileWriter, test_archive) {
+  {
+    FileWriter myWriter(theArchive, FileWriter::Mode::Archive, 4, 100);
+    for (std::size_t i = 0; i < 100; i++) {
+      myWriter.write("file-" + std::to_string(i), content(i));
+    }
+    myWriter.write("empty", std::string());
+    // the index is written upon destruction
+  }
+
+  ArchiveReader myReader(theArchive);
+  ASSERT_EQ(101u, myReader.names().size());
+  for (std::size_t i = 0; i < 100; i++) {
+    const auto myName = "file-" + std::to_string(i);
+    ASSERT_EQ(myName, myReader.names()[i]);
+    ASSERT_EQ(content(i), myReader.content(myName));
+  }
+  ASSERT_EQ("empty", myReader.names().back());
+  ASSERT_EQ("", myReader.content("empty"));
+  ASSERT_THROW(myReader.content("file-100"), std::runtime_error);
+}
+
+TEST_F(TestFileWriter, test_archive_invalid) {
+  ASSERT_THROW(ArchiveReader{theArchive}, std::runtime_error);
+
+  { FileWriter myWriter(theArchive, FileWriter::Mode::Archive, 1); }
+  ASSERT_TRUE(ArchiveReader(theArchive).names().empty());
+
+  // truncated archive
+  const auto myContent = read(theArchive);
+  std::ofstream(theArchive, std::ios::binary)
+      << myContent.substr(0, myContent.size() - 1);
+  ASSERT_THROW(ArchiveReader{theArchive}, std::runtime_error);
+
+  // not an archive
+  std::ofstream(theArchive, std::ios::binary) << std::string(100, 'x');
+  ASSERT_THROW(ArchiveReader{theArchive}, std::runtime_error);
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,112 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/mappedfile.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace uiiit {
+namespace support {
+
+struct TestMappedFile : public ::testing::Test {
+  TestMappedFile()
+      : theFilename("TO_REMOVE_mappedfile.dat") {
+    // noop
+  }
+
+  void SetUp() override {
+    std::remove(theFilename.c_str());
+  }
+
+  void TearDown() override {
+    std::remove(theFilename.c_str());
+  }
+
+  void write(const std::string& aContent) {
+    std::ofstream myFile(theFilename, std::ios::binary);
+    myFile << aContent;
+  }
+
+  const std::string theFilename;
+};
+
+TEST_F(TestMappedFile, test_invalid) {
+  ASSERT_THROW(MappedFile{theFilename}, std::runtime_error);
+}
+
+TEST_F(TestMappedFile, test_empty) {
+  write("");
+  MappedFile myFile(theFilename);
+  ASSERT_EQ(0u, myFile.size());
+  ASSERT_EQ(nullptr, myFile.data());
+  ASSERT_TRUE(myFile.view().empty());
+}
+
+TEST_F(TestMappedFile, test_content) {
+  const std::string myContent("hello\nworld\0binary", 18);
+  write(myContent);
+  MappedFile myFile(theFilename);
+  ASSERT_EQ(myContent.size(), myFile.size());
+  ASSERT_EQ(myContent, myFile.view());
+
+  // the mapping is not affected by the removal of the file
+  std::remove(theFilename.c_str());
+  ASSERT_EQ(myContent, myFile.view());
+}
+
+TEST_F(TestMappedFile, test_move) {
+  write("0123456789");
+  MappedFile  myFile(theFilename);
+  const auto* myData = myFile.data();
+
+  MappedFile myOther(std::move(myFile));
+  ASSERT_EQ(myData, myOther.data());
+  ASSERT_EQ("0123456789", myOther.view());
+  ASSERT_EQ(0u, myFile.size());
+  ASSERT_EQ(nullptr, myFile.data());
+
+  // the file must not be modified while mapped, but it can be removed
+  std::remove(theFilename.c_str());
+  write("abc");
+  MappedFile myThird(theFilename);
+  ASSERT_EQ("abc", myThird.view());
+  myThird = std::move(myOther);
+  ASSERT_EQ("0123456789", myThird.view());
+  ASSERT_EQ(nullptr, myOther.data());
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,83 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/radixsort.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace uiiit {
+namespace support {
+
+struct TestRadixSort : public ::testing::Test {};
+
+TEST_F(TestRadixSort, test_corner_cases) {
+  std::vector<std::uint64_t> myValues;
+  radixSort(myValues);
+  ASSERT_TRUE(myValues.empty());
+
+  myValues = {42};
+  radixSort(myValues);
+  ASSERT_EQ(std::vector<std::uint64_t>({42}), myValues);
+
+  myValues = {7, 7, 7};
+  radixSort(myValues);
+  ASSERT_EQ(std::vector<std::uint64_t>({7, 7, 7}), myValues);
+
+  myValues = {UINT64_MAX, 0, 1ull << 63, 1, 0};
+  radixSort(myValues);
+  ASSERT_EQ(std::vector<std::uint64_t>({0, 0, 1, 1ull << 63, UINT64_MAX}),
+            myValues);
+}
+
+TEST_F(TestRadixSort, test_random) {
+  std::mt19937_64 myRng(42);
+
+  // any values, and values in a narrow range with many duplicates, so that
+  // most of the bytes are skipped
+  for (const auto myRange : std::vector<std::uint64_t>({UINT64_MAX, 100000})) {
+    std::uniform_int_distribution<std::uint64_t> myRv(0, myRange);
+    std::vector<std::uint64_t>                   myValues;
+    for (std::size_t i = 0; i < 100000; i++) {
+      myValues.emplace_back(1600000000000ull + myRv(myRng));
+    }
+    auto myExpected = myValues;
+    std::sort(myExpected.begin(), myExpected.end());
+    radixSort(myValues);
+    ASSERT_EQ(myExpected, myValues);
+  }
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,81 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/stringtable.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <utility>
+
+namespace uiiit {
+namespace support {
+
+struct TestStringTable : public ::testing::Test {};
+
+TEST_F(TestStringTable, test_intern) {
+  StringTable myTable;
+  ASSERT_EQ(0u, myTable.size());
+  ASSERT_FALSE(myTable.find("a").has_value());
+
+  ASSERT_EQ(0u, myTable.intern("a"));
+  ASSERT_EQ(1u, myTable.intern("bb"));
+  ASSERT_EQ(0u, myTable.intern("a"));
+  ASSERT_EQ(2u, myTable.intern(""));
+  ASSERT_EQ(3u, myTable.size());
+
+  ASSERT_EQ("a", myTable[0]);
+  ASSERT_EQ("bb", myTable[1]);
+  ASSERT_EQ("", myTable[2]);
+  ASSERT_EQ(1u, myTable.find("bb").value());
+  ASSERT_FALSE(myTable.find("c").has_value());
+}
+
+TEST_F(TestStringTable, test_many) {
+  // the views used for lookup survive the growth of the table, also with
+  // strings short enough to be stored inline
+  StringTable myTable;
+  for (std::uint32_t i = 0; i < 100000; i++) {
+    ASSERT_EQ(i, myTable.intern(std::to_string(i)));
+  }
+  for (std::uint32_t i = 0; i < 100000; i++) {
+    ASSERT_EQ(i, myTable.intern(std::to_string(i)));
+    ASSERT_EQ(std::to_string(i), myTable[i]);
+  }
+
+  // same after moving the table
+  StringTable myOther(std::move(myTable));
+  ASSERT_EQ(100000u, myOther.size());
+  ASSERT_EQ(42u, myOther.find("42").value());
+  ASSERT_EQ(100000u, myOther.intern("new"));
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,156 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/parallelbatch.h"
+#include "Support/queue.h"
+#include "Support/random.h"
+#include "Support/threadrandom.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace uiiit {
+namespace support {
+
+struct TestThreadRandom : public ::testing::Test {
+  static std::vector<float> draw(const std::size_t aSize) {
+    std::vector<float> ret;
+    for (std::size_t i = 0; i < aSize; i++) {
+      ret.emplace_back(random());
+    }
+    return ret;
+  }
+};
+
+TEST_F(TestThreadRandom, test_range) {
+  for (const auto myValue : draw(100000)) {
+    ASSERT_GE(myValue, 0);
+    ASSERT_LT(myValue, 1);
+  }
+}
+
+TEST_F(TestThreadRandom, test_reproducible) {
+  seedThreadRandom(42);
+  setThreadRandomStream(7);
+  ASSERT_EQ(7u, threadRandomStream());
+  const auto myFirst = draw(100);
+
+  // same seed and stream: same sequence
+  seedThreadRandom(42);
+  ASSERT_EQ(7u, threadRandomStream());
+  ASSERT_EQ(myFirst, draw(100));
+  setThreadRandomStream(7);
+  ASSERT_EQ(myFirst, draw(100));
+
+  // different stream or seed: different sequence
+  setThreadRandomStream(8);
+  ASSERT_NE(myFirst, draw(100));
+  seedThreadRandom(43);
+  setThreadRandomStream(7);
+  ASSERT_NE(myFirst, draw(100));
+
+  // the generator is the same as a stand-alone one
+  seedThreadRandom(42);
+  Xoshiro256pp myGenerator(42, 7, 0);
+  for (std::size_t i = 0; i < 100; i++) {
+    ASSERT_EQ(myGenerator(), threadGenerator()());
+  }
+}
+
+TEST_F(TestThreadRandom, test_jump) {
+  seedThreadRandom(42);
+  setThreadRandomStream(1);
+  Xoshiro256pp myGenerator(42, 1, 0);
+  myGenerator.jump();
+  jumpThreadRandom();
+  for (std::size_t i = 0; i < 100; i++) {
+    ASSERT_EQ(myGenerator(), threadGenerator()());
+  }
+}
+
+TEST_F(TestThreadRandom, test_threads) {
+  // every thread has its own stream by default
+  const std::size_t        N = 8;
+  std::mutex               myMutex;
+  std::set<std::size_t>    myStreams;
+  std::set<float>          myFirstValues;
+  std::vector<std::thread> myThreads;
+  for (std::size_t i = 0; i < N; i++) {
+    myThreads.emplace_back([&]() {
+      const auto myValue = random();
+      for (std::size_t j = 0; j < 100000; j++) {
+        random();
+      }
+      const std::lock_guard<std::mutex> myLock(myMutex);
+      myStreams.emplace(threadRandomStream());
+      myFirstValues.emplace(myValue);
+    });
+  }
+  for (auto& myThread : myThreads) {
+    myThread.join();
+  }
+  EXPECT_EQ(N, myStreams.size());
+  EXPECT_EQ(N, myFirstValues.size());
+}
+
+TEST_F(TestThreadRandom, test_parallel_batch) {
+  // the results do not depend on the number of threads
+  const auto myRun = [](const std::size_t aNumThreads) {
+    seedThreadRandom(1234);
+    std::mutex                        myMutex;
+    std::map<int, std::vector<float>> ret;
+    Queue<int>                        myInputs;
+    for (auto i = 0; i < 50; i++) {
+      myInputs.push(i);
+    }
+    ParallelBatch<int> myBatch(aNumThreads, myInputs, [&](int&& aId) {
+      setThreadRandomStream(aId);
+      const auto                        myValues = draw(10);
+      const std::lock_guard<std::mutex> myLock(myMutex);
+      ret.emplace(aId, myValues);
+    });
+    EXPECT_TRUE(myBatch.wait().empty());
+    return ret;
+  };
+
+  const auto myExpected = myRun(1);
+  ASSERT_EQ(50u, myExpected.size());
+  for (const auto n : {2u, 5u}) {
+    ASSERT_EQ(myExpected, myRun(n));
+  }
+}
+
+} // namespace support
+} // namespace uiiit
@@ -0,0 +1,191 @@
+/*
+ ___ ___ __     __ ____________
+|   |   |  |   |__|__|__   ___/  Ubiquitout Internet @ IIT-CNR
+|   |   |  |  /__/  /  /  /      C++ support library
+|   |   |  |/__/  /   /  /       https://github.com/ccicconetti/support/
+|_______|__|__/__/   /__/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2022 Claudio Cicconetti https://ccicconetti.github.io/
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Support/stat.h"
+#include "Support/timeweightedstat.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace uiiit {
+namespace support {
+
+struct TestTimeWeightedStat : public ::testing::Test {};
+
+TEST_F(TestTimeWeightedStat, test_ctor) {
+  TimeWeightedStat<> myStat;
+
+  ASSERT_EQ(0u, myStat.count());
+  ASSERT_TRUE(myStat.empty());
+  ASSERT_EQ(0, myStat.weight());
+  ASSERT_TRUE(std::isnan(myStat.mean()));
+  ASSERT_TRUE(std::isnan(myStat.variance()));
+  ASSERT_EQ(std::numeric_limits<double>::max(), myStat.min());
+  ASSERT_EQ(std::numeric_limits<double>::lowest(), myStat.max());
+  ASSERT_THROW(myStat.percentile(0.5), std::runtime_error);
+
+  ASSERT_THROW(TimeWeightedStat<10>(0, 0, 0), std::runtime_error);
+  ASSERT_NO_THROW(TimeWeightedStat<10>(0, 0, 1));
+}
+
+TEST_F(TestTimeWeightedStat, test_same_as_summary_weighted_stat) {
+  double              myClock = 0;
+  SummaryWeightedStat myExpected(myClock, 100);
+  TimeWeightedStat<>  myStat(100);
+
+  const std::vector<double> myTimes({80, 100, 120, 150, 200});
+  const std::vector<double> myValues({2, 3, 4, 1, 2});
+  for (std::size_t i = 0; i < myTimes.size(); i++) {
+    myClock = myTimes[i];
+    myExpected(myValues[i]);
+    myStat(myTimes[i], myValues[i]);
+  }
+
+  ASSERT_EQ(myExpected.count(), myStat.count());
+  ASSERT_FLOAT_EQ(myExpected.mean(), myStat.mean());
+  ASSERT_FLOAT_EQ(100, myStat.weight());
+}
+
+TEST_F(TestTimeWeightedStat, test_statistics) {
+  TimeWeightedStat<> myStat(10);
+
+  myStat(0, 99);  // discarded: warm-up
+  myStat(5, 2);   // held for [10, 20)
+  myStat(20, 4);  // held for [20, 50)
+  myStat(50, -1); // held for a zero duration
+  myStat(50, 0);  // held for [50, 60)
+  myStat.close(60);
+
+  const auto myMean = (2.0 * 10 + 4.0 * 30 + 0.0 * 10) / 50;
+  const auto myVar  = (10 * std::pow(2.0 - myMean, 2) +
+                      30 * std::pow(4.0 - myMean, 2) +
+                      10 * std::pow(0.0 - myMean, 2)) /
+                     50;
+  ASSERT_EQ(4u, myStat.count());
+  ASSERT_FLOAT_EQ(50, myStat.weight());
+  ASSERT_FLOAT_EQ(myMean, myStat.mean());
+  ASSERT_FLOAT_EQ(myVar, myStat.variance());
+  ASSERT_FLOAT_EQ(std::sqrt(myVar), myStat.stddev());
+  ASSERT_FLOAT_EQ(0, myStat.min());
+  ASSERT_FLOAT_EQ(4, myStat.max());
+
+  myStat.reset();
+  ASSERT_TRUE(myStat.empty());
+  ASSERT_TRUE(std::isnan(myStat.mean()));
+}
+
+TEST_F(TestTimeWeightedStat, test_observe) {
+  std::vector<double> myTimes;
+  std::vector<double> myValues;
+  for (auto i = 0; i < 1000; i++) {
+    myTimes.emplace_back(i * 0.5 + (i % 7) * 0.01);
+    myValues.emplace_back((i * 37) % 11);
+  }
+
+  for (const auto myWarmUp : std::vector<double>({0, 3.14, 100, 1000})) {
+    TimeWeightedStat<> myExpected(myWarmUp);
+    TimeWeightedStat<> myStat(myWarmUp);
+    for (std::size_t i = 0; i < myTimes.size(); i++) {
+      myExpected(myTimes[i], myValues[i]);
+    }
+    myStat.observe(myTimes.data(), myValues.data(), 400);
+    myStat.observe(myTimes.data() + 400, myValues.data() + 400, 600);
+
+    ASSERT_EQ(myExpected.count(), myStat.count()) << myWarmUp;
+    ASSERT_FLOAT_EQ(myExpected.weight(), myStat.weight()) << myWarmUp;
+    if (myExpected.weight() > 0) {
+      ASSERT_FLOAT_EQ(myExpected.mean(), myStat.mean()) << myWarmUp;
+      ASSERT_FLOAT_EQ(myExpected.variance(), myStat.variance()) << myWarmUp;
+    }
+
+    myExpected.close(2000);
+    myStat.close(2000);
+    ASSERT_FLOAT_EQ(myExpected.mean(), myStat.mean()) << myWarmUp;
+  }
+}
+
+TEST_F(TestTimeWeightedStat, test_merge) {
+  TimeWeightedStat<10> myAll(0, 0, 1);
+  TimeWeightedStat<10> myFirst(0, 0, 1);
+  TimeWeightedStat<10> mySecond(0, 0, 1);
+
+  for (auto i = 0; i < 100; i++) {
+    const auto myValue  = (i * 13) % 10;
+    const auto myWeight = 1.0 + i % 3;
+    myAll.add(myValue, myWeight);
+    (i % 2 == 0 ? myFirst : mySecond).add(myValue, myWeight);
+  }
+  myFirst.merge(mySecond);
+
+  ASSERT_EQ(myAll.count(), myFirst.count());
+  ASSERT_FLOAT_EQ(myAll.weight(), myFirst.weight());
+  ASSERT_FLOAT_EQ(myAll.mean(), myFirst.mean());
+  ASSERT_FLOAT_EQ(myAll.variance(), myFirst.variance());
+  ASSERT_FLOAT_EQ(myAll.min(), myFirst.min());
+  ASSERT_FLOAT_EQ(myAll.max(), myFirst.max());
+  ASSERT_FLOAT_EQ(myAll.percentile(0.9), myFirst.percentile(0.9));
+
+  ASSERT_THROW(myFirst.merge(TimeWeightedStat<10>(0, 0, 2)),
+               std::runtime_error);
+}
+
+TEST_F(TestTimeWeightedStat, test_percentile) {
+  TimeWeightedStat<10> myStat(0, 0, 1);
+
+  ASSERT_TRUE(std::isnan(myStat.percentile(0.5)));
+  ASSERT_THROW(myStat.percentile(-0.1), std::runtime_error);
+  ASSERT_THROW(myStat.percentile(1.1), std::runtime_error);
+
+  // queue length 0 for 50% of the time, 1 for 30%, 5 for 20%
+  myStat(0, 0);
+  myStat(50, 1);
+  myStat(80, 5);
+  myStat.close(100);
+
+  ASSERT_FLOAT_EQ(0, myStat.percentile(0));
+  ASSERT_FLOAT_EQ(0.5, myStat.percentile(0.25));
+  ASSERT_FLOAT_EQ(1.5, myStat.percentile(0.65));
+  ASSERT_FLOAT_EQ(5, myStat.percentile(0.9));
+  ASSERT_FLOAT_EQ(5, myStat.percentile(1));
+
+  // values outside the domain go to the underflow/overflow bins
+  myStat(100, -3);
+  myStat(200, 42);
+  myStat.close(300);
+  ASSERT_FLOAT_EQ(-3, myStat.percentile(0.1));
+  ASSERT_FLOAT_EQ(42, myStat.percentile(0.9));
+}
+
+} // namespace support
+} // namespace uiiit